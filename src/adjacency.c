@@ -0,0 +1,266 @@
+/*
+** Function BuildAdjacency
+** Builds the node-to-node adjacency of the grid by walking the ring of
+** half-edges around every node, and marks the nodes on the boundary.
+** Nodes not used by any element get no neighbours.
+**
+** In:       tHalfEdge  HalfEdge  = half-edge structure of the grid
+**
+** Out:      tAdjacency Adjacency = node-to-node adjacency
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gridgen.h"
+#include "halfedge.h"
+#include "adjacency.h"
+
+int BuildAdjacency(FILE *log, tHalfEdge *HalfEdge, tAdjacency *Adjacency)
+{
+	int    ret;
+	int    n, h, last, k, m, tmp;
+	int    numNodes;
+
+	ret      = 0;
+	numNodes = HalfEdge->numNodes;
+
+	Adjacency->numNodes    = numNodes;
+	Adjacency->start       = NULL;
+	Adjacency->node        = NULL;
+	Adjacency->boundary    = NULL;
+	Adjacency->numColours  = 0;
+	Adjacency->colourStart = NULL;
+	Adjacency->colourNode  = NULL;
+
+	Adjacency->start    = (int*)calloc(numNodes+1, sizeof(int));
+	Adjacency->boundary = (int*)calloc((numNodes > 0 ? numNodes : 1), sizeof(int));
+
+	if (Adjacency->start == NULL || Adjacency->boundary == NULL)
+	{
+		fprintf(stderr, "ERROR in function BuildAdjacency: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* Count the neighbours: one per element, plus one for an open ring */
+		for(n=0; n<numNodes; n++)
+		{
+			h = NodeRingFirst(&(*HalfEdge), n);
+
+			if (h == -1)
+				continue;
+
+			Adjacency->boundary[n] = (HalfEdge->twin[h] == -1);
+
+			for(m=0; h!=-1; h=NodeRingNext(&(*HalfEdge), n, h))
+				m++;
+
+			Adjacency->start[n+1] = m + Adjacency->boundary[n];
+		}
+
+		for(n=0; n<numNodes; n++)
+			Adjacency->start[n+1] += Adjacency->start[n];
+
+		Adjacency->node = (int*)malloc((Adjacency->start[numNodes] > 0 ? Adjacency->start[numNodes] : 1)*sizeof(int));
+
+		if (Adjacency->node == NULL)
+		{
+			fprintf(stderr, "ERROR in function BuildAdjacency: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		/* Fill the neighbours in ascending order */
+		for(n=0; n<numNodes; n++)
+		{
+			m    = Adjacency->start[n];
+			last = -1;
+
+			for(h=NodeRingFirst(&(*HalfEdge), n); h!=-1; h=NodeRingNext(&(*HalfEdge), n, h))
+			{
+				Adjacency->node[m++] = HalfEdgeDest(&(*HalfEdge), h);
+				last = h;
+			}
+
+			if (Adjacency->boundary[n])
+				Adjacency->node[m++] = HalfEdge->origin[HalfEdgePrev(&(*HalfEdge), last)];
+
+			for(h=Adjacency->start[n]+1; h<m; h++)
+			{
+				tmp = Adjacency->node[h];
+				for(k=h; k>Adjacency->start[n] && Adjacency->node[k-1]>tmp; k--)
+					Adjacency->node[k] = Adjacency->node[k-1];
+				Adjacency->node[k] = tmp;
+			}
+		}
+	}
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION BUILDADJACENCY *****\n\n");
+
+		fprintf(log, "number of nodes      = %d\n", numNodes);
+		fprintf(log, "number of edges      = %d\n", Adjacency->start[numNodes]/2);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function ColourAdjacency
+** Colours the free (non-boundary, used) nodes greedily, such that no
+** two neighbours share a colour. All nodes of one colour can then be
+** updated concurrently.
+**
+** In:       tAdjacency Adjacency = node-to-node adjacency
+**
+** Out:      tAdjacency Adjacency = adjacency including colouring
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ColourAdjacency(FILE *log, tAdjacency *Adjacency)
+{
+	int    ret;
+	int    n, h, c;
+	int    numNodes;
+
+	int    *colour     = NULL;
+	int    *forbidden  = NULL;
+
+	ret      = 0;
+	numNodes = Adjacency->numNodes;
+
+	Adjacency->numColours = 0;
+
+	colour                 = (int*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(int));
+	forbidden              = (int*)malloc((numNodes+1)*sizeof(int));
+	Adjacency->colourNode  = (int*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(int));
+
+	if (colour == NULL || forbidden == NULL || Adjacency->colourNode == NULL)
+	{
+		fprintf(stderr, "ERROR in function ColourAdjacency: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* forbidden[c] == n means colour c is taken by a neighbour of n */
+		for(c=0; c<=numNodes; c++)
+			forbidden[c] = -1;
+
+		for(n=0; n<numNodes; n++)
+			colour[n] = -1;
+
+		for(n=0; n<numNodes; n++)
+		{
+			if (Adjacency->boundary[n] || Adjacency->start[n] == Adjacency->start[n+1])
+				continue;
+
+			for(h=Adjacency->start[n]; h<Adjacency->start[n+1]; h++)
+				if (colour[Adjacency->node[h]] >= 0)
+					forbidden[colour[Adjacency->node[h]]] = n;
+
+			for(c=0; forbidden[c] == n; c++);
+
+			colour[n] = c;
+			if (c+1 > Adjacency->numColours)
+				Adjacency->numColours = c+1;
+		}
+
+		/* Group the nodes per colour */
+		Adjacency->colourStart = (int*)calloc(Adjacency->numColours+1, sizeof(int));
+
+		if (Adjacency->colourStart == NULL)
+		{
+			fprintf(stderr, "ERROR in function ColourAdjacency: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(n=0; n<numNodes; n++)
+			if (colour[n] >= 0)
+				Adjacency->colourStart[colour[n]+1]++;
+
+		for(c=0; c<Adjacency->numColours; c++)
+			Adjacency->colourStart[c+1] += Adjacency->colourStart[c];
+
+		for(c=0; c<=Adjacency->numColours; c++)
+			forbidden[c] = Adjacency->colourStart[c];
+
+		for(n=0; n<numNodes; n++)
+			if (colour[n] >= 0)
+				Adjacency->colourNode[forbidden[colour[n]]++] = n;
+	}
+
+	/* Free allocated memory */
+	if (colour)
+		free(colour);
+
+	if (forbidden)
+		free(forbidden);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION COLOURADJACENCY *****\n\n");
+
+		fprintf(log, "number of colours    = %d\n", Adjacency->numColours);
+		for(c=0; c<Adjacency->numColours; c++)
+			fprintf(log, "colour %3d           = %d nodes\n", c, Adjacency->colourStart[c+1]-Adjacency->colourStart[c]);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function FreeAdjacency
+** Frees the arrays of an adjacency.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeAdjacency(tAdjacency *Adjacency)
+{
+	if (Adjacency->start)
+		free(Adjacency->start);
+
+	if (Adjacency->node)
+		free(Adjacency->node);
+
+	if (Adjacency->boundary)
+		free(Adjacency->boundary);
+
+	if (Adjacency->colourStart)
+		free(Adjacency->colourStart);
+
+	if (Adjacency->colourNode)
+		free(Adjacency->colourNode);
+
+	Adjacency->start       = NULL;
+	Adjacency->node        = NULL;
+	Adjacency->boundary    = NULL;
+	Adjacency->colourStart = NULL;
+	Adjacency->colourNode  = NULL;
+
+	return 0;
+}
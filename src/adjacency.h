@@ -0,0 +1,24 @@
+/*
+** Header-file for Adjacency
+*/
+
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+typedef struct
+{
+	int    numNodes;
+	int    *start;        /* neighbours of node n: node[start[n]..start[n+1]-1] */
+	int    *node;
+	int    *boundary;     /* 1 if the node lies on a boundary edge              */
+
+	int    numColours;    /* free nodes of colour c:                            */
+	int    *colourStart;  /* colourNode[colourStart[c]..colourStart[c+1]-1]     */
+	int    *colourNode;
+} tAdjacency;
+
+int BuildAdjacency(FILE*, tHalfEdge*, tAdjacency*);
+int ColourAdjacency(FILE*, tAdjacency*);
+int FreeAdjacency(tAdjacency*);
+
+#endif
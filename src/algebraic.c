@@ -1,7 +1,8 @@
 /*
 ** C-file for Algebraic
 **
-** In:       tResult  Result     = Structure containg results
+** In:       tData    Data       = Structure containg data
+**           tResult  Result     = Structure containg results
 ** Out:      tResult  Result     = Structure containg results
 ** Return:   0 on success; -1 on failure
 **
@@ -16,7 +17,7 @@
 #include "interpolate.h"
 #include "metrics.h"
 
-int Algebraic(FILE *logFile, tResult *Result)
+int Algebraic(FILE *logFile, tData *Data, tResult *Result)
 {
 	int    ret;
 
@@ -30,7 +31,12 @@ int Algebraic(FILE *logFile, tResult *Result)
 
 	/* Interpolate all nodes */
 	if (ret != -1)
-		ret = Interpolate(&(*logFile), &(*Result));
+	{
+		if (Data->interpolationType == 'H')
+			ret = HermiteInterpolate(&(*logFile), &(*Result));
+		else
+			ret = Interpolate(&(*logFile), &(*Result));
+	}
 
 	/* Calculate metrics */
 	if (ret != -1)
@@ -5,6 +5,6 @@
 #ifndef ALGEBRAIC_H
 #define ALGEBRAIC_H
 
-int Algebraic(FILE*, tResult*);
+int Algebraic(FILE*, tData*, tResult*);
 
 #endif
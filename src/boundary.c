@@ -1,6 +1,7 @@
 /*
 ** C-file for BuildBoundaries
-** Calculates the Boundaries
+** Calculates the Boundaries. Every side tags its nodes with its
+** boundary patch: the tunnel walls, the inflow and the outflow.
 **
 ** In:       tData   Data     = structure containing Data
 **           tResult Result   = structure containing Results
@@ -19,6 +20,7 @@
 #include "gridgen.h"
 #include "boundary.h"
 #include "distribute.h"
+#include "stretch.h"
 #include "loc.h"
 
 int BuildBoundaries(FILE *log, tData* Data, tResult* Result)
@@ -156,6 +158,7 @@ int SideDEFG(FILE *log, tData *Data, tResult *Result)
 			loc_eta_max = Loc(&(*Result), Result->jm-1, i);
 			Result->x[loc_eta_max] = Result->xNode[i];
 			Result->y[loc_eta_max] = 0;
+			SetPatch(&(*Result), loc_eta_max, ptWall);
 		}
 
 		/* Distribute lowerNode+1 to cornerNodeE */
@@ -165,6 +168,7 @@ int SideDEFG(FILE *log, tData *Data, tResult *Result)
 			loc_eta_max = Loc(&(*Result), Result->jm-1, i);
 			Result->x[loc_eta_max] = Result->xNode[lowerNode] - (i-lowerNode)*deltaLength;
 			Result->y[loc_eta_max] = 0;
+			SetPatch(&(*Result), loc_eta_max, ptWall);
 		}
 
 		/* Distribute cornerNodeE+1 to cornerNodeF */
@@ -174,6 +178,7 @@ int SideDEFG(FILE *log, tData *Data, tResult *Result)
 			loc_eta_max = Loc(&(*Result), Result->jm-1, i);
 			Result->x[loc_eta_max] = 0;
 			Result->y[loc_eta_max] = (i - cornerNodeE)*deltaLength;
+			SetPatch(&(*Result), loc_eta_max, (i < cornerNodeF ? ptInflow : ptWall));
 		}
 
 		/* Distribute cornerNodeF+1 to higherNode */
@@ -183,6 +188,7 @@ int SideDEFG(FILE *log, tData *Data, tResult *Result)
 			loc_eta_max = Loc(&(*Result), Result->jm-1, i);
 			Result->x[loc_eta_max] = (i - cornerNodeF)*deltaLength;
 			Result->y[loc_eta_max] = Data->height;
+			SetPatch(&(*Result), loc_eta_max, ptWall);
 		}
 
 		/* Distribute nodes higherNode+1 to im-1 */
@@ -191,6 +197,7 @@ int SideDEFG(FILE *log, tData *Data, tResult *Result)
 			loc_eta_max = Loc(&(*Result), Result->jm-1, i);
 			Result->x[loc_eta_max] = Result->xNode[i];
 			Result->y[loc_eta_max] = Data->height;
+			SetPatch(&(*Result), loc_eta_max, ptWall);
 		}
 	}
 
@@ -252,7 +259,11 @@ int SideAD(FILE *log, tData *Data, tResult *Result)
 		refLength = Result->yNode[0];
 
 		/* Create a distribution */
-		if (Data->distributionType == 'U')
+		if (Data->stretchingType != 'N' && (Data->normalSpacing[0] > 0 || Data->normalSpacing[1] > 0))
+		{
+			ret = Stretch(&(*log), Data->stretchingType, Result->jm, refLength, Data->normalSpacing[0], Data->normalSpacing[1], v);
+		}
+		else if (Data->distributionType == 'U')
 		{
 			ret = Distribute1(&(*log), Result->jm, refLength, v);
 		}
@@ -266,6 +277,7 @@ int SideAD(FILE *log, tData *Data, tResult *Result)
 			loc_ksi_min = Loc(&(*Result), j, 0);
 			Result->x[loc_ksi_min] = Data->length;
 			Result->y[loc_ksi_min] = Result->yNode[0] - v[j];
+			SetPatch(&(*Result), loc_ksi_min, ptOutflow);
 		}
 
 		/* Free allocated memory */
@@ -322,7 +334,11 @@ int SideAG(FILE *log, tData *Data, tResult *Result)
 		refLength = Data->height - Result->yNode[Result->im-1];
 
 		/* Create a distribution */
-		if (Data->distributionType == 'U')
+		if (Data->stretchingType != 'N' && (Data->normalSpacing[0] > 0 || Data->normalSpacing[1] > 0))
+		{
+			ret = Stretch(&(*log), Data->stretchingType, Result->jm, refLength, Data->normalSpacing[0], Data->normalSpacing[1], v);
+		}
+		else if (Data->distributionType == 'U')
 		{
 			ret = Distribute1(&(*log), Result->jm, refLength, v);
 		}
@@ -336,6 +352,7 @@ int SideAG(FILE *log, tData *Data, tResult *Result)
 			loc_ksi_max = Loc(&(*Result), j, Result->im-1);
 			Result->x[loc_ksi_max] = Data->length;
 			Result->y[loc_ksi_max] = Result->yNode[Result->im-1] + v[j];
+			SetPatch(&(*Result), loc_ksi_max, ptOutflow);
 		}
 
 		/* Free allocated memory */
@@ -546,3 +563,26 @@ int CalcPoint(FILE *log, tData *Data, double slope, double *x, double *y)
 	return ret;
 }
 
+
+/*
+** Function SetPatch
+** Tags a node of a side with the boundary patch of that side. A node
+** on two sides (a corner) keeps the lower of the two patches, so that
+** the patch of a boundary edge is the higher one of its two nodes.
+**
+** In:       tResult Result   = structure containing Results
+**           int     loc      = position in array
+**           tPatch  patch    = boundary patch of the side
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int SetPatch(tResult *Result, int loc, tPatch patch)
+{
+	if (Result->patch[loc] == ptInterior || patch < Result->patch[loc])
+		Result->patch[loc] = patch;
+
+	return 0;
+}
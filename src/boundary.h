@@ -14,5 +14,6 @@ int FindSmallestNodeY(FILE*, tData*,  tResult*, int*);
 int FindLargestNodeY(FILE*, tData*, tResult*, int*);
 int CalcSlope(FILE*, int, double*, double*, double*);
 int CalcPoint(FILE*, tData*, double, double*, double*);
+int SetPatch(tResult*, int, tPatch);
 
 #endif
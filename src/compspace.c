@@ -31,19 +31,13 @@ int BuildComputationalSpace(FILE *log, tResult* Result)
 	ksiDelta = 1;
 	etaDelta = 1;
 
+	/*
+	** Only the spacing is stored; the co-ordinates ksi = i*ksiDelta and
+	** eta = j*etaDelta are returned on demand by Ksi() and Eta().
+	*/
 	Result->ksiDelta = ksiDelta;
 	Result->etaDelta = etaDelta;
 
-	for(j=0; j<Result->jm; j++)
-	{
-		for(i=0; i<Result->im; i++)
-		{
-			loc = Loc(&(*Result), j, i);
-			Result->ksi[loc] = i*ksiDelta;
-			Result->eta[loc] = j*etaDelta;
-		}
-	}
-
 	/* Write report */
 	if (log)
 	{
@@ -60,7 +54,7 @@ int BuildComputationalSpace(FILE *log, tResult* Result)
 			for(i=0; i<Result->im; i++)
 			{
 				loc = Loc(&(*Result), j, i);
-				fprintf(log, " %10.6f %10.6f\n", Result->ksi[loc], Result->eta[loc]);
+				fprintf(log, " %10.6f %10.6f\n", Ksi(&(*Result), loc), Eta(&(*Result), loc));
 			}
 		}
 
@@ -1,6 +1,9 @@
 /*
 ** C-file for MakeCut
 ** Makes a cut through the windtunnel to define the KSI-axis.
+** The nodes of ETA = 0 are tagged as aerofoil or cut; a node on the
+** cut is paired with the node on the other side of it, at the same
+** distance from the trailing edge.
 **
 ** In:       tData   Data     = structure containing Data
 **           tResult Result   = structure containing Results
@@ -19,7 +22,9 @@
 
 #include "gridgen.h"
 #include "cut.h"
+#include "loc.h"
 #include "distribute.h"
+#include "stretch.h"
 
 int MakeCut(FILE *log, tData* Data, tResult* Result)
 {
@@ -27,6 +32,7 @@ int MakeCut(FILE *log, tData* Data, tResult* Result)
 	int    i;
 
 	int    numNodes;
+	int    lower, upper;
 
 	double xDelta, yDelta;
 	double refLength;
@@ -70,7 +76,11 @@ int MakeCut(FILE *log, tData* Data, tResult* Result)
 	}
 	else
 	{
-		if (Data->distributionType == 'U')
+		if (Data->stretchingType != 'N' && (Data->cutSpacing[0] > 0 || Data->cutSpacing[1] > 0))
+		{
+			ret = Stretch(&(*log), Data->stretchingType, Data->numNodes2 + 1, refLength, Data->cutSpacing[0], Data->cutSpacing[1], v);
+		}
+		else if (Data->distributionType == 'U')
 		{
 			ret = Distribute1(&(*log), Data->numNodes2 + 1, refLength, v);
 		}
@@ -114,6 +124,34 @@ int MakeCut(FILE *log, tData* Data, tResult* Result)
 		Result->xNode = xDummy;
 		Result->yNode = yDummy;
 
+		/* Boundary patches of ETA = 0, and the pairs across the cut */
+		for (i=0; i<numNodes; i++)
+		{
+			lower = Loc(&(*Result), 0, i);
+			upper = Loc(&(*Result), 0, numNodes-1 - i);
+
+			if (i >= Data->numNodes2 && i < Data->numNodes2 + Data->numNodes1)
+			{
+				Result->patch[lower] = ptAerofoil;
+			}
+			else
+			{
+				Result->patch[lower]        = ptCut;
+				Result->periodicNode[lower] = upper;
+			}
+		}
+
+		/* A sharp trailing edge: its two nodes coincide */
+		lower = Loc(&(*Result), 0, Data->numNodes2);
+		upper = Loc(&(*Result), 0, Data->numNodes2 + Data->numNodes1-1);
+
+		if (fabs(Result->xNode[Data->numNodes2] - Result->xNode[Data->numNodes2 + Data->numNodes1-1]) < SMALL &&
+		    fabs(Result->yNode[Data->numNodes2] - Result->yNode[Data->numNodes2 + Data->numNodes1-1]) < SMALL)
+		{
+			Result->periodicNode[lower] = upper;
+			Result->periodicNode[upper] = lower;
+		}
+
 		/* Clear memory */
 		free(v);
 	}
@@ -15,8 +15,10 @@
 #include <stdlib.h>
 
 #include "gridgen.h"
+#include "halfedge.h"
 #include "data.h"
 #include "loc.h"
+#include "multiblock.h"
 
 int ReadData(FILE *log, char *dataFileName, tData *Data)
 {
@@ -174,6 +176,8 @@ int ReadData(FILE *log, char *dataFileName, tData *Data)
 /*
 ** Function WriteData.
 ** Writes data to data-file 'gridgen.out.1', 'gridgen.out.2' and 'grid.dat'
+** The boundary patches are written to 'gridgen.bnd' in every format,
+** the quadratic elements, if any, to 'gridgen.p2'.
 **
 ** In:       tResult Result = structure containing all results
 **
@@ -198,6 +202,12 @@ int WriteData(FILE *log, char format, tResult *Result)
 	if ((ret!=-1) && (format == 'G' || format == 'B'))
 		ret = WriteGNUData(&(*log), &(*Result));
 
+	if (ret!=-1)
+		ret = WriteBoundaryData(&(*log), &(*Result));
+
+	if ((ret!=-1) && (Result->numQuadraticElements > 0))
+		ret = WriteQuadraticData(&(*log), &(*Result));
+
 	if (log)
 	{
 		fprintf(log, "\n***** FUNCTION WRITEDATA *****\n\n");
@@ -239,8 +249,9 @@ int WriteVigieData(FILE *log, tResult *Result)
 
 	int    ret;
 	int    i;
-	int    numElements;
+	int    numElements, numTriangles;
 	int    node1, node2, node3, node4;
+	int    node[4];
 
 	double *area     = NULL;
 	double *aspect   = NULL;
@@ -266,8 +277,8 @@ int WriteVigieData(FILE *log, tResult *Result)
 		*/
 
 		/* Write point information */
-		fprintf(dataFile2, "points %d\n", Result->im*Result->jm);
-		for(i=0; i<Result->im*Result->jm; i++)
+		fprintf(dataFile2, "points %d\n", Result->numNodes);
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f %10.6f\n", Result->x[i], Result->y[i]);
 		}
@@ -280,9 +291,11 @@ int WriteVigieData(FILE *log, tResult *Result)
 			fprintf(dataFile2, "triangles %d\n", numElements);
 			for(i=0; i<numElements; i++)
 			{
-				node1 = Result->element[i].triangle.node[0];
-				node2 = Result->element[i].triangle.node[1];
-				node3 = Result->element[i].triangle.node[2];
+				CopyNodes(&(*Result), i, node);
+
+				node1 = node[0];
+				node2 = node[1];
+				node3 = node[2];
 
 				fprintf(dataFile2, "\t%d %d %d\n", node1, node2, node3);
 			}
@@ -292,14 +305,46 @@ int WriteVigieData(FILE *log, tResult *Result)
 			fprintf(dataFile2, "quadrangles %d\n", numElements);
 			for(i=0; i<numElements; i++)
 			{
-				node1 = Result->element[i].quadrangle.node[0];
-				node2 = Result->element[i].quadrangle.node[1];
-				node3 = Result->element[i].quadrangle.node[2];
-				node4 = Result->element[i].quadrangle.node[3];
+				CopyNodes(&(*Result), i, node);
+
+				node1 = node[0];
+				node2 = node[1];
+				node3 = node[2];
+				node4 = node[3];
 
 				fprintf(dataFile2, "\t%d %d %d %d\n", node1, node2, node3, node4);
 			}
 		}
+		else if (Result->elementType == etMixed)
+		{
+			/* The triangles first, then the quadrangles */
+			numTriangles = 0;
+			for(i=0; i<numElements; i++)
+				if (TypeOfElement(&(*Result), i) == etTriangle)
+					numTriangles++;
+
+			fprintf(dataFile2, "triangles %d\n", numTriangles);
+			for(i=0; i<numElements; i++)
+			{
+				if (TypeOfElement(&(*Result), i) != etTriangle)
+					continue;
+
+				CopyNodes(&(*Result), i, node);
+
+				fprintf(dataFile2, "\t%d %d %d\n", node[0], node[1], node[2]);
+			}
+
+			fprintf(dataFile2, "quadrangles %d\n", numElements-numTriangles);
+			for(i=0; i<numElements; i++)
+			{
+				if (TypeOfElement(&(*Result), i) != etQuadrangle)
+					continue;
+
+				CopyNodes(&(*Result), i, node);
+
+				fprintf(dataFile2, "\t%d %d %d %d\n", node[0], node[1], node[2], node[3]);
+			}
+		}
 		else
 		{
 			fprintf(stderr, "ERROR in function WriteVigieData: Unknown elementtype.\n");
@@ -308,44 +353,54 @@ int WriteVigieData(FILE *log, tResult *Result)
 
 		/* Write characteristics: EtaX */
 		fprintf(dataFile2, "scalars EtaX\n");
-		for(i=0; i<(Result->im*Result->jm); i++)
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f\n", Result->etaX[i]);
 		}
 
 		/* Write characteristics: EtaY */
 		fprintf(dataFile2, "scalars EtaY\n");
-		for(i=0; i<(Result->im*Result->jm); i++)
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f\n", Result->etaY[i]);
 		}
 
 		/* Write characteristics: KsiX */
 		fprintf(dataFile2, "scalars KsiX\n");
-		for(i=0; i<(Result->im*Result->jm); i++)
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f\n", Result->ksiX[i]);
 		}
 
 		/* Write characteristics: KsiY */
 		fprintf(dataFile2, "scalars KsiY\n");
-		for(i=0; i<(Result->im*Result->jm); i++)
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f\n", Result->ksiY[i]);
 		}
 
 		/* Write characteristics: Jacobian */
 		fprintf(dataFile2, "scalars Jacobian\n");
-		for(i=0; i<(Result->im*Result->jm); i++)
+		for(i=0; i<Result->numNodes; i++)
 		{
 			fprintf(dataFile2, "\t%10.6f\n", Result->jac[i]);
 		}
 
+		/* Write characteristics: WallDistance */
+		if (Result->wallDistance != NULL)
+		{
+			fprintf(dataFile2, "scalars WallDistance\n");
+			for(i=0; i<Result->numNodes; i++)
+			{
+				fprintf(dataFile2, "\t%10.6f\n", Result->wallDistance[i]);
+			}
+		}
+
 		/* Set up temporary arrays for nodal characteristics */
-		area     = (double*)malloc(Result->im*Result->jm*sizeof(double));
-		aspect   = (double*)malloc(Result->im*Result->jm*sizeof(double));
-		angle    = (double*)malloc(Result->im*Result->jm*sizeof(double));
-		skewness = (double*)malloc(Result->im*Result->jm*sizeof(double));
+		area     = (double*)malloc(Result->numNodes*sizeof(double));
+		aspect   = (double*)malloc(Result->numNodes*sizeof(double));
+		angle    = (double*)malloc(Result->numNodes*sizeof(double));
+		skewness = (double*)malloc(Result->numNodes*sizeof(double));
 
 		if(area == NULL || aspect == NULL || angle == NULL || skewness == NULL)
 		{
@@ -360,21 +415,21 @@ int WriteVigieData(FILE *log, tResult *Result)
 
 			/* Write the characteristics: ElementalArea */
 			fprintf(dataFile2, "scalars ElementalArea\n");
-			for(i=0; i<(Result->im*Result->jm); i++)
+			for(i=0; i<Result->numNodes; i++)
 			{
 				fprintf(dataFile2, "%10.6f\n", area[i]);
 			}
 
 			/* Write the characteristics: AspectRatio */
 			fprintf(dataFile2, "scalars AspectRatio\n");
-			for(i=0; i<(Result->im*Result->jm); i++)
+			for(i=0; i<Result->numNodes; i++)
 			{
 				fprintf(dataFile2, "\t%10.6f\n", aspect[i]);
 			}
 
 			/* Write the characteristics: MinimumAngle */
 			fprintf(dataFile2, "scalars MinimumAngle\n");
-			for(i=0; i<(Result->im*Result->jm); i++)
+			for(i=0; i<Result->numNodes; i++)
 			{
 				fprintf(dataFile2, "\t%10.6f\n", angle[i]);
 			}
@@ -383,7 +438,7 @@ int WriteVigieData(FILE *log, tResult *Result)
 			if (Result->elementType != etTriangle)
 			{
 				fprintf(dataFile2, "scalars Skewness\n");
-				for(i=0; i<(Result->im*Result->jm); i++)
+				for(i=0; i<Result->numNodes; i++)
 				{
 					fprintf(dataFile2, "\t%10.6f\n", skewness[i]);
 				}
@@ -455,17 +510,15 @@ int WriteGNUData(FILE *log, tResult *Result)
 	FILE   *dataFile2 = NULL;
 
 	int    ret;
-	int    i, j;
-	int    loc;
-	int    numElements;
-	int    node1, node2, node3, node4;
+	int    i, j, e, n;
+	int    loc, lattice;
+	int    node1;
+	int    node[4];
 
 	printf("Creating GNUPlot datafiles...\n"); 
 
 	ret = 0;
 
-	numElements = Result->numElements;
-
 	/*
 	** Write data for GNUPlot
 	*/
@@ -474,42 +527,24 @@ int WriteGNUData(FILE *log, tResult *Result)
 	if (dataFile1 && dataFile2)
 	{
 		/* Write the elements */
-		fprintf(dataFile1, "#        X          Y\n");
-		for(i=0; i<numElements; i++)
+		if (Result->elementType != etTriangle && Result->elementType != etQuadrangle && Result->elementType != etMixed)
 		{
-			if (Result->elementType == etTriangle)
-			{
-				node1 = Result->element[i].triangle.node[0];
-				node2 = Result->element[i].triangle.node[1];
-				node3 = Result->element[i].triangle.node[2];
+			fprintf(stderr, "ERROR in function WriteGNUData: Unknown elementtype.\n");
+			ret = -1;
+		}
 
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node1], Result->y[node1]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node2], Result->y[node2]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node3], Result->y[node3]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node1], Result->y[node1]);
+		fprintf(dataFile1, "#        X          Y\n");
+		for(e=0; e<Result->numElements && ret != -1; e++)
+		{
+			ret = CopyNodes(&(*Result), e, node);
 
-				fprintf(dataFile1, "\n");
-			}
-			else if (Result->elementType == etQuadrangle)
+			for(n=0; n<=NodesOfElement(&(*Result), e) && ret != -1; n++)
 			{
-				node1 = Result->element[i].quadrangle.node[0];
-				node2 = Result->element[i].quadrangle.node[1];
-				node3 = Result->element[i].quadrangle.node[2];
-				node4 = Result->element[i].quadrangle.node[3];
-
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node1], Result->y[node1]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node2], Result->y[node2]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node3], Result->y[node3]);
-				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node4], Result->y[node4]);
+				node1 = node[n % NodesOfElement(&(*Result), e)];
 				fprintf(dataFile1, "%10.6f %10.6f\n", Result->x[node1], Result->y[node1]);
-
-				fprintf(dataFile1, "\n");
-			}
-			else
-			{
-				fprintf(stderr, "ERROR in function WriteGNUData: Unknown elementtype.\n");
-				ret = -1;
 			}
+
+			fprintf(dataFile1, "\n");
 		}
 
 		/* Write the characteristics */
@@ -518,8 +553,9 @@ int WriteGNUData(FILE *log, tResult *Result)
 		{
                 	for(i=0; i<Result->im; i++)
 			{
-				loc = Loc(&(*Result), j, i);
-				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Result->ksi[loc], Result->eta[loc], Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc], Result->xKsiKsi[loc], Result->xKsiEta[loc], Result->xEtaEta[loc]);
+				lattice = Loc(&(*Result), j, i);
+				loc     = (Result->nodeNumber ? Result->nodeNumber[lattice] : lattice);
+				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Ksi(&(*Result), lattice), Eta(&(*Result), lattice), Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc], Result->xKsiKsi[loc], Result->xKsiEta[loc], Result->xEtaEta[loc]);
 			}
 
 			fprintf(dataFile2, "\n");
@@ -529,11 +565,12 @@ int WriteGNUData(FILE *log, tResult *Result)
 		{
                 	for(j=0; j<Result->jm; j++)
 			{
-				loc = Loc(&(*Result), j, i);
+				lattice = Loc(&(*Result), j, i);
+				loc     = (Result->nodeNumber ? Result->nodeNumber[lattice] : lattice);
 /*
-				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Result->ksi[loc], Result->eta[loc], Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc]);
+				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Ksi(&(*Result), loc), Eta(&(*Result), loc), Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc]);
 */
-				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Result->ksi[loc], Result->eta[loc], Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc], Result->xKsiKsi[loc], Result->xKsiEta[loc], Result->xEtaEta[loc]);
+				fprintf(dataFile2, "%10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f %10.6f\n", Ksi(&(*Result), lattice), Eta(&(*Result), lattice), Result->ksiX[loc], Result->ksiY[loc], Result->etaX[loc], Result->etaY[loc], Result->jac[loc], Result->xKsi[loc], Result->yKsi[loc], Result->xEta[loc], Result->yEta[loc], Result->xKsiKsi[loc], Result->xKsiEta[loc], Result->xEtaEta[loc]);
 			}
 
 			fprintf(dataFile2, "\n");
@@ -569,6 +606,458 @@ int WriteGNUData(FILE *log, tResult *Result)
 }
 
 
+/*
+** Function WriteBoundaryData.
+** Writes the boundary edges of the grid per boundary patch, in the
+** order and direction of the boundary loops, and the pairs of nodes
+** across the cut, so a solver need not find its boundaries itself.
+**
+** In:       tResult Result  = structure containing all results.
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.bnd: per patch "patch NAME n" and n edges "a b",
+**                        then "periodic n" and n node pairs "a b".
+**
+** Author:   J.L. Klaufus
+*/
+
+int WriteBoundaryData(FILE *log, tResult *Result)
+{
+	FILE   *dataFile = NULL;
+
+	int    ret;
+	int    n, h, l, p;
+	int    numEdges[NUMPATCHES];
+	int    numPairs;
+
+	char   *patchName[NUMPATCHES] = {"interior", "aerofoil", "cut", "wall", "inflow", "outflow"};
+
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
+	printf("Creating boundary datafile...\n");
+
+	ret      = 0;
+	numPairs = 0;
+
+	for(p=0; p<NUMPATCHES; p++)
+		numEdges[p] = 0;
+
+	dataFile = fopen("gridgen.bnd", "w");
+	if (dataFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function WriteBoundaryData: Could not open 'gridgen.bnd'.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+		ret = BuildHalfEdges(NULL, &(*Result), &HalfEdge);
+
+	if (ret != -1)
+	{
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] == -1)
+				numEdges[PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h))]++;
+
+		/* The edges of each patch */
+		for(p=ptAerofoil; p<NUMPATCHES; p++)
+		{
+			fprintf(dataFile, "patch %s %d\n", patchName[p], numEdges[p]);
+
+			for(l=0; l<HalfEdge.numBoundaryLoops; l++)
+			{
+				h = HalfEdge.loopStart[l];
+				do
+				{
+					if (PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h)) == p)
+						fprintf(dataFile, "\t%d %d\n", HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h));
+
+					h = HalfEdge.boundaryNext[h];
+				} while (h != HalfEdge.loopStart[l]);
+			}
+		}
+
+		/* The pairs of nodes across the cut */
+		for(n=0; n<Result->numNodes; n++)
+			if (Result->periodicNode[n] > n)
+				numPairs++;
+
+		fprintf(dataFile, "periodic %d\n", numPairs);
+		for(n=0; n<Result->numNodes; n++)
+			if (Result->periodicNode[n] > n)
+				fprintf(dataFile, "\t%d %d\n", n, Result->periodicNode[n]);
+
+		/* Unclassified boundary edges */
+		if (numEdges[ptInterior] > 0)
+			fprintf(stderr, "WARNING in function WriteBoundaryData: %d boundary edges without patch.\n", numEdges[ptInterior]);
+	}
+
+	FreeHalfEdges(&HalfEdge);
+
+	/* Close the file */
+	if (dataFile)
+		fclose(dataFile);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION WRITEBOUNDARYDATA *****\n\n");
+
+		if (ret != -1)
+		{
+			for(p=ptAerofoil; p<NUMPATCHES; p++)
+				fprintf(log, "%-8s edges  = %d\n", patchName[p], numEdges[p]);
+
+			fprintf(log, "periodic pairs  = %d\n", numPairs);
+		}
+		else
+			fprintf(log, "Boundary data NOT succesfully written to file.\n");
+
+		fprintf(log, "\n*********************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function WriteBlockData.
+** Writes a multiblock grid: the nodes of every block, row by row, and
+** every interface once, with the pairs of nodes it joins, numbered
+** within their blocks. The grid lines also go to gridgen.gnu.1.
+**
+** In:       tMultiblock Multiblock = the blocks
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.mb: "blocks n", "block b im jm", "interfaces n",
+**           "interface block side block side reversed n".
+**
+** Author:   J.L. Klaufus
+*/
+
+int WriteBlockData(FILE *log, tMultiblock *Multiblock)
+{
+	FILE   *dataFile  = NULL;
+	FILE   *dataFile1 = NULL;
+
+	int    ret;
+	int    b, i, j, k, n;
+	int    side, other;
+	int    loc;
+	int    numInterfaces;
+
+	tResult *Block;
+
+	printf("Creating multiblock datafiles...\n");
+
+	ret           = 0;
+	numInterfaces = 0;
+
+	dataFile  = fopen("gridgen.mb", "w");
+	dataFile1 = fopen("gridgen.gnu.1", "w");
+	if ((dataFile == NULL) || (dataFile1 == NULL))
+	{
+		fprintf(stderr, "ERROR in function WriteBlockData: Could not open 'gridgen.mb' or 'gridgen.gnu.1'.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* The nodes */
+		fprintf(dataFile, "blocks %d\n", Multiblock->numBlocks);
+		for(b=0; b<Multiblock->numBlocks; b++)
+		{
+			Block = &(Multiblock->block[b]);
+
+			fprintf(dataFile, "block %d %d %d\n", b, Block->im, Block->jm);
+			for(loc=0; loc<Block->numNodes; loc++)
+				fprintf(dataFile, "\t%10.6f %10.6f\n", Block->x[loc], Block->y[loc]);
+		}
+
+		/* The interfaces, each once */
+		for(side=0; side<NUMSIDES*Multiblock->numBlocks; side++)
+			if ((Multiblock->neighbour[side] != -1) &&
+			    (NUMSIDES*Multiblock->neighbour[side] + Multiblock->neighbourSide[side] > side))
+				numInterfaces++;
+
+		fprintf(dataFile, "interfaces %d\n", numInterfaces);
+		for(side=0; side<NUMSIDES*Multiblock->numBlocks; side++)
+		{
+			other = NUMSIDES*Multiblock->neighbour[side] + Multiblock->neighbourSide[side];
+
+			if ((Multiblock->neighbour[side] == -1) || (other < side))
+				continue;
+
+			Block = &(Multiblock->block[side/NUMSIDES]);
+			n     = ((side % NUMSIDES) % 2 == 0 ? Block->im : Block->jm);
+
+			fprintf(dataFile, "interface %d %d %d %d %d %d\n", side/NUMSIDES, side % NUMSIDES,
+			        other/NUMSIDES, other % NUMSIDES, Multiblock->reversed[side], n);
+
+			for(k=0; k<n; k++)
+				fprintf(dataFile, "\t%d %d\n", SideLoc(Block, side % NUMSIDES, k, 0),
+				        SideLoc(&(Multiblock->block[other/NUMSIDES]), other % NUMSIDES,
+				                (Multiblock->reversed[side] ? n-1-k : k), 0));
+		}
+
+		/* The grid lines for GNUPlot */
+		fprintf(dataFile1, "#        X          Y\n");
+		for(b=0; b<Multiblock->numBlocks; b++)
+		{
+			Block = &(Multiblock->block[b]);
+
+			for(j=0; j<Block->jm; j++)
+			{
+				for(i=0; i<Block->im; i++)
+				{
+					loc = Loc(&(*Block), j, i);
+					fprintf(dataFile1, "%10.6f %10.6f\n", Block->x[loc], Block->y[loc]);
+				}
+				fprintf(dataFile1, "\n");
+			}
+
+			for(i=0; i<Block->im; i++)
+			{
+				for(j=0; j<Block->jm; j++)
+				{
+					loc = Loc(&(*Block), j, i);
+					fprintf(dataFile1, "%10.6f %10.6f\n", Block->x[loc], Block->y[loc]);
+				}
+				fprintf(dataFile1, "\n");
+			}
+		}
+	}
+
+	/* Close the files */
+	if (dataFile)
+		fclose(dataFile);
+	if (dataFile1)
+		fclose(dataFile1);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION WRITEBLOCKDATA *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "blocks     = %d\n", Multiblock->numBlocks);
+			fprintf(log, "interfaces = %d\n", numInterfaces);
+		}
+		else
+			fprintf(log, "Multiblock data NOT succesfully written to file.\n");
+
+		fprintf(log, "\n*********************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function WriteOversetData.
+** Writes the background grid of an overset grid and the connectivity
+** between both grids: the type of every node (0 field, 1 fringe,
+** 2 hole) and per receptor its grid (0 body, 1 background), its node,
+** the donor element of the other grid and the weights of its nodes.
+** The cells of the background grid outside the holes go to
+** gridgen.gnu.3.
+**
+** In:       tOverset Overset = background grid and connectivity
+**           tResult  Result  = structure containing all results.
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.ovs: "background im jm" and its nodes "x y type",
+**           "body n" and its types, "receptors n" and
+**           "grid node element w1 w2 w3 w4" per receptor.
+**
+** Author:   J.L. Klaufus
+*/
+
+int WriteOversetData(FILE *log, tOverset *Overset, tResult *Result)
+{
+	FILE   *dataFile  = NULL;
+	FILE   *dataFile3 = NULL;
+
+	int    ret;
+	int    n, r, e, k;
+	int    node[4];
+
+	tResult *Background;
+
+	printf("Creating overset datafiles...\n");
+
+	ret        = 0;
+	Background = Overset->background;
+
+	dataFile  = fopen("gridgen.ovs", "w");
+	dataFile3 = fopen("gridgen.gnu.3", "w");
+	if ((dataFile == NULL) || (dataFile3 == NULL))
+	{
+		fprintf(stderr, "ERROR in function WriteOversetData: Could not open 'gridgen.ovs' or 'gridgen.gnu.3'.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* The nodes and their types */
+		fprintf(dataFile, "background %d %d\n", Background->im, Background->jm);
+		for(n=0; n<Background->numNodes; n++)
+			fprintf(dataFile, "\t%10.6f %10.6f %d\n", Background->x[n], Background->y[n], Overset->backgroundType[n]);
+
+		fprintf(dataFile, "body %d\n", Result->numNodes);
+		for(n=0; n<Result->numNodes; n++)
+			fprintf(dataFile, "\t%d\n", Overset->bodyType[n]);
+
+		/* The donors */
+		fprintf(dataFile, "receptors %d\n", Overset->numReceptors);
+		for(r=0; r<Overset->numReceptors; r++)
+			fprintf(dataFile, "\t%d %8d %8d %10.6f %10.6f %10.6f %10.6f\n", Overset->receptorGrid[r],
+			        Overset->receptorNode[r], Overset->donorElement[r], Overset->donorWeight[4*r],
+			        Overset->donorWeight[4*r+1], Overset->donorWeight[4*r+2], Overset->donorWeight[4*r+3]);
+
+		/* The cells without holes for GNUPlot */
+		fprintf(dataFile3, "#        X          Y\n");
+		for(e=0; e<Background->numElements; e++)
+		{
+			CopyNodes(&(*Background), e, node);
+
+			for(k=0; k<4 && Overset->backgroundType[node[k]] != otHole; k++);
+
+			if (k < 4)
+				continue;
+
+			for(k=0; k<=4; k++)
+				fprintf(dataFile3, "%10.6f %10.6f\n", Background->x[node[k % 4]], Background->y[node[k % 4]]);
+			fprintf(dataFile3, "\n");
+		}
+	}
+
+	/* Close the files */
+	if (dataFile)
+		fclose(dataFile);
+	if (dataFile3)
+		fclose(dataFile3);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION WRITEOVERSETDATA *****\n\n");
+
+		if (ret != -1)
+			fprintf(log, "Overset data succesfully written to file.\n");
+		else
+			fprintf(log, "Overset data NOT succesfully written to file.\n");
+
+		fprintf(log, "\n*********************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function WriteQuadraticData.
+** Writes the quadratic elements in the ASCII format of gridgen.vig:
+** the points, then the 6-node triangles and the 9-node quadrangles,
+** corners first, then the middles of the edges (and the centre).
+**
+** In:       tResult Result  = structure containing all results.
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.p2: "points n", "triangles6 n", "quadrangles9 n".
+**
+** Author:   J.L. Klaufus
+*/
+
+int WriteQuadraticData(FILE *log, tResult *Result)
+{
+	FILE   *dataFile = NULL;
+
+	int    ret;
+	int    i, k;
+	int    numTriangles;
+
+	printf("Creating quadratic datafile...\n");
+
+	ret          = 0;
+	numTriangles = 0;
+
+	dataFile = fopen("gridgen.p2", "w");
+	if (dataFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function WriteQuadraticData: Could not open 'gridgen.p2'.\n");
+		ret = -1;
+	}
+	else
+	{
+		/* Write point information */
+		fprintf(dataFile, "points %d\n", Result->numQuadraticNodes);
+		for(i=0; i<Result->numQuadraticNodes; i++)
+			fprintf(dataFile, "\t%10.6f %10.6f\n", Result->xQuadratic[i], Result->yQuadratic[i]);
+
+		/* Write connectivity information, the triangles first */
+		for(i=0; i<Result->numQuadraticElements; i++)
+			if (Result->quadraticTypes[i] == etTriangle6)
+				numTriangles++;
+
+		if (numTriangles > 0)
+		{
+			fprintf(dataFile, "triangles6 %d\n", numTriangles);
+			for(i=0; i<Result->numQuadraticElements; i++)
+			{
+				if (Result->quadraticTypes[i] != etTriangle6)
+					continue;
+
+				for(k=0; k<6; k++)
+					fprintf(dataFile, (k == 0 ? "\t%d" : " %d"), Result->quadraticElement[i].triangle.node[k]);
+
+				fprintf(dataFile, "\n");
+			}
+		}
+
+		if (numTriangles < Result->numQuadraticElements)
+		{
+			fprintf(dataFile, "quadrangles9 %d\n", Result->numQuadraticElements-numTriangles);
+			for(i=0; i<Result->numQuadraticElements; i++)
+			{
+				if (Result->quadraticTypes[i] != etQuadrangle9)
+					continue;
+
+				for(k=0; k<9; k++)
+					fprintf(dataFile, (k == 0 ? "\t%d" : " %d"), Result->quadraticElement[i].quadrangle.node[k]);
+
+				fprintf(dataFile, "\n");
+			}
+		}
+
+		fclose(dataFile);
+	}
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION WRITEQUADRATICDATA *****\n\n");
+
+		if (ret != -1)
+			fprintf(log, "Quadratic data succesfully written to file.\n");
+		else
+			fprintf(log, "Quadratic data NOT succesfully written to file.\n");
+
+		fprintf(log, "\n*********************************\n\n");
+	}
+
+	return ret;
+}
+
 /*
 ** Function CalcCharAtNodes.
 ** Calculates values for elemental characteristics at the nodes.
@@ -599,35 +1088,36 @@ int CalcCharAtNodes(FILE *log, tResult *Result, double *area, double *aspect, do
 	int elementsFound;
 	int *elementID = NULL;
 
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
 	/*printf("Calculating element characteristics at nodes...\n");*/
 
 	ret = 0;
 
+	/* The elements around the nodes follow from the half-edges */
+	if(Result->elementType != etTriangle && Result->elementType != etQuadrangle && Result->elementType != etMixed)
+		ret = -1;
+
+	if(ret != -1)
+		ret = BuildHalfEdges(&(*log), &(*Result), &HalfEdge);
+
 	/* Allocate memory for temporary array */
-	if(Result->elementType == etTriangle)
-		maxPossible = 6;
-	else if(Result->elementType == etQuadrangle)
-		maxPossible = 4;
-	else
-	{
-		maxPossible = 0;
-		ret         = -1;
-	}
+	maxPossible = (HalfEdge.maxValence > 0 ? HalfEdge.maxValence : 1);
 
 	elementID = (int*)malloc(maxPossible*sizeof(int));
 
-	if(elementID == NULL)
+	if(ret == -1 || elementID == NULL)
 	{
 		fprintf(stderr, "ERROR in function CalcCharAtNodes: Could not allocate memory.\n");
 		ret = -1;
 	}
 	else
 	{
-		for(n=0; n<(Result->im*Result->jm); n++)
+		for(n=0; n<Result->numNodes; n++)
 		{
 			/* Find the elements that use the current node */
 			if(ret != -1)
-				ret = FindElements(&(*log), &(*Result), n, &elementsFound, elementID);
+				ret = FindElements(&(*log), &HalfEdge, n, &elementsFound, elementID);
 
 			area[n]     = 0;
 			aspect[n]   = 0;
@@ -639,18 +1129,18 @@ int CalcCharAtNodes(FILE *log, tResult *Result, double *area, double *aspect, do
 				ee = elementID[e];
 
 				/* Calculate the average elemental characteristics at the node */
-				if(Result->elementType == etTriangle)
+				if(TypeOfElement(&(*Result), ee) == etTriangle)
 				{
-					area[n]     += Result->element[ee].triangle.elementalArea/(double)(elementsFound);
-					aspect[n]   += Result->element[ee].triangle.aspectRatio/(double)(elementsFound);
-					angle[n]    += Result->element[ee].triangle.minimumAngle/(double)(elementsFound);
+					area[n]     += Result->elementalArea[ee]/(double)(elementsFound);
+					aspect[n]   += Result->aspectRatio[ee]/(double)(elementsFound);
+					angle[n]    += Result->minimumAngle[ee]/(double)(elementsFound);
 				}
-				else if(Result->elementType == etQuadrangle)
+				else if(TypeOfElement(&(*Result), ee) == etQuadrangle)
 				{
-					area[n]     += Result->element[ee].quadrangle.elementalArea/(double)(elementsFound);
-					aspect[n]   += Result->element[ee].quadrangle.aspectRatio/(double)(elementsFound);
-					angle[n]    += Result->element[ee].quadrangle.minimumAngle/(double)(elementsFound);
-					skewness[n] += Result->element[ee].quadrangle.skewness/(double)(elementsFound);
+					area[n]     += Result->elementalArea[ee]/(double)(elementsFound);
+					aspect[n]   += Result->aspectRatio[ee]/(double)(elementsFound);
+					angle[n]    += Result->minimumAngle[ee]/(double)(elementsFound);
+					skewness[n] += Result->skewness[ee]/(double)(elementsFound);
 				}
 				else
 				{
@@ -664,6 +1154,8 @@ int CalcCharAtNodes(FILE *log, tResult *Result, double *area, double *aspect, do
 	if(elementID != NULL)
 		free(elementID);
 
+	FreeHalfEdges(&HalfEdge);
+
 	/* Write report */
 	if (log)
 	{
@@ -671,7 +1163,7 @@ int CalcCharAtNodes(FILE *log, tResult *Result, double *area, double *aspect, do
 
 		fprintf(log, "Node       Area         AR      Angle    Skewness\n");
 
-		for(n=0; n<Result->im*Result->jm; n++)
+		for(n=0; n<Result->numNodes; n++)
 		{
 			fprintf(log, " %3d %10.6f %10.6f %10.6f %10.6f\n", n, area[n], aspect[n], angle[n], skewness[n]);
 		}
@@ -685,63 +1177,47 @@ int CalcCharAtNodes(FILE *log, tResult *Result, double *area, double *aspect, do
 
 /*
 ** Function FindElements.
-** Find all elements sharing a specified node.
+** Find all elements sharing a specified node, by walking the ring of
+** half-edges around the node.
 **
-** In:       tResult Result  = structure containing all results.
-**           int     node    = node identifier
+** In:       tHalfEdge HalfEdge = half-edge structure of the grid.
+**           int       node     = node identifier
 **
 ** Out:      int     elementsFound = number of elements sharing the specified node
 **           int     elementID     = array containing the element identifiers shring
-**                                   the specified node.
+**                                   the specified node, in ascending order.
 **
 ** Return:   0 on success, -1 on failure
 **
 ** Author:   J.L. Klaufus
 */
 
-int FindElements(FILE *log, tResult *Result, int node, int *elementsFound, int *elementID)
+int FindElements(FILE *log, tHalfEdge *HalfEdge, int node, int *elementsFound, int *elementID)
 {
 	int ret;
-	int e, n;
-	int maxPossible;
-	int found;
+	int e, h, k;
+	int element;
 
 	/*printf("Searching elements...\n");*/
 
 	ret = 0;
 
-	if(Result->elementType == etTriangle)
-		maxPossible = 6;
-	else if(Result->elementType == etQuadrangle)
-		maxPossible = 4;
-	else
-	{
-		maxPossible = 0;
-		ret         = -1;
-	}
-
-	e              = 0;
 	*elementsFound = 0;
-	while((e < Result->numElements) && (*elementsFound < maxPossible) && (ret != -1))
-	{
-		found = 0;
-		n = 0;
-		while (n<Result->nodesPerElement && found == 0 && ret != -1)
-		{
-			if (Result->elementType == etTriangle)
-				found = (node == Result->element[e].triangle.node[n] ? 1 : 0);
-			else if (Result->elementType == etQuadrangle)
-				found = (node == Result->element[e].quadrangle.node[n] ? 1 : 0);
-			else
-				ret = -1;
 
-			n++;
+	for(h=NodeRingFirst(&(*HalfEdge), node); h!=-1; h=NodeRingNext(&(*HalfEdge), node, h))
+	{
+		if (*elementsFound == HalfEdge->maxValence)
+		{
+			ret = -1;
+			break;
 		}
 
-		if(found == 1)
-			elementID[(*elementsFound)++] = e;
+		/* Insert in ascending order */
+		element = HalfEdgeElement(&(*HalfEdge), h);
 
-		e++;
+		for(k=(*elementsFound)++; k>0 && elementID[k-1]>element; k--)
+			elementID[k] = elementID[k-1];
+		elementID[k] = element;
 	}
 
 	/* Write report */
@@ -761,4 +1237,3 @@ int FindElements(FILE *log, tResult *Result, int node, int *elementsFound, int *
 
 	return ret;
 }
-
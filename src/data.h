@@ -9,7 +9,11 @@ int ReadData(FILE*, char*, tData*);
 int WriteData(FILE*, char, tResult*);
 int WriteVigieData(FILE*, tResult*);
 int WriteGNUData(FILE*, tResult*);
+int WriteBoundaryData(FILE*, tResult*);
+int WriteQuadraticData(FILE*, tResult*);
+int WriteBlockData(FILE*, tMultiblock*);
+int WriteOversetData(FILE*, tOverset*, tResult*);
 int CalcCharAtNodes(FILE*, tResult*, double*, double*, double*, double*);
-int FindElements(FILE*, tResult*, int, int*, int*);
+int FindElements(FILE*, tHalfEdge*, int, int*, int*);
 
 #endif
@@ -0,0 +1,1459 @@
+/*
+** C-file for Delaunay
+** Creates an unstructured grid by a constrained Delaunay triangulation
+** of the nodes of the elliptic grid. The points are inserted one by one
+** (Bowyer-Watson) in a spatially sorted order; each point is located by
+** walking from the previously created triangle. Afterwards the aerofoil
+** and the windtunnel walls are recovered as constraints, and all
+** triangles inside the aerofoil or outside the windtunnel are removed.
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "delaunay.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "adjacency.h"
+#include "renumber.h"
+
+int Delaunay(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    i, j, s;
+
+	int    numPoints;
+	int    numSegments;
+	int    numTriangles;
+
+	int    *segment  = NULL;
+	int    *triangle = NULL;
+	int    *pointMap = NULL;
+
+	printf("Delaunay triangulating...\n");
+
+	ret = 0;
+
+	numPoints   = Result->numNodes;
+	numSegments = (Result->im-1) + 2*(Result->jm-1) + (Data->numNodes1-1);
+
+	segment  = (int*)malloc(2*numSegments*sizeof(int));
+	pointMap = (int*)malloc(numPoints*sizeof(int));
+
+	if (segment == NULL || pointMap == NULL)
+	{
+		fprintf(stderr, "ERROR in function Delaunay: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else
+	{
+		/*
+		** Constraints: the windtunnel walls KSI = 0, ETA = max and KSI = max,
+		** followed by the aerofoil part of ETA = 0. The cutting line is
+		** not a constraint; its coinciding nodes are merged.
+		*/
+		s = 0;
+		for(j=0; j<Result->jm-1; j++)
+		{
+			segment[2*s]   = Loc(&(*Result), j, 0);
+			segment[2*s+1] = Loc(&(*Result), j+1, 0);
+			s++;
+		}
+
+		for(i=0; i<Result->im-1; i++)
+		{
+			segment[2*s]   = Loc(&(*Result), Result->jm-1, i);
+			segment[2*s+1] = Loc(&(*Result), Result->jm-1, i+1);
+			s++;
+		}
+
+		for(j=Result->jm-1; j>0; j--)
+		{
+			segment[2*s]   = Loc(&(*Result), j, Result->im-1);
+			segment[2*s+1] = Loc(&(*Result), j-1, Result->im-1);
+			s++;
+		}
+
+		for(i=Data->numNodes2; i<Data->numNodes2+Data->numNodes1-1; i++)
+		{
+			segment[2*s]   = Loc(&(*Result), 0, i);
+			segment[2*s+1] = Loc(&(*Result), 0, i+1);
+			s++;
+		}
+
+		ret = DelaunayTriangulate(&(*log), numPoints, Result->x, Result->y, numSegments, segment, &numTriangles, &triangle, pointMap);
+	}
+
+	if (ret != -1)
+	{
+		/* Set the characteristics in the Result structure */
+		Result->numElements        = numTriangles;
+		Result->elementType        = etTriangle;
+		Result->nodesPerElement    = 3;
+		Result->structuredElements = 0;
+
+		if (Result->element != NULL)
+			free(Result->element);
+
+		Result->element = (tElement*)malloc(numTriangles*sizeof(tElement));
+
+		if (Result->element == NULL)
+		{
+			fprintf(stderr, "ERROR in function Delaunay: Could not allocate memory.\n");
+			ret = -1;
+		}
+		else
+		{
+			/* Clockwise, as the elements of all other grid types */
+			for(i=0; i<numTriangles; i++)
+			{
+				Result->element[i].triangle.node[0] = triangle[3*i];
+				Result->element[i].triangle.node[1] = triangle[3*i+2];
+				Result->element[i].triangle.node[2] = triangle[3*i+1];
+			}
+
+			/* With its nodes merged the cutting line is no boundary */
+			for(i=0; i<Result->numNodes; i++)
+			{
+				if (Result->patch[i] == ptCut)
+					Result->patch[i] = ptInterior;
+
+				Result->periodicNode[i] = -1;
+			}
+
+			/* Every (j,i) keeps the node it is merged into, until CompactNodes */
+			if (Result->nodeNumber != NULL)
+				free(Result->nodeNumber);
+
+			Result->nodeNumber = pointMap;
+			pointMap           = NULL;
+		}
+	}
+
+	printf("Number of triangles  = %d\n", (ret != -1 ? numTriangles : 0));
+
+	/* Free allocated memory */
+	if (segment)
+		free(segment);
+
+	if (pointMap)
+		free(pointMap);
+
+	if (triangle)
+		free(triangle);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION DELAUNAY *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "  N Node1 Node2 Node3\n");
+
+			for(i=0; i<Result->numElements; i++)
+			{
+				fprintf(log, "%3d   %3d   %3d   %3d\n", i, Result->element[i].triangle.node[0], Result->element[i].triangle.node[1], Result->element[i].triangle.node[2]);
+			}
+		}
+		else
+		{
+			fprintf(log, "Delaunay triangulation NOT successfully ended.\n");
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function DelaunayTriangulate
+** Constrained Delaunay triangulation of an arbitrary point set.
+**
+** In:       int    numPoints    = number of points
+**           double x, y         = co-ordinates of the points
+**           int    numSegments  = number of constraining segments
+**           int    segment      = pairs of point numbers forming the
+**                                 segments; together they must form closed
+**                                 loops (outer boundary and holes).
+**
+** Out:      int    numTriangles = number of triangles
+**           int    triangle     = triplets of point numbers, counter-clockwise;
+**                                 allocated here, to be freed by the caller.
+**           int    pointMap     = for each point the point actually used;
+**                                 differs from the point itself for
+**                                 coinciding points only.
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int DelaunayTriangulate(FILE *log, int numPoints, double *x, double *y,
+                        int numSegments, int *segment,
+                        int *numTriangles, int **triangle, int *pointMap)
+{
+	int    ret;
+	int    i, k, t, s;
+	int    a, b;
+	int    numKept;
+	int    numDuplicates;
+
+	int    *order = NULL;
+	int    *keep  = NULL;
+
+	double xMin, xMax, yMin, yMax;
+	double xMid, yMid, size;
+
+	tDelaunay Mesh;
+
+	ret           = 0;
+	numKept       = 0;
+	numDuplicates = 0;
+	*numTriangles = 0;
+	*triangle     = NULL;
+
+	/* Allocate memory; three extra points for the super triangle */
+	Mesh.numPoints      = numPoints;
+	Mesh.maxTriangles   = 2*numPoints + 16;
+	Mesh.maxCavity      = 64;
+	Mesh.maxBoundary    = 64;
+	Mesh.numTriangles   = 0;
+	Mesh.stamp          = 0;
+
+	Mesh.x              = (double*)malloc((numPoints+3)*sizeof(double));
+	Mesh.y              = (double*)malloc((numPoints+3)*sizeof(double));
+	Mesh.tri            = (tDelaunayTriangle*)malloc(Mesh.maxTriangles*sizeof(tDelaunayTriangle));
+	Mesh.vertexTriangle = (int*)malloc((numPoints+3)*sizeof(int));
+	Mesh.firstOf        = (int*)malloc((numPoints+3)*sizeof(int));
+	Mesh.cavity         = (int*)malloc(Mesh.maxCavity*sizeof(int));
+	Mesh.boundary       = (int*)malloc(4*Mesh.maxBoundary*sizeof(int));
+	order               = (int*)malloc(numPoints*sizeof(int));
+
+	if (Mesh.x == NULL || Mesh.y == NULL || Mesh.tri == NULL ||
+	    Mesh.vertexTriangle == NULL || Mesh.firstOf == NULL ||
+	    Mesh.cavity == NULL || Mesh.boundary == NULL || order == NULL || numPoints < 3)
+	{
+		fprintf(stderr, "ERROR in function DelaunayTriangulate: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else
+	{
+		/* Bounding box */
+		xMin = xMax = x[0];
+		yMin = yMax = y[0];
+		for(i=0; i<numPoints; i++)
+		{
+			Mesh.x[i] = x[i];
+			Mesh.y[i] = y[i];
+
+			xMin = (x[i] < xMin ? x[i] : xMin);
+			xMax = (x[i] > xMax ? x[i] : xMax);
+			yMin = (y[i] < yMin ? y[i] : yMin);
+			yMax = (y[i] > yMax ? y[i] : yMax);
+		}
+
+		xMid = (xMin + xMax)/2;
+		yMid = (yMin + yMax)/2;
+		size = (xMax - xMin > yMax - yMin ? xMax - xMin : yMax - yMin);
+		size = (size > SMALL ? size : 1);
+
+		Mesh.tolerance = SMALL*size;
+
+		/* Super triangle, well away from all points */
+		Mesh.x[numPoints]   = xMid - 50*size;
+		Mesh.y[numPoints]   = yMid - 50*size;
+		Mesh.x[numPoints+1] = xMid + 50*size;
+		Mesh.y[numPoints+1] = yMid - 50*size;
+		Mesh.x[numPoints+2] = xMid;
+		Mesh.y[numPoints+2] = yMid + 50*size;
+
+		for(k=0; k<3; k++)
+		{
+			Mesh.tri[0].v[k] = numPoints + k;
+			Mesh.tri[0].n[k] = -1;
+			Mesh.tri[0].c[k] = 0;
+			Mesh.vertexTriangle[numPoints+k] = 0;
+		}
+		Mesh.tri[0].mark  = 0;
+		Mesh.tri[0].dead  = 0;
+		Mesh.numTriangles = 1;
+		Mesh.lastTriangle = 0;
+
+		/* Insert the points in spatially sorted order */
+		ret = SortPoints(numPoints, x, y, order);
+
+		for(i=0; i<numPoints && ret != -1; i++)
+		{
+			ret = InsertPoint(&Mesh, order[i], &pointMap[order[i]]);
+
+			if (pointMap[order[i]] != order[i])
+				numDuplicates++;
+		}
+
+		/* Recover the constraining segments */
+		for(s=0; s<numSegments && ret != -1; s++)
+		{
+			a = pointMap[segment[2*s]];
+			b = pointMap[segment[2*s+1]];
+
+			if (a != b)
+				ret = RecoverSegment(&Mesh, a, b, 0);
+		}
+
+		/* Restore the Delaunay property around the recovered segments */
+		if (ret != -1)
+			ret = LegalizeEdges(&Mesh);
+
+		/* Remove the triangles outside the domain */
+		if (ret != -1)
+		{
+			keep = (int*)malloc(Mesh.numTriangles*sizeof(int));
+
+			if (keep == NULL)
+			{
+				fprintf(stderr, "ERROR in function DelaunayTriangulate: Could not allocate memory.\n");
+				ret = -1;
+			}
+			else
+			{
+				ret = ClassifyTriangles(&Mesh, keep);
+			}
+		}
+
+		/* Copy the remaining triangles */
+		if (ret != -1)
+		{
+			for(t=0; t<Mesh.numTriangles; t++)
+				numKept += keep[t];
+
+			*triangle = (int*)malloc(3*(numKept > 0 ? numKept : 1)*sizeof(int));
+
+			if (*triangle == NULL)
+			{
+				fprintf(stderr, "ERROR in function DelaunayTriangulate: Could not allocate memory.\n");
+				ret = -1;
+			}
+			else
+			{
+				i = 0;
+				for(t=0; t<Mesh.numTriangles; t++)
+				{
+					if (keep[t])
+					{
+						for(k=0; k<3; k++)
+							(*triangle)[3*i+k] = Mesh.tri[t].v[k];
+						i++;
+					}
+				}
+
+				*numTriangles = numKept;
+			}
+		}
+	}
+
+	/* Free allocated memory */
+	free(Mesh.x);
+	free(Mesh.y);
+	free(Mesh.tri);
+	free(Mesh.vertexTriangle);
+	free(Mesh.firstOf);
+	free(Mesh.cavity);
+	free(Mesh.boundary);
+
+	if (order)
+		free(order);
+
+	if (keep)
+		free(keep);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION DELAUNAYTRIANGULATE *****\n\n");
+
+		fprintf(log, "number of points     = %d\n", numPoints);
+		fprintf(log, "coinciding points    = %d\n", numDuplicates);
+		fprintf(log, "number of segments   = %d\n", numSegments);
+		fprintf(log, "number of triangles  = %d\n", *numTriangles);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function SortPoints
+** Determines the insertion order of the points: a biased randomized
+** insertion order (BRIO), with the points of each round sorted along
+** a Hilbert curve. Consecutive points are then close to each other,
+** which keeps the walks of LocateTriangle short.
+**
+** In:       int    numPoints = number of points
+**           double x, y      = co-ordinates of the points
+**
+** Out:      int    order     = insertion order
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+typedef struct
+{
+	unsigned long key;
+	int           point;
+} tSortKey;
+
+static int CompareSortKey(const void *a, const void *b)
+{
+	unsigned long keyA = ((const tSortKey*)a)->key;
+	unsigned long keyB = ((const tSortKey*)b)->key;
+
+	return (keyA < keyB ? -1 : (keyA > keyB ? 1 : 0));
+}
+
+int SortPoints(int numPoints, double *x, double *y, int *order)
+{
+	int      ret;
+	int      i;
+
+	double   xMin, xMax, yMin, yMax;
+	double   xScale, yScale;
+
+	tSortKey *sortKey = NULL;
+
+	ret = 0;
+
+	sortKey = (tSortKey*)malloc(numPoints*sizeof(tSortKey));
+
+	if (sortKey == NULL)
+	{
+		fprintf(stderr, "ERROR in function SortPoints: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else
+	{
+		xMin = xMax = x[0];
+		yMin = yMax = y[0];
+		for(i=1; i<numPoints; i++)
+		{
+			xMin = (x[i] < xMin ? x[i] : xMin);
+			xMax = (x[i] > xMax ? x[i] : xMax);
+			yMin = (y[i] < yMin ? y[i] : yMin);
+			yMax = (y[i] > yMax ? y[i] : yMax);
+		}
+
+		xScale = (xMax - xMin > SMALL ? 65535/(xMax - xMin) : 0);
+		yScale = (yMax - yMin > SMALL ? 65535/(yMax - yMin) : 0);
+
+		#pragma omp parallel for
+		for(i=0; i<numPoints; i++)
+		{
+			unsigned int  hash;
+			unsigned long round;
+
+			/*
+			** Round of the point: each round holds about half of the points
+			** that are left, the last round the largest half.
+			*/
+			hash  = (unsigned int)i*2654435761u;
+			hash ^= hash >> 16;
+			round = 0;
+			while ((hash & 1) && round < 31)
+			{
+				round++;
+				hash >>= 1;
+			}
+
+			sortKey[i].point = i;
+			sortKey[i].key   = ((31 - round) << 32) |
+			                   HilbertKey(65536, (unsigned int)((x[i] - xMin)*xScale), (unsigned int)((y[i] - yMin)*yScale));
+		}
+
+		qsort(sortKey, numPoints, sizeof(tSortKey), CompareSortKey);
+
+		for(i=0; i<numPoints; i++)
+			order[i] = sortKey[i].point;
+
+		free(sortKey);
+	}
+
+	return ret;
+}
+
+/*
+** Function HilbertKey
+** Returns the position of cell (x,y) along a Hilbert curve filling
+** an n x n grid; n must be a power of two.
+**
+** Author:   J.L. Klaufus
+*/
+
+unsigned long HilbertKey(unsigned int n, unsigned int x, unsigned int y)
+{
+	unsigned int  s, rx, ry, dummy;
+	unsigned long key;
+
+	key = 0;
+	for(s=n/2; s>0; s/=2)
+	{
+		rx   = (x & s) > 0;
+		ry   = (y & s) > 0;
+		key += (unsigned long)s*s*((3*rx) ^ ry);
+
+		/* Rotate the quadrant */
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n-1 - x;
+				y = n-1 - y;
+			}
+
+			dummy = x;
+			x     = y;
+			y     = dummy;
+		}
+	}
+
+	return key;
+}
+
+/*
+** Function Orient
+** Returns twice the signed area of triangle (a,b,c); positive when
+** counter-clockwise.
+**
+** Author:   J.L. Klaufus
+*/
+
+double Orient(tDelaunay *Mesh, int a, int b, int c)
+{
+	return (Mesh->x[b] - Mesh->x[a])*(Mesh->y[c] - Mesh->y[a]) -
+	       (Mesh->y[b] - Mesh->y[a])*(Mesh->x[c] - Mesh->x[a]);
+}
+
+/*
+** Function InCircle
+** Returns a positive value when point p lies inside the circumcircle
+** of triangle t, negative when outside. The value is scaled by the
+** magnitude of its terms, so it can be compared with a tolerance.
+**
+** Author:   J.L. Klaufus
+*/
+
+double InCircle(tDelaunay *Mesh, int t, int p)
+{
+	double adx, ady, bdx, bdy, cdx, cdy;
+	double det, perm;
+
+	adx = Mesh->x[Mesh->tri[t].v[0]] - Mesh->x[p];
+	ady = Mesh->y[Mesh->tri[t].v[0]] - Mesh->y[p];
+	bdx = Mesh->x[Mesh->tri[t].v[1]] - Mesh->x[p];
+	bdy = Mesh->y[Mesh->tri[t].v[1]] - Mesh->y[p];
+	cdx = Mesh->x[Mesh->tri[t].v[2]] - Mesh->x[p];
+	cdy = Mesh->y[Mesh->tri[t].v[2]] - Mesh->y[p];
+
+	det  = (adx*adx + ady*ady)*(bdx*cdy - cdx*bdy) +
+	       (bdx*bdx + bdy*bdy)*(cdx*ady - adx*cdy) +
+	       (cdx*cdx + cdy*cdy)*(adx*bdy - bdx*ady);
+
+	perm = (adx*adx + ady*ady)*(fabs(bdx*cdy) + fabs(cdx*bdy)) +
+	       (bdx*bdx + bdy*bdy)*(fabs(cdx*ady) + fabs(adx*cdy)) +
+	       (cdx*cdx + cdy*cdy)*(fabs(adx*bdy) + fabs(bdx*ady));
+
+	return (perm > 0 ? det/perm : 0);
+}
+
+/*
+** Function LocateTriangle
+** Finds the triangle containing point p by walking from the last
+** created triangle towards p. The edge to cross is tried starting at
+** a varying position, so the walk cannot cycle.
+**
+** Return:   triangle number, -1 when p lies outside the triangulation
+**
+** Author:   J.L. Klaufus
+*/
+
+int LocateTriangle(tDelaunay *Mesh, double xp, double yp)
+{
+	int    t, k, kk, a, b;
+	int    steps;
+	int    found;
+
+	double orient;
+
+	t     = Mesh->lastTriangle;
+	steps = 0;
+	found = 0;
+
+	while (t != -1 && found == 0)
+	{
+		found = 1;
+		for(kk=0; kk<3 && found; kk++)
+		{
+			k = (kk + steps) % 3;
+			a = Mesh->tri[t].v[(k+1)%3];
+			b = Mesh->tri[t].v[(k+2)%3];
+
+			orient = (Mesh->x[b] - Mesh->x[a])*(yp - Mesh->y[a]) -
+			         (Mesh->y[b] - Mesh->y[a])*(xp - Mesh->x[a]);
+
+			if (orient < 0)
+			{
+				t     = Mesh->tri[t].n[k];
+				found = 0;
+			}
+		}
+
+		steps++;
+
+		if (steps > Mesh->numTriangles)
+		{
+			/* Should not happen; fall back on a search over all triangles */
+			for(t=0; t<Mesh->numTriangles && found == 0; t++)
+			{
+				found = (Mesh->tri[t].dead == 0);
+				for(k=0; k<3 && found; k++)
+				{
+					a = Mesh->tri[t].v[(k+1)%3];
+					b = Mesh->tri[t].v[(k+2)%3];
+
+					orient = (Mesh->x[b] - Mesh->x[a])*(yp - Mesh->y[a]) -
+					         (Mesh->y[b] - Mesh->y[a])*(xp - Mesh->x[a]);
+
+					found = (orient >= 0);
+				}
+			}
+
+			t = (found ? t-1 : -1);
+			found = 1;
+		}
+	}
+
+	return t;
+}
+
+/*
+** Function InsertPoint
+** Inserts point p: all triangles whose circumcircle contains p form
+** the cavity, which is replaced by a fan of triangles around p.
+**
+** Out:      int    used = p, or the existing point coinciding with p
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int InsertPoint(tDelaunay *Mesh, int p, int *used)
+{
+	int    ret;
+	int    t, c, k, m, q;
+	int    i, nb;
+	int    numCavity, numBoundary, numNew;
+	int    a, b, outer;
+	int    inside, outside;
+
+	tDelaunayTriangle *tri;
+
+	ret   = 0;
+	*used = p;
+
+	t = LocateTriangle(&(*Mesh), Mesh->x[p], Mesh->y[p]);
+
+	if (t == -1)
+	{
+		fprintf(stderr, "ERROR in function InsertPoint: Point %d outside triangulation.\n", p);
+		return -1;
+	}
+
+	/* Coinciding points are inserted only once */
+	for(k=0; k<3; k++)
+	{
+		q = Mesh->tri[t].v[k];
+		if (fabs(Mesh->x[q] - Mesh->x[p]) < Mesh->tolerance &&
+		    fabs(Mesh->y[q] - Mesh->y[p]) < Mesh->tolerance)
+		{
+			*used = q;
+			return 0;
+		}
+	}
+
+	/*
+	** Search the cavity, starting at the containing triangle.
+	** mark = 2*stamp  : triangle is part of the cavity
+	** mark = 2*stamp+1: triangle has been tested and is not
+	*/
+	Mesh->stamp++;
+	inside  = 2*Mesh->stamp;
+	outside = 2*Mesh->stamp + 1;
+
+	Mesh->tri[t].mark = inside;
+	Mesh->cavity[0]   = t;
+	numCavity         = 1;
+	numBoundary       = 0;
+
+	for(i=0; i<numCavity; i++)
+	{
+		c = Mesh->cavity[i];
+
+		for(k=0; k<3; k++)
+		{
+			nb = Mesh->tri[c].n[k];
+
+			if (nb != -1 && Mesh->tri[nb].mark != inside && Mesh->tri[nb].mark != outside)
+			{
+				if (InCircle(&(*Mesh), nb, p) > 0)
+				{
+					Mesh->tri[nb].mark = inside;
+
+					if (numCavity == Mesh->maxCavity)
+					{
+						Mesh->maxCavity *= 2;
+						Mesh->cavity     = (int*)realloc(Mesh->cavity, Mesh->maxCavity*sizeof(int));
+						if (Mesh->cavity == NULL)
+						{
+							fprintf(stderr, "ERROR in function InsertPoint: Could not allocate memory.\n");
+							return -1;
+						}
+					}
+
+					Mesh->cavity[numCavity++] = nb;
+				}
+				else
+				{
+					Mesh->tri[nb].mark = outside;
+				}
+			}
+
+			if (nb == -1 || Mesh->tri[nb].mark == outside)
+			{
+				/* Boundary edge of the cavity: a, b, outer triangle and its back index */
+				m = -1;
+				if (nb != -1)
+				{
+					for(m=0; m<3 && Mesh->tri[nb].n[m] != c; m++);
+				}
+
+				if (numBoundary == Mesh->maxBoundary)
+				{
+					Mesh->maxBoundary *= 2;
+					Mesh->boundary     = (int*)realloc(Mesh->boundary, 4*Mesh->maxBoundary*sizeof(int));
+					if (Mesh->boundary == NULL)
+					{
+						fprintf(stderr, "ERROR in function InsertPoint: Could not allocate memory.\n");
+						return -1;
+					}
+				}
+
+				Mesh->boundary[4*numBoundary]   = Mesh->tri[c].v[(k+1)%3];
+				Mesh->boundary[4*numBoundary+1] = Mesh->tri[c].v[(k+2)%3];
+				Mesh->boundary[4*numBoundary+2] = nb;
+				Mesh->boundary[4*numBoundary+3] = m;
+				numBoundary++;
+			}
+		}
+	}
+
+	/* The fan consists of numCavity+2 triangles; reuse the cavity */
+	numNew = numBoundary;
+	if (Mesh->numTriangles + numNew - numCavity > Mesh->maxTriangles)
+	{
+		Mesh->maxTriangles = 2*Mesh->maxTriangles + numNew;
+		Mesh->tri          = (tDelaunayTriangle*)realloc(Mesh->tri, Mesh->maxTriangles*sizeof(tDelaunayTriangle));
+		if (Mesh->tri == NULL)
+		{
+			fprintf(stderr, "ERROR in function InsertPoint: Could not allocate memory.\n");
+			return -1;
+		}
+	}
+
+	tri = Mesh->tri;
+
+	for(i=0; i<numNew; i++)
+	{
+		t = (i < numCavity ? Mesh->cavity[i] : Mesh->numTriangles++);
+
+		a     = Mesh->boundary[4*i];
+		b     = Mesh->boundary[4*i+1];
+		outer = Mesh->boundary[4*i+2];
+		m     = Mesh->boundary[4*i+3];
+
+		tri[t].v[0] = a;
+		tri[t].v[1] = b;
+		tri[t].v[2] = p;
+		tri[t].n[2] = outer;
+		tri[t].c[0] = 0;
+		tri[t].c[1] = 0;
+		tri[t].c[2] = 0;
+		tri[t].mark = 0;
+		tri[t].dead = 0;
+
+		if (outer != -1)
+			tri[outer].n[m] = t;
+
+		Mesh->firstOf[a]        = t;
+		Mesh->vertexTriangle[a] = t;
+		Mesh->boundary[4*i]     = t;
+	}
+
+	/* Connect the triangles of the fan to each other */
+	for(i=0; i<numNew; i++)
+	{
+		t = Mesh->boundary[4*i];
+		b = tri[t].v[1];
+
+		tri[t].n[0] = Mesh->firstOf[b];
+		tri[Mesh->firstOf[b]].n[1] = t;
+	}
+
+	Mesh->vertexTriangle[p] = t;
+	Mesh->lastTriangle      = t;
+
+	return ret;
+}
+
+/*
+** Function FindEdge
+** Searches the triangles around vertex a for edge (a,b).
+**
+** Out:      int    t, k = triangle and index of the vertex opposite the edge
+**
+** Return:   1 when found, 0 when not
+**
+** Author:   J.L. Klaufus
+*/
+
+int FindEdge(tDelaunay *Mesh, int a, int b, int *t, int *k)
+{
+	int    start, cur, i;
+	int    dir;
+
+	start = Mesh->vertexTriangle[a];
+
+	/* Rotate in both directions around a, until back or at a boundary */
+	for(dir=0; dir<2; dir++)
+	{
+		cur = start;
+		do
+		{
+			for(i=0; i<3 && Mesh->tri[cur].v[i] != a; i++);
+
+			if (Mesh->tri[cur].v[(i+1)%3] == b)
+			{
+				*t = cur;
+				*k = (i+2)%3;
+				return 1;
+			}
+
+			if (Mesh->tri[cur].v[(i+2)%3] == b)
+			{
+				*t = cur;
+				*k = (i+1)%3;
+				return 1;
+			}
+
+			cur = Mesh->tri[cur].n[(dir == 0 ? (i+2)%3 : (i+1)%3)];
+		} while (cur != -1 && cur != start);
+
+		if (cur == start)
+			break;
+	}
+
+	return 0;
+}
+
+/*
+** Function FlipEdge
+** Flips the diagonal of the quadrangle formed by triangle t and its
+** neighbour opposite vertex k. The quadrangle must be convex.
+**
+** Return:   the neighbour, which now shares the new diagonal with t
+**
+** Author:   J.L. Klaufus
+*/
+
+int FlipEdge(tDelaunay *Mesh, int t, int k)
+{
+	int    u, m;
+	int    a, b, c, d;
+	int    nAB, nCA, nBD, nDC;
+	int    cAB, cCA, cBD, cDC;
+	int    i;
+
+	tDelaunayTriangle *tri = Mesh->tri;
+
+	u = tri[t].n[k];
+	for(m=0; m<3 && tri[u].n[m] != t; m++);
+
+	/* t = (a,b,c), u = (d,c,b) */
+	a = tri[t].v[k];
+	b = tri[t].v[(k+1)%3];
+	c = tri[t].v[(k+2)%3];
+	d = tri[u].v[m];
+
+	nAB = tri[t].n[(k+2)%3];  cAB = tri[t].c[(k+2)%3];
+	nCA = tri[t].n[(k+1)%3];  cCA = tri[t].c[(k+1)%3];
+	nBD = tri[u].n[(m+1)%3];  cBD = tri[u].c[(m+1)%3];
+	nDC = tri[u].n[(m+2)%3];  cDC = tri[u].c[(m+2)%3];
+
+	/* New triangles t = (a,b,d) and u = (a,d,c) */
+	tri[t].v[0] = a;   tri[t].v[1] = b;   tri[t].v[2] = d;
+	tri[t].n[0] = nBD; tri[t].n[1] = u;   tri[t].n[2] = nAB;
+	tri[t].c[0] = cBD; tri[t].c[1] = 0;   tri[t].c[2] = cAB;
+
+	tri[u].v[0] = a;   tri[u].v[1] = d;   tri[u].v[2] = c;
+	tri[u].n[0] = nDC; tri[u].n[1] = nCA; tri[u].n[2] = t;
+	tri[u].c[0] = cDC; tri[u].c[1] = cCA; tri[u].c[2] = 0;
+
+	/* Update the outer neighbours that changed owner */
+	if (nBD != -1)
+	{
+		for(i=0; i<3; i++)
+			if (tri[nBD].n[i] == u)
+				tri[nBD].n[i] = t;
+	}
+
+	if (nCA != -1)
+	{
+		for(i=0; i<3; i++)
+			if (tri[nCA].n[i] == t)
+				tri[nCA].n[i] = u;
+	}
+
+	Mesh->vertexTriangle[a] = t;
+	Mesh->vertexTriangle[b] = t;
+	Mesh->vertexTriangle[c] = u;
+	Mesh->vertexTriangle[d] = u;
+
+	return u;
+}
+
+/*
+** Function RecoverSegment
+** Makes segment (a,b) an edge of the triangulation by flipping the
+** edges crossing it, and marks it as a constraint.
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int RecoverSegment(tDelaunay *Mesh, int a, int b, int depth)
+{
+	int    ret;
+	int    t, k, u, m;
+	int    i, start, cur;
+	int    l, r, d;
+	int    head, tail, numQueue, maxQueue, numLeft, iter;
+	int    p, q;
+
+	double orient;
+
+	int    *queue = NULL;
+
+	tDelaunayTriangle *tri;
+
+	ret = 0;
+
+	if (depth > 16)
+	{
+		fprintf(stderr, "ERROR in function RecoverSegment: Could not recover segment %d-%d.\n", a, b);
+		return -1;
+	}
+
+	if (FindEdge(&(*Mesh), a, b, &t, &k) == 0)
+	{
+		/*
+		** Find the triangle around a through which the segment leaves a;
+		** l and r are then the vertices left and right of the segment.
+		*/
+		tri   = Mesh->tri;
+		start = Mesh->vertexTriangle[a];
+		cur   = start;
+		t     = -1;
+		do
+		{
+			for(i=0; i<3 && tri[cur].v[i] != a; i++);
+
+			l = tri[cur].v[(i+2)%3];
+			r = tri[cur].v[(i+1)%3];
+
+			if (Orient(&(*Mesh), a, b, r) <= 0 && Orient(&(*Mesh), a, b, l) >= 0)
+			{
+				/* A vertex on the segment splits it into two segments */
+				if (Orient(&(*Mesh), a, b, r) == 0 && Orient(&(*Mesh), a, r, l) > 0 &&
+				    (Mesh->x[r]-Mesh->x[a])*(Mesh->x[b]-Mesh->x[a]) + (Mesh->y[r]-Mesh->y[a])*(Mesh->y[b]-Mesh->y[a]) > 0)
+				{
+					ret = RecoverSegment(&(*Mesh), a, r, depth+1);
+					if (ret != -1)
+						ret = RecoverSegment(&(*Mesh), r, b, depth+1);
+					return ret;
+				}
+
+				if (Orient(&(*Mesh), a, b, r) < 0 && Orient(&(*Mesh), a, b, l) > 0)
+				{
+					t = cur;
+					k = i;
+				}
+			}
+
+			cur = tri[cur].n[(i+2)%3];
+		} while (t == -1 && cur != -1 && cur != start);
+
+		if (t == -1)
+		{
+			fprintf(stderr, "ERROR in function RecoverSegment: Segment %d-%d not found.\n", a, b);
+			return -1;
+		}
+
+		/* Walk along the segment, collecting the crossed edges (l,r) */
+		maxQueue = 64;
+		queue    = (int*)malloc(2*maxQueue*sizeof(int));
+		numQueue = 0;
+
+		while (ret != -1)
+		{
+			l = tri[t].v[(k+2)%3];
+			r = tri[t].v[(k+1)%3];
+
+			if (numQueue == maxQueue)
+			{
+				maxQueue *= 2;
+				queue     = (int*)realloc(queue, 2*maxQueue*sizeof(int));
+			}
+
+			if (queue == NULL)
+			{
+				fprintf(stderr, "ERROR in function RecoverSegment: Could not allocate memory.\n");
+				return -1;
+			}
+
+			queue[2*numQueue]   = l;
+			queue[2*numQueue+1] = r;
+			numQueue++;
+
+			u = tri[t].n[k];
+			for(m=0; m<3 && tri[u].n[m] != t; m++);
+			d = tri[u].v[m];
+
+			if (d == b)
+				break;
+
+			orient = Orient(&(*Mesh), a, b, d);
+
+			if (orient == 0)
+			{
+				/* Vertex d lies on the segment */
+				free(queue);
+				ret = RecoverSegment(&(*Mesh), a, d, depth+1);
+				if (ret != -1)
+					ret = RecoverSegment(&(*Mesh), d, b, depth+1);
+				return ret;
+			}
+
+			/* Continue through the edge of u that is crossed next */
+			t = u;
+			if (orient > 0)
+				for(k=0; k<3 && tri[u].v[k] != l; k++);   /* crossing (d,r) */
+			else
+				for(k=0; k<3 && tri[u].v[k] != r; k++);   /* crossing (l,d) */
+		}
+
+		/* Flip the crossing edges until none is left */
+		head    = 0;
+		tail    = numQueue % maxQueue;
+		numLeft = numQueue;
+		iter    = 0;
+		while (numLeft > 0 && ret != -1)
+		{
+			p    = queue[2*head];
+			q    = queue[2*head+1];
+			head = (head+1) % maxQueue;
+			numLeft--;
+
+			if (FindEdge(&(*Mesh), p, q, &t, &k) == 0)
+				continue;
+
+			tri = Mesh->tri;
+			u   = tri[t].n[k];
+			for(m=0; m<3 && tri[u].n[m] != t; m++);
+			l = tri[t].v[k];
+			d = tri[u].v[m];
+
+			if (Orient(&(*Mesh), l, d, p)*Orient(&(*Mesh), l, d, q) < 0)
+			{
+				/* Convex quadrangle: flip */
+				FlipEdge(&(*Mesh), t, k);
+
+				/* New diagonal (l,d) still crossing the segment? */
+				if (l != a && l != b && d != a && d != b &&
+				    Orient(&(*Mesh), a, b, l)*Orient(&(*Mesh), a, b, d) < 0)
+				{
+					queue[2*tail]   = l;
+					queue[2*tail+1] = d;
+					tail = (tail+1) % maxQueue;
+					numLeft++;
+				}
+			}
+			else
+			{
+				/* Not convex yet; try again later */
+				queue[2*tail]   = p;
+				queue[2*tail+1] = q;
+				tail = (tail+1) % maxQueue;
+				numLeft++;
+			}
+
+			if (++iter > 100*maxQueue + 1000)
+			{
+				fprintf(stderr, "ERROR in function RecoverSegment: Could not recover segment %d-%d.\n", a, b);
+				ret = -1;
+			}
+		}
+
+		free(queue);
+
+		if (ret != -1 && FindEdge(&(*Mesh), a, b, &t, &k) == 0)
+		{
+			fprintf(stderr, "ERROR in function RecoverSegment: Could not recover segment %d-%d.\n", a, b);
+			ret = -1;
+		}
+	}
+
+	/* Mark the edge as a constraint on both sides */
+	if (ret != -1)
+	{
+		tri = Mesh->tri;
+		tri[t].c[k] = 1;
+
+		u = tri[t].n[k];
+		if (u != -1)
+		{
+			for(m=0; m<3 && tri[u].n[m] != t; m++);
+			tri[u].c[m] = 1;
+		}
+	}
+
+	return ret;
+}
+
+/*
+** Function LegalizeEdges
+** Flips all edges that are not constraints and violate the Delaunay
+** criterion, until none is left (Lawson).
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int LegalizeEdges(tDelaunay *Mesh)
+{
+	int    ret;
+	int    t, k, u, m;
+	int    a, b, c, d;
+	int    numFlips, pass;
+
+	tDelaunayTriangle *tri;
+
+	ret   = 0;
+	pass  = 0;
+
+	do
+	{
+		numFlips = 0;
+		pass++;
+
+		for(t=0; t<Mesh->numTriangles; t++)
+		{
+			for(k=0; k<3; k++)
+			{
+				tri = Mesh->tri;
+				u   = tri[t].n[k];
+
+				if (u == -1 || tri[t].c[k] || tri[t].dead)
+					continue;
+
+				for(m=0; m<3 && tri[u].n[m] != t; m++);
+
+				a = tri[t].v[k];
+				b = tri[t].v[(k+1)%3];
+				c = tri[t].v[(k+2)%3];
+				d = tri[u].v[m];
+
+				if (InCircle(&(*Mesh), t, d) > SMALLITER &&
+				    Orient(&(*Mesh), a, b, d) > 0 && Orient(&(*Mesh), a, d, c) > 0)
+				{
+					FlipEdge(&(*Mesh), t, k);
+					numFlips++;
+				}
+			}
+		}
+	} while (numFlips > 0 && pass < 100);
+
+	return ret;
+}
+
+/*
+** Function ClassifyTriangles
+** Marks the triangles inside the domain. Starting from the triangles
+** using a super vertex, the triangles are flooded; each constraint
+** crossed toggles between outside and inside.
+**
+** Out:      int    keep = 1 for triangles inside the domain, 0 otherwise
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ClassifyTriangles(tDelaunay *Mesh, int *keep)
+{
+	int    ret;
+	int    t, k, nb;
+	int    level;
+	int    numCurrent, numNext, i;
+
+	int    *depth   = NULL;
+	int    *current = NULL;
+	int    *next    = NULL;
+	int    *dummy;
+
+	tDelaunayTriangle *tri = Mesh->tri;
+
+	ret = 0;
+
+	depth   = (int*)malloc(Mesh->numTriangles*sizeof(int));
+	current = (int*)malloc(Mesh->numTriangles*sizeof(int));
+	next    = (int*)malloc(Mesh->numTriangles*sizeof(int));
+
+	if (depth == NULL || current == NULL || next == NULL)
+	{
+		fprintf(stderr, "ERROR in function ClassifyTriangles: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else
+	{
+		numCurrent = 0;
+		for(t=0; t<Mesh->numTriangles; t++)
+		{
+			depth[t] = -1;
+
+			if (tri[t].v[0] >= Mesh->numPoints || tri[t].v[1] >= Mesh->numPoints || tri[t].v[2] >= Mesh->numPoints)
+			{
+				depth[t] = 0;
+				current[numCurrent++] = t;
+			}
+		}
+
+		level = 0;
+		while (numCurrent > 0)
+		{
+			/* Flood the current level; constraints lead to the next level */
+			numNext = 0;
+			for(i=0; i<numCurrent; i++)
+			{
+				t = current[i];
+				for(k=0; k<3; k++)
+				{
+					nb = tri[t].n[k];
+					if (nb == -1 || depth[nb] != -1)
+						continue;
+
+					if (tri[t].c[k])
+					{
+						/* Level decided later; nb may still be flooded at this level */
+						next[numNext++] = nb;
+					}
+					else
+					{
+						depth[nb] = level;
+						current[numCurrent++] = nb;
+					}
+				}
+			}
+
+			level++;
+			dummy      = current;
+			current    = next;
+			next       = dummy;
+			numCurrent = 0;
+
+			for(i=0; i<numNext; i++)
+			{
+				if (depth[current[i]] == -1)
+				{
+					depth[current[i]] = level;
+					current[numCurrent++] = current[i];
+				}
+			}
+		}
+
+		for(t=0; t<Mesh->numTriangles; t++)
+			keep[t] = (depth[t] % 2 == 1);
+	}
+
+	if (depth)
+		free(depth);
+
+	if (current)
+		free(current);
+
+	if (next)
+		free(next);
+
+	return ret;
+}
+
+/*
+** Function CompactNodes
+** Removes the nodes no element refers to, like the nodes of the cutting
+** line merged by Delaunay, from all nodal arrays. The remaining nodes
+** keep their order; Result->nodeNumber gives the new number of every
+** (j,i), that of its merged node for a removed one.
+**
+** In:       tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int CompactNodes(FILE *log, tResult *Result)
+{
+	int    ret;
+	int    n, e, k, a;
+	int    numNodes, numKept;
+	int    node[4];
+
+	int    *oldToNew = NULL;
+	int    *newToOld = NULL;
+	double *work     = NULL;
+
+	double *array[18];
+
+	ret      = 0;
+	numNodes = Result->numNodes;
+	numKept  = 0;
+
+	oldToNew = (int*)malloc(numNodes*sizeof(int));
+	newToOld = (int*)malloc(numNodes*sizeof(int));
+	work     = (double*)malloc(numNodes*sizeof(double));
+
+	if (oldToNew == NULL || newToOld == NULL || work == NULL)
+	{
+		fprintf(stderr, "ERROR in function CompactNodes: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* The nodes in use, in their order */
+		for(n=0; n<numNodes; n++)
+			oldToNew[n] = -1;
+
+		for(e=0; e<Result->numElements; e++)
+		{
+			CopyNodes(&(*Result), e, node);
+
+			for(k=0; k<NodesOfElement(&(*Result), e); k++)
+				oldToNew[node[k]] = 0;
+		}
+
+		for(n=0; n<numNodes; n++)
+		{
+			if (oldToNew[n] != -1)
+			{
+				oldToNew[n]       = numKept;
+				newToOld[numKept] = n;
+				numKept++;
+			}
+		}
+
+		/* The nodal arrays */
+		array[0]  = Result->x;        array[1]  = Result->y;
+		array[2]  = Result->xKsi;     array[3]  = Result->xEta;
+		array[4]  = Result->yKsi;     array[5]  = Result->yEta;
+		array[6]  = Result->xKsiKsi;  array[7]  = Result->xEtaEta;
+		array[8]  = Result->xKsiEta;  array[9]  = Result->yKsiKsi;
+		array[10] = Result->yEtaEta;  array[11] = Result->yKsiEta;
+		array[12] = Result->ksiX;     array[13] = Result->ksiY;
+		array[14] = Result->etaX;     array[15] = Result->etaY;
+		array[16] = Result->jac;      array[17] = Result->wallDistance;
+
+		for(k=0; k<18; k++)
+			if (array[k] != NULL)
+				PermuteNodalArray(array[k], newToOld, numKept, work);
+
+		for(n=0; n<numKept; n++)
+		{
+			a                       = Result->periodicNode[newToOld[n]];
+			Result->patch[n]        = Result->patch[newToOld[n]];
+			Result->periodicNode[n] = (a == -1 ? -1 : oldToNew[a]);
+		}
+
+		/* The connectivity */
+		for(e=0; e<Result->numElements; e++)
+		{
+			for(k=0; k<NodesOfElement(&(*Result), e); k++)
+			{
+				if (TypeOfElement(&(*Result), e) == etTriangle)
+					Result->element[e].triangle.node[k] = oldToNew[Result->element[e].triangle.node[k]];
+				else
+					Result->element[e].quadrangle.node[k] = oldToNew[Result->element[e].quadrangle.node[k]];
+			}
+		}
+
+		/* The new number of every (j,i) */
+		for(n=0; n<Result->im*Result->jm; n++)
+			newToOld[n] = oldToNew[(Result->nodeNumber ? Result->nodeNumber[n] : n)];
+
+		if (Result->nodeNumber != NULL)
+			free(Result->nodeNumber);
+
+		Result->nodeNumber = newToOld;
+		newToOld           = NULL;
+		Result->numNodes   = numKept;
+	}
+
+	/* Free allocated memory */
+	if (oldToNew)
+		free(oldToNew);
+
+	if (newToOld)
+		free(newToOld);
+
+	if (work)
+		free(work);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION COMPACTNODES *****\n\n");
+
+		fprintf(log, "nodes                = %d -> %d\n", numNodes, numKept);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
@@ -0,0 +1,53 @@
+/*
+** Header-file for Delaunay
+*/
+
+#ifndef DELAUNAY_H
+#define DELAUNAY_H
+
+typedef struct
+{
+	int    v[3];      /* vertices, counter-clockwise                   */
+	int    n[3];      /* neighbour opposite v[k]; -1 if none           */
+	int    c[3];      /* 1 if the edge opposite v[k] is a constraint   */
+	int    mark;
+	int    dead;
+} tDelaunayTriangle;
+
+typedef struct
+{
+	int               numPoints;      /* excluding the three super vertices */
+	double            *x, *y;
+
+	int               numTriangles;
+	int               maxTriangles;
+	tDelaunayTriangle *tri;
+
+	int               *vertexTriangle; /* a triangle using each vertex */
+	int               *firstOf;        /* work array for InsertPoint   */
+	int               lastTriangle;
+	int               stamp;
+	double            tolerance;
+
+	int               *cavity;
+	int               maxCavity;
+	int               *boundary;
+	int               maxBoundary;
+} tDelaunay;
+
+int    Delaunay(FILE*, tData*, tResult*);
+int    DelaunayTriangulate(FILE*, int, double*, double*, int, int*, int*, int**, int*);
+int    SortPoints(int, double*, double*, int*);
+unsigned long HilbertKey(unsigned int, unsigned int, unsigned int);
+int    LocateTriangle(tDelaunay*, double, double);
+int    InsertPoint(tDelaunay*, int, int*);
+int    RecoverSegment(tDelaunay*, int, int, int);
+int    FindEdge(tDelaunay*, int, int, int*, int*);
+int    FlipEdge(tDelaunay*, int, int);
+int    LegalizeEdges(tDelaunay*);
+int    ClassifyTriangles(tDelaunay*, int*);
+double Orient(tDelaunay*, int, int, int);
+double InCircle(tDelaunay*, int, int);
+int    CompactNodes(FILE*, tResult*);
+
+#endif
@@ -13,9 +13,11 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "gridgen.h"
+#include "spline.h"
 #include "distribute.h"
 
 int Distribute1(FILE *log, int numNodes, double refLength, double *xArray)
@@ -233,3 +235,134 @@ int Distribute4(FILE *log, int numNodes, double refLength, double *xArray)
 	return ret;
 }
 
+
+int Distribute5(FILE *log, int numNodes, tSpline *Spline, double minSpacing, double maxSpacing, double *xArray)
+{
+	/*
+	** Equidistributes the square root of the curvature of Spline over its
+	** arc length, which equidistributes the distance between the spline and
+	** its chords. The spacing is kept between minSpacing and maxSpacing, so
+	** flat parts stay sparse without becoming empty.
+	** Good for the aerofoil.
+	*/
+
+	int    ret;
+	int    i, k;
+	int    numSamples;
+	int    iter;
+
+	double refLength;
+	double *s=NULL;
+	double *weight=NULL;
+	double *count=NULL;
+	double spacing;
+	double scale, scaleLow, scaleHigh;
+	double target;
+	double f;
+
+	/*printf("Distributing 5...\n");*/
+
+	ret = 0;
+
+	refLength  = Spline->arcLength[Spline->numKnots-1];
+	numSamples = 50*(numNodes - 1) + 1;
+
+	/* Allocate memory */
+	s      = (double *)malloc(numSamples*sizeof(double));
+	weight = (double *)malloc(numSamples*sizeof(double));
+	count  = (double *)malloc(numSamples*sizeof(double));
+
+	if ((s == NULL) || (weight == NULL) || (count == NULL))
+	{
+		fprintf(stderr, "ERROR in function Distribute5: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* Square root of the curvature at uniformly spaced arc lengths */
+		for(k=0; k<numSamples; k++)
+			s[k] = k*refLength/(numSamples - 1);
+
+		SplineParameters(Spline, numSamples, s, weight);
+
+		for(k=0; k<numSamples; k++)
+			weight[k] = sqrt(fabs(SplineCurvature(Spline, weight[k])));
+
+		/*
+		** The spacing is scale/weight within the limits; find the scale
+		** for which numNodes-1 intervals fill the arc length. The count of
+		** intervals decreases with the scale.
+		*/
+		scaleLow  = 0;
+		scaleHigh = 0;
+		for(k=0; k<numSamples; k++)
+			if (weight[k]*maxSpacing > scaleHigh)
+				scaleHigh = weight[k]*maxSpacing;
+
+		for(iter=0; iter<100; iter++)
+		{
+			scale = (scaleLow + scaleHigh)/2;
+
+			count[0] = 0;
+			for(k=1; k<numSamples; k++)
+			{
+				f = (weight[k-1] + weight[k])/2;
+
+				spacing = maxSpacing;
+				if (f*maxSpacing > scale)
+					spacing = scale/f;
+				if (spacing < minSpacing)
+					spacing = minSpacing;
+
+				count[k] = count[k-1] + (s[k] - s[k-1])/spacing;
+			}
+
+			if (count[numSamples-1] > numNodes - 1)
+				scaleLow  = scale;
+			else
+				scaleHigh = scale;
+		}
+
+		/* Place the nodes where the count passes the integers */
+		xArray[0] = 0;
+		k = 1;
+		for(i=1; i<numNodes-1; i++)
+		{
+			target = i*count[numSamples-1]/(numNodes - 1);
+
+			while ((k < numSamples-1) && (count[k] < target))
+				k++;
+
+			f = (target - count[k-1])/(count[k] - count[k-1]);
+			xArray[i] = s[k-1] + f*(s[k] - s[k-1]);
+		}
+		xArray[numNodes-1] = refLength;
+	}
+
+	/* Free memory */
+	if (s)
+		free(s);
+	if (weight)
+		free(weight);
+	if (count)
+		free(count);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION DISTRIBUTE5 *****\n\n");
+
+		if (ret != -1)
+		{
+			for(i=0; i<numNodes; i++)
+			{
+				fprintf(log, "x = %f\n", xArray[i]);
+			}
+		}
+		
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
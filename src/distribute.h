@@ -9,5 +9,6 @@ int Distribute1(FILE*, int, double, double*);
 int Distribute2(FILE*, int, double, double*);
 int Distribute3(FILE*, int, double, double*);
 int Distribute4(FILE*, int, double, double*);
+int Distribute5(FILE*, int, tSpline*, double, double, double*);
 
 #endif
@@ -0,0 +1,361 @@
+/*
+** Function FlipEdges
+** Improves a triangulation by flipping the diagonal of every pair of
+** triangles that violates the Delaunay criterion (Lawson). The edges
+** are taken from the half-edge structure; each pass first tests all
+** edges, then flips a set of edges without common triangles or
+** neighbours concurrently. In a mixed grid only edges between two
+** triangles are flipped; quadrangles are left as they are.
+**
+** In:       tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "flip.h"
+
+int FlipEdges(FILE *log, tResult *Result)
+{
+	int    ret;
+	int    h, t, k, npe, pass;
+	int    numEdges, numCandidates, numFlips, totalFlips;
+	int    element[8];
+
+	int    *candidate    = NULL;
+	int    *locked       = NULL;
+
+	double minAngleBefore, minAngleAfter;
+
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
+	printf("Flipping edges...\n");
+
+	ret        = 0;
+	pass       = 0;
+	totalFlips = 0;
+	numEdges   = 0;
+
+	if ((Result->elementType != etTriangle && Result->elementType != etMixed) || Result->structuredElements)
+	{
+		fprintf(stderr, "ERROR in function FlipEdges: Only triangles can be flipped.\n");
+		return -1;
+	}
+
+	/* Allocate memory */
+	npe         = Result->nodesPerElement;
+	candidate   = (int*)malloc(npe*Result->numElements*sizeof(int));
+	locked      = (int*)malloc(Result->numElements*sizeof(int));
+
+	if (candidate == NULL || locked == NULL)
+	{
+		fprintf(stderr, "ERROR in function FlipEdges: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+		ret = BuildHalfEdges(&(*log), &(*Result), &HalfEdge);
+
+	if (ret != -1)
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] < h)
+				numEdges++;
+
+	minAngleBefore = MinimumAngleOfGrid(&(*Result));
+
+	do
+	{
+		pass++;
+		numFlips      = 0;
+		numCandidates = 0;
+
+		if (ret == -1)
+			break;
+
+		/* Test all interior edges concurrently, once per pair of half-edges */
+		#pragma omp parallel for
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			candidate[h] = (HalfEdge.twin[h] > h ? IllegalEdge(&(*Result), &HalfEdge, h) : 0);
+
+		/*
+		** Select edges whose two triangles and their neighbours are not
+		** used by another flip; a flip rewrites the twins of its neighbours.
+		*/
+		for(t=0; t<Result->numElements; t++)
+			locked[t] = 0;
+
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+		{
+			if (candidate[h] == 0)
+				continue;
+
+			element[0] = HalfEdgeElement(&HalfEdge, h);
+			element[1] = HalfEdgeElement(&HalfEdge, HalfEdge.twin[h]);
+
+			for(k=0; k<3; k++)
+			{
+				element[2+k] = (HalfEdge.twin[npe*element[0]+k] != -1 ? HalfEdgeElement(&HalfEdge, HalfEdge.twin[npe*element[0]+k]) : element[0]);
+				element[5+k] = (HalfEdge.twin[npe*element[1]+k] != -1 ? HalfEdgeElement(&HalfEdge, HalfEdge.twin[npe*element[1]+k]) : element[1]);
+			}
+
+			for(k=0; k<8 && locked[element[k]] == 0; k++);
+
+			if (k == 8)
+			{
+				for(k=0; k<8; k++)
+					locked[element[k]] = 1;
+
+				candidate[numCandidates++] = h;
+			}
+		}
+
+		/* Flip them concurrently */
+		#pragma omp parallel for
+		for(h=0; h<numCandidates; h++)
+			FlipTriangleEdge(&(*Result), &HalfEdge, candidate[h]);
+
+		numFlips    = numCandidates;
+		totalFlips += numFlips;
+	} while (numFlips > 0 && pass < 1000);
+
+	minAngleAfter = MinimumAngleOfGrid(&(*Result));
+
+	printf("Number of flips      = %d (%d passes)\n", totalFlips, pass);
+	printf("Minimum angle        = %f -> %f\n", minAngleBefore, minAngleAfter);
+
+	/* Free allocated memory */
+	FreeHalfEdges(&HalfEdge);
+
+	if (candidate)
+		free(candidate);
+
+	if (locked)
+		free(locked);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION FLIPEDGES *****\n\n");
+
+		fprintf(log, "number of edges      = %d\n", numEdges);
+		fprintf(log, "number of passes     = %d\n", pass);
+		fprintf(log, "number of flips      = %d\n", totalFlips);
+		fprintf(log, "minimum angle before = %f\n", minAngleBefore);
+		fprintf(log, "minimum angle after  = %f\n", minAngleAfter);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function IllegalEdge
+** Tests whether the interior edge of half-edge h violates the Delaunay
+** criterion: the node opposite in one triangle lies inside the
+** circumcircle of the other, and flipping the edge leaves two valid
+** triangles.
+**
+** Return:   1 when the edge should be flipped, 0 otherwise
+**
+** Author:   J.L. Klaufus
+*/
+
+int IllegalEdge(tResult *Result, tHalfEdge *HalfEdge, int h)
+{
+	int    a, b, c, d;
+
+	double orientT, orientNew1, orientNew2;
+	double adx, ady, bdx, bdy, cdx, cdy;
+	double det, perm;
+
+	double *x = Result->x;
+	double *y = Result->y;
+
+	if (HalfEdge->twin[h] == -1)
+		return 0;
+
+	/* Both elements must be triangles */
+	if (TypeOfElement(&(*Result), HalfEdgeElement(&(*HalfEdge), h)) != etTriangle ||
+	    TypeOfElement(&(*Result), HalfEdgeElement(&(*HalfEdge), HalfEdge->twin[h])) != etTriangle)
+		return 0;
+
+	/* Triangle (a,b,c) with h from b to c; d opposite in the twin */
+	a = HalfEdge->origin[HalfEdgePrev(&(*HalfEdge), h)];
+	b = HalfEdge->origin[h];
+	c = HalfEdgeDest(&(*HalfEdge), h);
+	d = HalfEdge->origin[HalfEdgePrev(&(*HalfEdge), HalfEdge->twin[h])];
+
+	/* Orientation of (a,b,c); the new triangles (a,b,d) and (a,d,c) must match */
+	orientT    = (x[b]-x[a])*(y[c]-y[a]) - (y[b]-y[a])*(x[c]-x[a]);
+	orientNew1 = (x[b]-x[a])*(y[d]-y[a]) - (y[b]-y[a])*(x[d]-x[a]);
+	orientNew2 = (x[d]-x[a])*(y[c]-y[a]) - (y[d]-y[a])*(x[c]-x[a]);
+
+	if (orientNew1*orientT <= 0 || orientNew2*orientT <= 0)
+		return 0;
+
+	/* In-circle test of d against (a,b,c), scaled by the magnitude of its terms */
+	adx = x[a] - x[d];  ady = y[a] - y[d];
+	bdx = x[b] - x[d];  bdy = y[b] - y[d];
+	cdx = x[c] - x[d];  cdy = y[c] - y[d];
+
+	det  = (adx*adx + ady*ady)*(bdx*cdy - cdx*bdy) +
+	       (bdx*bdx + bdy*bdy)*(cdx*ady - adx*cdy) +
+	       (cdx*cdx + cdy*cdy)*(adx*bdy - bdx*ady);
+
+	perm = (adx*adx + ady*ady)*(fabs(bdx*cdy) + fabs(cdx*bdy)) +
+	       (bdx*bdx + bdy*bdy)*(fabs(cdx*ady) + fabs(adx*cdy)) +
+	       (cdx*cdx + cdy*cdy)*(fabs(adx*bdy) + fabs(bdx*ady));
+
+	if (orientT < 0)
+		det = -det;
+
+	return (perm > 0 && det/perm > SMALLITER);
+}
+
+/*
+** Function FlipTriangleEdge
+** Flips the edge of half-edge h: triangles t = (a,b,c), with h from b
+** to c, and u = (c,b,d) become t = (a,b,d) and u = (a,d,c). The origins
+** and twins of t and u and the twins of their neighbours are updated;
+** the node rings and boundary loops are not. Flips that share no
+** triangles or neighbours can be done concurrently.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FlipTriangleEdge(tResult *Result, tHalfEdge *HalfEdge, int h)
+{
+	int    t, u, g, tt, uu;
+	int    a, b, c, d;
+	int    twinAB, twinCA, twinBD, twinDC;
+
+	g = HalfEdge->twin[h];
+	t = HalfEdgeElement(&(*HalfEdge), h);
+	u = HalfEdgeElement(&(*HalfEdge), g);
+
+	/* First half-edges of t and u */
+	tt = t*HalfEdge->nodesPerElement;
+	uu = u*HalfEdge->nodesPerElement;
+
+	a = HalfEdge->origin[HalfEdgePrev(&(*HalfEdge), h)];
+	b = HalfEdge->origin[h];
+	c = HalfEdgeDest(&(*HalfEdge), h);
+	d = HalfEdge->origin[HalfEdgePrev(&(*HalfEdge), g)];
+
+	/* Outer half-edges of t and u */
+	twinAB = HalfEdge->twin[HalfEdgePrev(&(*HalfEdge), h)];
+	twinCA = HalfEdge->twin[HalfEdgeNext(&(*HalfEdge), h)];
+	twinBD = HalfEdge->twin[HalfEdgeNext(&(*HalfEdge), g)];
+	twinDC = HalfEdge->twin[HalfEdgePrev(&(*HalfEdge), g)];
+
+	/* New triangles t = (a,b,d) and u = (a,d,c) */
+	Result->element[t].triangle.node[0] = a;
+	Result->element[t].triangle.node[1] = b;
+	Result->element[t].triangle.node[2] = d;
+
+	Result->element[u].triangle.node[0] = a;
+	Result->element[u].triangle.node[1] = d;
+	Result->element[u].triangle.node[2] = c;
+
+	HalfEdge->origin[tt]   = a;  HalfEdge->twin[tt]   = twinAB;
+	HalfEdge->origin[tt+1] = b;  HalfEdge->twin[tt+1] = twinBD;
+	HalfEdge->origin[tt+2] = d;  HalfEdge->twin[tt+2] = uu;
+
+	HalfEdge->origin[uu]   = a;  HalfEdge->twin[uu]   = tt+2;
+	HalfEdge->origin[uu+1] = d;  HalfEdge->twin[uu+1] = twinDC;
+	HalfEdge->origin[uu+2] = c;  HalfEdge->twin[uu+2] = twinCA;
+
+	if (twinAB != -1)
+		HalfEdge->twin[twinAB] = tt;
+
+	if (twinBD != -1)
+		HalfEdge->twin[twinBD] = tt+1;
+
+	if (twinDC != -1)
+		HalfEdge->twin[twinDC] = uu+1;
+
+	if (twinCA != -1)
+		HalfEdge->twin[twinCA] = uu+2;
+
+	return 0;
+}
+
+/*
+** Function MinimumAngleOfGrid
+** Returns the smallest angle (degrees) over all triangles; the
+** quadrangles of a mixed grid are skipped.
+**
+** Author:   J.L. Klaufus
+*/
+
+double MinimumAngleOfGrid(tResult *Result)
+{
+	int    t;
+	double angle, minAngle;
+
+	minAngle = 180;
+
+	#pragma omp parallel for private(angle) reduction(min:minAngle)
+	for(t=0; t<Result->numElements; t++)
+	{
+		if (TypeOfElement(&(*Result), t) != etTriangle)
+			continue;
+
+		angle = TriangleMinimumAngle(&(*Result),
+		                             Result->element[t].triangle.node[0],
+		                             Result->element[t].triangle.node[1],
+		                             Result->element[t].triangle.node[2]);
+
+		minAngle = (angle < minAngle ? angle : minAngle);
+	}
+
+	return minAngle;
+}
+
+/*
+** Function TriangleMinimumAngle
+** Returns the smallest angle (degrees) of triangle (a,b,c).
+**
+** Author:   J.L. Klaufus
+*/
+
+double TriangleMinimumAngle(tResult *Result, int a, int b, int c)
+{
+	double ab, bc, ca;
+	double angleA, angleB, angleC;
+	double cosine;
+
+	ab = (Result->x[b]-Result->x[a])*(Result->x[b]-Result->x[a]) + (Result->y[b]-Result->y[a])*(Result->y[b]-Result->y[a]);
+	bc = (Result->x[c]-Result->x[b])*(Result->x[c]-Result->x[b]) + (Result->y[c]-Result->y[b])*(Result->y[c]-Result->y[b]);
+	ca = (Result->x[a]-Result->x[c])*(Result->x[a]-Result->x[c]) + (Result->y[a]-Result->y[c])*(Result->y[a]-Result->y[c]);
+
+	if (ab < SMALL*SMALL*SMALL || bc < SMALL*SMALL*SMALL || ca < SMALL*SMALL*SMALL)
+		return 0;
+
+	/* Law of cosines */
+	cosine = (ab + ca - bc)/(2*sqrt(ab*ca));
+	angleA = acos(cosine > 1 ? 1 : (cosine < -1 ? -1 : cosine));
+
+	cosine = (ab + bc - ca)/(2*sqrt(ab*bc));
+	angleB = acos(cosine > 1 ? 1 : (cosine < -1 ? -1 : cosine));
+
+	angleC = PI - angleA - angleB;
+
+	angleA = (angleB < angleA ? angleB : angleA);
+	angleA = (angleC < angleA ? angleC : angleA);
+
+	return angleA*180/PI;
+}
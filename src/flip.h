@@ -0,0 +1,14 @@
+/*
+** Header-file for FlipEdges
+*/
+
+#ifndef FLIP_H
+#define FLIP_H
+
+int    FlipEdges(FILE*, tResult*);
+int    IllegalEdge(tResult*, tHalfEdge*, int);
+int    FlipTriangleEdge(tResult*, tHalfEdge*, int);
+double MinimumAngleOfGrid(tResult*);
+double TriangleMinimumAngle(tResult*, int, int, int);
+
+#endif
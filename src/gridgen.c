@@ -6,16 +6,28 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
 #include "gridgen.h"
+#include "halfedge.h"
+#include "adjacency.h"
 #include "data.h"
 #include "geometry.h"
 #include "memory.h"
 #include "structured.h"
 #include "unstructured.h"
 #include "quality.h"
+#include "renumber.h"
+#include "multigrid.h"
+#include "walldistance.h"
+#include "locate.h"
+#include "partition.h"
+#include "quadratic.h"
+#include "stretch.h"
+#include "multiblock.h"
+#include "overset.h"
 
 int main(int argc, char *argv[])
 {
@@ -28,6 +40,9 @@ int main(int argc, char *argv[])
 
 	FILE   *logFile = NULL;
 	char   dataFileName[50];
+	char   probeFileName[50];
+	char   blockFileName[50];
+	char   backgroundFileName[50];
 	char   outputFormat, output[1];
 
 	tData   Data;
@@ -38,7 +53,22 @@ int main(int argc, char *argv[])
 	ret        = 0;
 	debug      = 0;
 	strcpy(dataFileName, "gridgen.in");
+	strcpy(probeFileName, "");
+	strcpy(blockFileName, "");
+	strcpy(backgroundFileName, "");
 	outputFormat = 'B';
+	Data.triangulationType = 'S';
+	Data.interpolationType = 'L';
+	Data.smoothingType     = 'G';
+	Data.relaxationType    = 'P';
+	Data.renumberingType   = 'N';
+	Data.numQuadLayers     = 0;
+	Data.refinementType    = 'N';
+	Data.numLevels         = 0;
+	Data.numPartitions     = 0;
+	Data.elementOrder      = 1;
+	Data.stretchingType    = 'N';
+	Data.numKnots          = 0;
 
 	/* get  commandline arguments */
 	for(i=1; i<argc; i++)
@@ -63,6 +93,132 @@ int main(int argc, char *argv[])
 				/* GNUPLot and VIGIE */
 				outputFormat = 'B';
 		}
+		else if (strcmp(argv[i], "-t") == 0 && i+1 < argc)
+		{
+			/* Define triangulation type */
+			i++;
+			if (argv[i][0] == 'q' || argv[i][0] == 'Q')
+				/* Quality driven diagonals and edge flips */
+				Data.triangulationType = 'Q';
+			else
+				/* Standard diagonals */
+				Data.triangulationType = 'S';
+		}
+		else if (strcmp(argv[i], "-i") == 0 && i+1 < argc)
+		{
+			/* Define interpolation type */
+			i++;
+			if (argv[i][0] == 'h' || argv[i][0] == 'H')
+				/* Hermite, normal to the aerofoil and the cut */
+				Data.interpolationType = 'H';
+			else
+				/* Linear */
+				Data.interpolationType = 'L';
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i+1 < argc)
+		{
+			/* Define smoothing type */
+			i++;
+			if (argv[i][0] == 'c' || argv[i][0] == 'C')
+				/* Chebyshev accelerated Jacobi */
+				Data.smoothingType = 'C';
+			else
+				/* Gauss-Seidel */
+				Data.smoothingType = 'G';
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i+1 < argc)
+		{
+			/* Define relaxation type of the elliptic schemes */
+			i++;
+			if (argv[i][0] == 'l' || argv[i][0] == 'L')
+				/* Zebra line relaxation along eta */
+				Data.relaxationType = 'L';
+			else
+				/* Point SOR */
+				Data.relaxationType = 'P';
+		}
+		else if (strcmp(argv[i], "-r") == 0 && i+1 < argc)
+		{
+			/* Define renumbering type */
+			i++;
+			if (argv[i][0] == 'r' || argv[i][0] == 'R')
+				/* Reverse Cuthill-McKee */
+				Data.renumberingType = 'R';
+			else if (argv[i][0] == 'h' || argv[i][0] == 'H')
+				/* Hilbert curve */
+				Data.renumberingType = 'H';
+			else
+				/* Keep the (j,i) numbering */
+				Data.renumberingType = 'N';
+		}
+		else if (strcmp(argv[i], "-q") == 0 && i+1 < argc)
+		{
+			/* Number of eta layers kept as quadrangles */
+			Data.numQuadLayers = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-a") == 0 && i+1 < argc)
+		{
+			/* Define adaptive refinement type */
+			i++;
+			if (argv[i][0] == 'c' || argv[i][0] == 'C')
+				/* Boundary curvature and size gradation */
+				Data.refinementType = 'C';
+			else if (argv[i][0] == 'f' || argv[i][0] == 'F')
+				/* Idem, and the sizes in gridgen.size */
+				Data.refinementType = 'F';
+			else
+				/* No refinement */
+				Data.refinementType = 'N';
+		}
+		else if (strcmp(argv[i], "-m") == 0 && i+1 < argc)
+		{
+			/* Number of coarse multigrid levels */
+			Data.numLevels = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-n") == 0 && i+1 < argc)
+		{
+			/* Number of partitions */
+			Data.numPartitions = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-e") == 0 && i+1 < argc)
+		{
+			/* Element order: 2 also writes quadratic elements */
+			Data.elementOrder = (atoi(argv[++i]) == 2 ? 2 : 1);
+		}
+		else if (strcmp(argv[i], "-w") == 0 && i+1 < argc)
+		{
+			/* Define stretching type for the spacings in gridgen.spacing */
+			i++;
+			if (argv[i][0] == 'v' || argv[i][0] == 'V' || argv[i][0] == 't' || argv[i][0] == 'T')
+				/* Vinokur, which is the two-sided tanh */
+				Data.stretchingType = 'V';
+			else if (argv[i][0] == 'g' || argv[i][0] == 'G')
+				/* Geometric */
+				Data.stretchingType = 'G';
+			else
+				/* The distributions of the input file */
+				Data.stretchingType = 'N';
+		}
+		else if (strcmp(argv[i], "-k") == 0 && i+1 < argc)
+		{
+			/* Number of knots of a least-squares fit to the aerofoil */
+			Data.numKnots = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i+1 < argc)
+		{
+			/* Interpolate to the points of a probe file */
+			strcpy(probeFileName, argv[++i]);
+		}
+		else if (strcmp(argv[i], "-b") == 0 && i+1 < argc)
+		{
+			/* Build a multiblock grid from a block file */
+			strcpy(blockFileName, argv[++i]);
+		}
+		else if (strcmp(argv[i], "-c") == 0 && i+1 < argc)
+		{
+			/* Overlay the grid on the background grid of a file */
+			strcpy(backgroundFileName, argv[++i]);
+		}
 		else if (strcmp(argv[i], "-f") == 0)
 		{
 			/* Use different datafile */
@@ -71,17 +227,44 @@ int main(int argc, char *argv[])
 		else
 		{
 			printf("\nUnknown commandline option: '%s'\n", argv[i]);
-			printf("Use : gridgen [-l] [-p G|V|B] [-f FILENAME]\n");
+			printf("Use : gridgen [-l] [-p G|V|B] [-t S|Q] [-i L|H] [-s G|C] [-j P|L] [-r N|R|H] [-q N] [-a N|C|F] [-m N] [-n N] [-e 1|2] [-w N|V|G] [-k N] [-o FILENAME] [-b FILENAME] [-c FILENAME] [-f FILENAME]\n");
 			ret = -1;
 		}
 	}
 
-	if (logFile || (debug == 0))
+	if ((logFile || (debug == 0)) && blockFileName[0] != '\0')
+	{
+		/* Set start time */
+		t1 = time(&t1);
+
+		/* All of a multiblock grid follows from its block file */
+		if (ret != -1)
+			ret = Multiblock(logFile, blockFileName);
+
+		/* Set end time */
+		t2 = time(&t2);
+		printf("Calculation time = %d sec.\n", (int) (t2-t1));
+
+		if (logFile)
+		{
+			fclose(logFile);
+
+			if (ret == -1)
+				printf("\nERRORS occurred, please read LOG.\n");
+
+			printf("Log can be found in gridgen.log\n");
+		}
+	}
+	else if (logFile || (debug == 0))
 	{
 		/* Read data from file */
 		if (ret != -1)
 			ret = ReadData(logFile, dataFileName,  &Data);
 
+		/* Read the spacings to stretch to */
+		if (ret != -1 && Data.stretchingType != 'N')
+			ret = ReadSpacingFile(logFile, &Data);
+
 		/* Initialise all arrays */
 		if (ret != -1)
 			ret = Initialise(logFile, &Data, &Result);
@@ -98,7 +281,7 @@ int main(int argc, char *argv[])
 			ret = Structured(logFile, &Data, &Result);
 
 		/* Do the unstructured part */
-		if (ret != -1 && Data.gridType == 'U')
+		if (ret != -1 && (Data.gridType == 'U' || Data.gridType == 'D'))
 			ret = Unstructured(logFile, &Data, &Result);
 
 		/* Do the quality checks */
@@ -109,6 +292,34 @@ int main(int argc, char *argv[])
 		t2 = time(&t2);
 		printf("Calculation time = %d sec.\n", (int) (t2-t1));
 
+		/* Renumber the nodes and elements */
+		if (ret != -1 && Data.renumberingType != 'N')
+			ret = Renumber(logFile, &Data, &Result);
+
+		/* Distance to the aerofoil */
+		if (ret != -1)
+			ret = WallDistance(logFile, &Result);
+
+		/* Interpolate to the probes */
+		if (ret != -1 && probeFileName[0] != '\0')
+			ret = Probe(logFile, probeFileName, &Result);
+
+		/* Assemble the overset grid with the background grid */
+		if (ret != -1 && backgroundFileName[0] != '\0')
+			ret = Overset(logFile, backgroundFileName, &Result);
+
+		/* Write the coarse multigrid levels */
+		if (ret != -1 && Data.numLevels > 0)
+			ret = Multigrid(logFile, &Data, &Result);
+
+		/* Write the partitions */
+		if (ret != -1 && Data.numPartitions > 1)
+			ret = Partition(logFile, &Data, &Result);
+
+		/* Create the quadratic elements */
+		if (ret != -1 && Data.elementOrder == 2)
+			ret = Quadratic(logFile, &Data, &Result);
+
 		/* Write the data to outputfile */
 		if (ret != -1)
 			ret = WriteData(logFile, outputFormat, &Result);
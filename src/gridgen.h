@@ -9,11 +9,35 @@
 #define SMALL 1e-7
 #define SMALLANGLE 5
 #define SMALLITER 1e-6
+#define NUMPOWERITER 20
+#define NUMREFINEPASSES 4
+#define REFINEANGLE 10
+#define REFINEGRADING 1.5
+#define WALLLEAFSIZE 4
+#define NUMNEWTONITER 20
+#define CURVATURESPACING 8
+#define MINDISSIPATION 0.2
+#define NUMMARCHES 8
 
 typedef struct
 {
 	char   gridType;
 	char   distributionType;
+	char   triangulationType;  /* 'S' standard, 'Q' quality (command line) */
+	char   interpolationType;  /* 'L' linear, 'H' Hermite from the eta = 0 line (command line) */
+	char   smoothingType;      /* 'G' Gauss-Seidel, 'C' Chebyshev (command line) */
+	char   relaxationType;     /* elliptic schemes: 'P' point SOR, 'L' zebra lines along eta (command line) */
+	char   renumberingType;    /* 'N' none, 'R' reverse Cuthill-McKee, 'H' Hilbert (command line) */
+	int    numQuadLayers;      /* eta layers kept as quadrangles by Triangulate (command line) */
+	char   refinementType;     /* 'N' none, 'C' curvature, 'F' curvature and gridgen.size (command line) */
+	int    numLevels;          /* coarse multigrid levels written to gridgen.mg (command line) */
+	int    numPartitions;      /* partitions written to gridgen.part.P (command line) */
+	int    elementOrder;       /* 2: also quadratic elements in gridgen.p2 (command line) */
+	char   stretchingType;     /* 'N' none, 'V' Vinokur, 'G' geometric (command line) */
+	double aerofoilSpacing[2]; /* trailing and leading edge; 0: free (gridgen.spacing) */
+	double cutSpacing[2];      /* trailing edge and outflow */
+	double normalSpacing[2];   /* cut and wall, on the outflow boundary */
+	int    numKnots;           /* knots of a least-squares spline fit; 0: through all points (command line) */
 	int    numNodes1;
 	int    numNodes2;
 	int    numNodes3;
@@ -34,26 +58,32 @@ typedef struct
 typedef enum
 {
 	etTriangle,
-	etQuadrangle
+	etQuadrangle,
+	etMixed,
+	etTriangle6,
+	etQuadrangle9
 } tElementType;
 
+typedef enum
+{
+	ptInterior,
+	ptAerofoil,
+	ptCut,
+	ptWall,
+	ptInflow,
+	ptOutflow
+} tPatch;
+
+#define NUMPATCHES 6
+
 typedef struct
 {
 	int    node[3];
-
-	double elementalArea;
-	double aspectRatio;
-	double minimumAngle;
 } tTriangle;
 
 typedef struct
 {
 	int    node[4];
-
-	double elementalArea;
-	double aspectRatio;
-	double skewness;
-	double minimumAngle;
 } tQuadrangle;
 
 typedef union
@@ -62,22 +92,52 @@ typedef union
 	tQuadrangle quadrangle;
 } tElement;
 
+typedef struct
+{
+	int    node[6];            /* corners, then the middles of edges 01, 12, 20 */
+} tTriangle6;
+
+typedef struct
+{
+	int    node[9];            /* corners, the middles of edges 01, 12, 23, 30, then the centre */
+} tQuadrangle9;
+
+typedef union
+{
+	tTriangle6   triangle;
+	tQuadrangle9 quadrangle;
+} tQuadraticElement;
+
+typedef struct
+{
+	int    numKnots;
+	double *u;                 /* parameter of the knots, increasing */
+	double *x, *y;             /* knots */
+	double *xSecond, *ySecond; /* second derivatives at the knots */
+	double *arcLength;         /* arc length from the first knot to each knot */
+} tSpline;
+
 typedef struct
 {
 	int      im, jm;
+	int      numNodes;                 /* im*jm, plus the nodes added by Refine */
 
 	double   *xNode;
 	double   *yNode;
 
+	double   *xNodeMid;                /* on the spline halfway between aerofoil nodes i and i+1 */
+	double   *yNodeMid;
+
+	double   *vNode;                   /* spline parameter of the aerofoil nodes */
+
+	tSpline  spline;                   /* through the control points of the aerofoil */
+
 	double   *x;
 	double   *y;
 
 	double    ksiDelta;
 	double    etaDelta;
 
-	double    *ksi;
-	double    *eta;
-
 	double    *xKsi, *xEta;
 	double    *yKsi, *yEta;
 
@@ -92,7 +152,67 @@ typedef struct
 	int          numElements;
 	int          nodesPerElement;
 	tElementType elementType;
+	int          structuredElements;   /* 1: connectivity follows from (j,i), element == NULL */
 	tElement     *element;
+	tElementType *elementTypes;        /* type of each element if elementType == etMixed, else NULL */
+
+	double       *elementalArea;
+	double       *aspectRatio;
+	double       *skewness;
+	double       *minimumAngle;
+
+	int          *nodeNumber;          /* node number of each (j,i) after Renumber; NULL: Loc() */
+
+	double       *wallDistance;        /* distance of each node to the aerofoil */
+
+	tPatch       *patch;               /* boundary patch of each node; a corner keeps the lower one */
+	int          *periodicNode;        /* node on the other side of the cut; -1 off the cut */
+
+	int               numQuadraticNodes;     /* numNodes, then the mid-edge nodes added by Quadratic */
+	double            *xQuadratic;
+	double            *yQuadratic;
+	int               numQuadraticElements;  /* 0: no quadratic elements */
+	tQuadraticElement *quadraticElement;
+	tElementType      *quadraticTypes;       /* etTriangle6 or etQuadrangle9 */
 } tResult;
 
+#define NUMSIDES 4
+
+typedef struct
+{
+	int      numBlocks;
+	double   omega;                    /* relaxation factor of the elliptic smoothing */
+
+	tResult  *block;                   /* im, jm, x and y of every block */
+
+	/* NUMSIDES per block: j = 0, i = im-1, j = jm-1 and i = 0 */
+	int      *neighbour;               /* block across the side; -1 on a boundary */
+	int      *neighbourSide;           /* side of that block */
+	int      *reversed;                /* 1: both sides run in opposite directions */
+	double   **xSide, **ySide;         /* nodes of the sides while the blocks are built */
+} tMultiblock;
+
+typedef enum
+{
+	otField,
+	otFringe,
+	otHole
+} tOversetType;
+
+#define NUMFRINGELAYERS 2
+
+typedef struct
+{
+	tResult      *background;          /* Cartesian tunnel grid under the body grid */
+
+	tOversetType *bodyType;            /* of every node of the body grid */
+	tOversetType *backgroundType;      /* of every node of the background grid */
+
+	int          numReceptors;         /* fringe nodes of both grids, the body first */
+	int          *receptorGrid;        /* 0: body, 1: background */
+	int          *receptorNode;
+	int          *donorElement;        /* element of the other grid; -1: orphan */
+	double       *donorWeight;         /* four per receptor */
+} tOverset;
+
 #endif
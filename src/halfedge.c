@@ -0,0 +1,335 @@
+/*
+** Function BuildHalfEdges
+** Builds an array-based half-edge structure of the grid from its
+** elements in O(E): the twin of every half-edge, an outgoing half-edge
+** per node and the boundary loops. The elements must be oriented
+** consistently.
+**
+** Walking around a node:
+**   for(h=NodeRingFirst(HE, n); h!=-1; h=NodeRingNext(HE, n, h))
+** visits one outgoing half-edge per element around n. For a boundary
+** node the ring is open; the node at the start of the incoming boundary
+** half-edge, HalfEdgePrev() of the last h, is its final neighbour.
+**
+** In a mixed grid every element has nodesPerElement (4) slots; the
+** unused fourth slot of a triangle has origin -1 and is skipped.
+**
+** In:       tResult   Result   = structure containing Results
+**
+** Out:      tHalfEdge HalfEdge = half-edge structure
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+
+int BuildHalfEdges(FILE *log, tResult *Result, tHalfEdge *HalfEdge)
+{
+	int    ret;
+	int    e, k, n, h, g, o;
+	int    numNodes, npe, numNonManifold;
+	int    node[4];
+
+	int    *outStart = NULL;
+	int    *outEdge  = NULL;
+	int    *visited  = NULL;
+
+	ret            = 0;
+	numNodes       = Result->numNodes;
+	npe            = Result->nodesPerElement;
+	numNonManifold = 0;
+
+	HalfEdge->numNodes         = numNodes;
+	HalfEdge->numElements      = Result->numElements;
+	HalfEdge->nodesPerElement  = npe;
+	HalfEdge->numHalfEdges     = npe*Result->numElements;
+	HalfEdge->numBoundaryEdges = 0;
+	HalfEdge->numBoundaryLoops = 0;
+	HalfEdge->maxValence       = 0;
+	HalfEdge->loopStart        = NULL;
+
+	HalfEdge->origin       = (int*)malloc((HalfEdge->numHalfEdges > 0 ? HalfEdge->numHalfEdges : 1)*sizeof(int));
+	HalfEdge->twin         = (int*)malloc((HalfEdge->numHalfEdges > 0 ? HalfEdge->numHalfEdges : 1)*sizeof(int));
+	HalfEdge->boundaryNext = (int*)malloc((HalfEdge->numHalfEdges > 0 ? HalfEdge->numHalfEdges : 1)*sizeof(int));
+	HalfEdge->nodeHalfEdge = (int*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(int));
+
+	outStart = (int*)calloc(numNodes+1, sizeof(int));
+	outEdge  = (int*)malloc((HalfEdge->numHalfEdges > 0 ? HalfEdge->numHalfEdges : 1)*sizeof(int));
+	visited  = (int*)calloc((HalfEdge->numHalfEdges > 0 ? HalfEdge->numHalfEdges : 1), sizeof(int));
+
+	if (HalfEdge->origin == NULL || HalfEdge->twin == NULL || HalfEdge->boundaryNext == NULL ||
+	    HalfEdge->nodeHalfEdge == NULL || outStart == NULL || outEdge == NULL || visited == NULL)
+	{
+		fprintf(stderr, "ERROR in function BuildHalfEdges: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* Origins, and the outgoing half-edges per node */
+		for(e=0; e<Result->numElements; e++)
+		{
+			CopyNodes(&(*Result), e, node);
+
+			for(k=0; k<npe; k++)
+			{
+				if (k < NodesOfElement(&(*Result), e))
+				{
+					HalfEdge->origin[e*npe+k] = node[k];
+					outStart[node[k]+1]++;
+				}
+				else
+					HalfEdge->origin[e*npe+k] = -1;
+			}
+		}
+
+		for(n=0; n<numNodes; n++)
+		{
+			if (outStart[n+1] > HalfEdge->maxValence)
+				HalfEdge->maxValence = outStart[n+1];
+
+			outStart[n+1] += outStart[n];
+		}
+
+		for(h=0; h<HalfEdge->numHalfEdges; h++)
+			if (HalfEdge->origin[h] != -1)
+				outEdge[outStart[HalfEdge->origin[h]]++] = h;
+
+		for(n=numNodes; n>0; n--)
+			outStart[n] = outStart[n-1];
+		outStart[0] = 0;
+
+		/* The twin of a->b is the outgoing half-edge b->a */
+		#pragma omp parallel for private(n, o, g)
+		for(h=0; h<HalfEdge->numHalfEdges; h++)
+		{
+			HalfEdge->twin[h] = -1;
+
+			if (HalfEdge->origin[h] == -1)
+				continue;
+
+			n = HalfEdgeDest(&(*HalfEdge), h);
+
+			for(o=outStart[n]; o<outStart[n+1]; o++)
+			{
+				g = outEdge[o];
+
+				if (HalfEdgeDest(&(*HalfEdge), g) == HalfEdge->origin[h])
+				{
+					HalfEdge->twin[h] = g;
+					break;
+				}
+			}
+		}
+
+		/* An outgoing half-edge per node; a boundary one if present */
+		for(n=0; n<numNodes; n++)
+		{
+			HalfEdge->nodeHalfEdge[n] = (outStart[n] < outStart[n+1] ? outEdge[outStart[n]] : -1);
+
+			for(o=outStart[n], k=0; o<outStart[n+1]; o++)
+			{
+				if (HalfEdge->twin[outEdge[o]] == -1)
+				{
+					HalfEdge->nodeHalfEdge[n] = outEdge[o];
+					k++;
+				}
+			}
+
+			if (k > 1)
+				numNonManifold++;
+		}
+
+		/* Next boundary half-edge: turn around its end node */
+		for(h=0; h<HalfEdge->numHalfEdges; h++)
+		{
+			HalfEdge->boundaryNext[h] = -1;
+
+			if (HalfEdge->twin[h] == -1 && HalfEdge->origin[h] != -1)
+			{
+				HalfEdge->numBoundaryEdges++;
+
+				g = HalfEdgeNext(&(*HalfEdge), h);
+				for(k=0; HalfEdge->twin[g] != -1 && k <= HalfEdge->maxValence; k++)
+					g = HalfEdgeNext(&(*HalfEdge), HalfEdge->twin[g]);
+
+				HalfEdge->boundaryNext[h] = (HalfEdge->twin[g] == -1 ? g : h);
+			}
+		}
+
+		/* Boundary loops */
+		HalfEdge->loopStart = (int*)malloc((HalfEdge->numBoundaryEdges > 0 ? HalfEdge->numBoundaryEdges : 1)*sizeof(int));
+
+		if (HalfEdge->loopStart == NULL)
+		{
+			fprintf(stderr, "ERROR in function BuildHalfEdges: Could not allocate memory.\n");
+			ret = -1;
+		}
+		else
+		{
+			for(h=0; h<HalfEdge->numHalfEdges; h++)
+			{
+				if (HalfEdge->twin[h] == -1 && HalfEdge->origin[h] != -1 && visited[h] == 0)
+				{
+					HalfEdge->loopStart[HalfEdge->numBoundaryLoops++] = h;
+
+					for(g=h; visited[g] == 0; g=HalfEdge->boundaryNext[g])
+						visited[g] = 1;
+				}
+			}
+		}
+	}
+
+	/* Free allocated memory */
+	if (outStart)
+		free(outStart);
+
+	if (outEdge)
+		free(outEdge);
+
+	if (visited)
+		free(visited);
+
+	if (numNonManifold > 0)
+		fprintf(stderr, "WARNING in function BuildHalfEdges: %d non-manifold nodes.\n", numNonManifold);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION BUILDHALFEDGES *****\n\n");
+
+		fprintf(log, "number of half-edges = %d\n", HalfEdge->numHalfEdges);
+		fprintf(log, "boundary edges       = %d\n", HalfEdge->numBoundaryEdges);
+		fprintf(log, "boundary loops       = %d\n", HalfEdge->numBoundaryLoops);
+		fprintf(log, "maximum valence      = %d\n", HalfEdge->maxValence);
+		fprintf(log, "non-manifold nodes   = %d\n", numNonManifold);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function FreeHalfEdges
+** Frees the arrays of a half-edge structure.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeHalfEdges(tHalfEdge *HalfEdge)
+{
+	if (HalfEdge->origin)
+		free(HalfEdge->origin);
+
+	if (HalfEdge->twin)
+		free(HalfEdge->twin);
+
+	if (HalfEdge->nodeHalfEdge)
+		free(HalfEdge->nodeHalfEdge);
+
+	if (HalfEdge->boundaryNext)
+		free(HalfEdge->boundaryNext);
+
+	if (HalfEdge->loopStart)
+		free(HalfEdge->loopStart);
+
+	HalfEdge->origin       = NULL;
+	HalfEdge->twin         = NULL;
+	HalfEdge->nodeHalfEdge = NULL;
+	HalfEdge->boundaryNext = NULL;
+	HalfEdge->loopStart    = NULL;
+
+	return 0;
+}
+
+/*
+** Function HalfEdgeNext
+** Returns the next half-edge within the same element.
+**
+** Author:   J.L. Klaufus
+*/
+
+int HalfEdgeNext(tHalfEdge *HalfEdge, int h)
+{
+	int k = h%HalfEdge->nodesPerElement;
+
+	return (k == HalfEdge->nodesPerElement-1 || HalfEdge->origin[h+1] == -1 ? h-k : h+1);
+}
+
+/*
+** Function HalfEdgePrev
+** Returns the previous half-edge within the same element.
+**
+** Author:   J.L. Klaufus
+*/
+
+int HalfEdgePrev(tHalfEdge *HalfEdge, int h)
+{
+	if (h%HalfEdge->nodesPerElement != 0)
+		return h-1;
+
+	for(h=h+HalfEdge->nodesPerElement-1; HalfEdge->origin[h] == -1; h--);
+
+	return h;
+}
+
+/*
+** Function HalfEdgeDest
+** Returns the node at the end of a half-edge.
+**
+** Author:   J.L. Klaufus
+*/
+
+int HalfEdgeDest(tHalfEdge *HalfEdge, int h)
+{
+	return HalfEdge->origin[HalfEdgeNext(&(*HalfEdge), h)];
+}
+
+/*
+** Function HalfEdgeElement
+** Returns the element of a half-edge.
+**
+** Author:   J.L. Klaufus
+*/
+
+int HalfEdgeElement(tHalfEdge *HalfEdge, int h)
+{
+	return h/HalfEdge->nodesPerElement;
+}
+
+/*
+** Function NodeRingFirst
+** Returns the first outgoing half-edge of a node; -1 for unused nodes.
+**
+** Author:   J.L. Klaufus
+*/
+
+int NodeRingFirst(tHalfEdge *HalfEdge, int node)
+{
+	return HalfEdge->nodeHalfEdge[node];
+}
+
+/*
+** Function NodeRingNext
+** Returns the next outgoing half-edge around a node, in the next
+** element; -1 when the ring is complete or reaches the boundary.
+**
+** Author:   J.L. Klaufus
+*/
+
+int NodeRingNext(tHalfEdge *HalfEdge, int node, int h)
+{
+	h = HalfEdge->twin[HalfEdgePrev(&(*HalfEdge), h)];
+
+	return (h == HalfEdge->nodeHalfEdge[node] ? -1 : h);
+}
@@ -0,0 +1,37 @@
+/*
+** Header-file for HalfEdge
+*/
+
+#ifndef HALFEDGE_H
+#define HALFEDGE_H
+
+typedef struct
+{
+	int    numNodes;
+	int    numElements;
+	int    nodesPerElement;
+	int    numHalfEdges;      /* half-edge h = e*nodesPerElement + k runs from   */
+	                          /* node k to node k+1 of element e                 */
+	int    *origin;           /* first node of each half-edge; -1 for the unused */
+	                          /* slot of a triangle in a mixed grid              */
+	int    *twin;             /* opposite half-edge; -1 at a boundary            */
+	int    *nodeHalfEdge;     /* outgoing half-edge of each node, the boundary   */
+	                          /* one for boundary nodes; -1 for unused nodes     */
+	int    *boundaryNext;     /* next half-edge along the boundary loop; -1 for  */
+	                          /* interior half-edges                             */
+	int    numBoundaryEdges;
+	int    numBoundaryLoops;
+	int    *loopStart;        /* a boundary half-edge of each loop               */
+	int    maxValence;        /* maximum number of elements around a node        */
+} tHalfEdge;
+
+int BuildHalfEdges(FILE*, tResult*, tHalfEdge*);
+int FreeHalfEdges(tHalfEdge*);
+int HalfEdgeNext(tHalfEdge*, int);
+int HalfEdgePrev(tHalfEdge*, int);
+int HalfEdgeDest(tHalfEdge*, int);
+int HalfEdgeElement(tHalfEdge*, int);
+int NodeRingFirst(tHalfEdge*, int);
+int NodeRingNext(tHalfEdge*, int, int);
+
+#endif
@@ -0,0 +1,462 @@
+/*
+** Function Hyperbolic
+** Marches the grid outward from the eta = 0 line, the aerofoil and the
+** cut, one row at a time. Every row follows from the equations of
+** orthogonality and cell area,
+**
+**   xKsi*xEta + yKsi*yEta = 0
+**   xKsi*yEta - yKsi*xEta = dV,
+**
+** linearized about the previous row into one block tridiagonal system
+** along ksi, so the grid is built in a single pass instead of by
+** iterating an elliptic system to convergence. The steps follow the
+** distribution of the outflow boundaries over the height of each
+** column of the algebraic grid; the ends of the rows slide along the
+** outflow boundaries. Explicit dissipation, growing from 0 on the first
+** row to omegaSmooth (at least MINDISSIPATION) on the last, and
+** implicit dissipation of twice that, carry the rows through the
+** concave trailing edge; omegaElliptic (0 to 1) averages the volumes
+** with their neighbours. Every row is checked as it is marched: where a
+** node is not finite or a cell folds, the grid is marched again from
+** the aerofoil with twice the dissipation, up to NUMMARCHES times.
+** Finally the rows are shifted onto the walls and the inflow boundary,
+** the more the further from the aerofoil, and checked again.
+**
+** In:       tData    Data       = Structure containing read data
+**           tResult  Result     = Structure containg results
+** Out:      tResult  Result     = Structure containg results
+** Return:   0 on success; -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "hyperbolic.h"
+#include "loc.h"
+#include "metrics.h"
+#include "sy.h"
+
+int Hyperbolic(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    i, j;
+	int    im, jm;
+	int    march, folded;
+
+	int    loc, loc_eta_min, loc_eta_max;
+	int    loc_ksi_up, loc_ksi_down;
+
+	double *s       = NULL;
+	double *weight  = NULL;
+	double *height  = NULL;
+	double *volume  = NULL;
+	double *xOuter  = NULL, *yOuter = NULL;
+	double *bb      = NULL, *dd = NULL, *aa = NULL, *cc = NULL;
+
+	double side;
+	double dissipation, epsilon, nu;
+	double xKsi, yKsi, xEta, yEta, g;
+	double c11, c12;
+	double xTangent0, yTangent0, xTangent1, yTangent1, length;
+	double shift, shiftMax;
+
+	printf("Marching hyperbolic grid...\n");
+
+	ret      = 0;
+	im       = Result->im;
+	jm       = Result->jm;
+	epsilon  = 0;
+	nu       = Data->omegaElliptic;
+	shiftMax = 0;
+
+	/* Without dissipation the rows cross behind the trailing edge */
+	dissipation = Data->omegaSmooth;
+	if (dissipation < MINDISSIPATION)
+	{
+		fprintf(stderr, "WARNING in function Hyperbolic: omegaSmooth raised to %.2f.\n", MINDISSIPATION);
+		dissipation = MINDISSIPATION;
+	}
+
+	/* Allocate memory */
+	s      = (double*)malloc(jm*sizeof(double));
+	weight = (double*)malloc(jm*sizeof(double));
+	height = (double*)malloc(im*sizeof(double));
+	volume = (double*)malloc(im*sizeof(double));
+	xOuter = (double*)malloc(im*sizeof(double));
+	yOuter = (double*)malloc(im*sizeof(double));
+	bb     = (double*)malloc(4*im*sizeof(double));
+	dd     = (double*)malloc(4*im*sizeof(double));
+	aa     = (double*)malloc(4*im*sizeof(double));
+	cc     = (double*)malloc(2*im*sizeof(double));
+
+	if ((s == NULL) || (weight == NULL) || (height == NULL) || (volume == NULL) ||
+	    (xOuter == NULL) || (yOuter == NULL) ||
+	    (bb == NULL) || (dd == NULL) || (aa == NULL) || (cc == NULL))
+	{
+		fprintf(stderr, "ERROR in function Hyperbolic: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/*
+		** Eta of every row: the mean relative arc length along both outflow
+		** boundaries, whose arc lengths are kept in s and weight first
+		*/
+		s[0] = weight[0] = 0;
+		for(j=1; j<jm; j++)
+		{
+			loc_eta_min = Loc(&(*Result), j-1, 0);
+			loc         = Loc(&(*Result), j, 0);
+			s[j]        = s[j-1] + sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+			                            pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+
+			loc_eta_min = Loc(&(*Result), j-1, im-1);
+			loc         = Loc(&(*Result), j, im-1);
+			weight[j]   = weight[j-1] + sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+			                                 pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+		}
+
+		for(j=0; j<jm; j++)
+			s[j] = 0.5*(s[j]/s[jm-1] + weight[j]/weight[jm-1]);
+
+		/* The shift onto the outer boundary sets in smoothly */
+		for(j=0; j<jm; j++)
+			weight[j] = s[j]*s[j]*(3 - 2*s[j]);
+
+		/* Height of every column and its node on the outer boundary */
+		for(i=0; i<im; i++)
+		{
+			height[i] = 0;
+			for(j=1; j<jm; j++)
+			{
+				loc_eta_min = Loc(&(*Result), j-1, i);
+				loc         = Loc(&(*Result), j, i);
+				height[i]  += sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+				                   pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+			}
+
+			loc       = Loc(&(*Result), jm-1, i);
+			xOuter[i] = Result->x[loc];
+			yOuter[i] = Result->y[loc];
+		}
+
+		/* Direction of both outflow boundaries */
+		loc_eta_min = Loc(&(*Result), 0, 0);
+		loc_eta_max = Loc(&(*Result), jm-1, 0);
+		xTangent0   = Result->x[loc_eta_max] - Result->x[loc_eta_min];
+		yTangent0   = Result->y[loc_eta_max] - Result->y[loc_eta_min];
+		length      = sqrt(xTangent0*xTangent0 + yTangent0*yTangent0);
+		xTangent0  /= length;
+		yTangent0  /= length;
+
+		loc_eta_min = Loc(&(*Result), 0, im-1);
+		loc_eta_max = Loc(&(*Result), jm-1, im-1);
+		xTangent1   = Result->x[loc_eta_max] - Result->x[loc_eta_min];
+		yTangent1   = Result->y[loc_eta_max] - Result->y[loc_eta_min];
+		length      = sqrt(xTangent1*xTangent1 + yTangent1*yTangent1);
+		xTangent1  /= length;
+		yTangent1  /= length;
+
+		/* The grid lies on one side of eta = 0, the side most columns go to */
+		side = 0;
+		for(i=1; i<im-1; i++)
+		{
+			loc_ksi_up   = Loc(&(*Result), 0, i+1);
+			loc_ksi_down = Loc(&(*Result), 0, i-1);
+			loc_eta_min  = Loc(&(*Result), 0, i);
+			loc_eta_max  = Loc(&(*Result), jm-1, i);
+
+			side += (Result->y[loc_ksi_down] - Result->y[loc_ksi_up])*(Result->x[loc_eta_max] - Result->x[loc_eta_min]) +
+			        (Result->x[loc_ksi_up] - Result->x[loc_ksi_down])*(Result->y[loc_eta_max] - Result->y[loc_eta_min]);
+		}
+
+		side = (side < 0 ? -1 : 1);
+	}
+
+	/*
+	** A row folds where the rows converge faster than the dissipation
+	** spreads them, which builds up over many rows; the march is then
+	** repeated from the first row with twice the dissipation
+	*/
+	folded = 1;
+	for(march=0; (march<NUMMARCHES) && (folded != 0) && (ret != -1); march++)
+	{
+		if (march > 0)
+		{
+			dissipation *= 2;
+			fprintf(stderr, "WARNING in function Hyperbolic: Row %d folds; marching again with dissipation %.2f.\n", folded, dissipation);
+		}
+
+		folded = 0;
+		for(j=1; (j<jm) && (ret != -1) && (folded == 0); j++)
+		{
+			/* No dissipation on the first row, which follows the aerofoil */
+			if (jm > 2)
+				epsilon = dissipation*sqrt((j - 1)/(double)(jm - 2));
+
+			/* Volume of the cells of the new row, dV = step*|dX/dKsi| */
+			for(i=1; i<im-1; i++)
+			{
+				loc_ksi_up   = Loc(&(*Result), j-1, i+1);
+				loc_ksi_down = Loc(&(*Result), j-1, i-1);
+
+				xKsi = 0.5*(Result->x[loc_ksi_up] - Result->x[loc_ksi_down]);
+				yKsi = 0.5*(Result->y[loc_ksi_up] - Result->y[loc_ksi_down]);
+
+				cc[i] = side*(s[j] - s[j-1])*height[i]*sqrt(xKsi*xKsi + yKsi*yKsi);
+			}
+
+			for(i=1; i<im-1; i++)
+			{
+				if ((i > 1) && (i < im-2))
+					volume[i] = (1 - 0.5*nu)*cc[i] + 0.25*nu*(cc[i-1] + cc[i+1]);
+				else
+					volume[i] = cc[i];
+			}
+
+			/*
+			** Linearized about the previous row, with xEta and yEta from its
+			** xKsi, yKsi and the new volume, the step dX obeys
+			**
+			**   dX + C*dX/dKsi - 2*epsilon*d2(dX)/dKsi2 = B^-1*(0, dV) + epsilon*d2X/dKsi2
+			**
+			** where C = B^-1*A is symmetric with C22 = -C11
+			*/
+			#pragma omp parallel for private(loc, loc_ksi_up, loc_ksi_down, xKsi, yKsi, xEta, yEta, g, c11, c12)
+			for(i=1; i<im-1; i++)
+			{
+				loc          = Loc(&(*Result), j-1, i);
+				loc_ksi_up   = Loc(&(*Result), j-1, i+1);
+				loc_ksi_down = Loc(&(*Result), j-1, i-1);
+
+				xKsi = 0.5*(Result->x[loc_ksi_up] - Result->x[loc_ksi_down]);
+				yKsi = 0.5*(Result->y[loc_ksi_up] - Result->y[loc_ksi_down]);
+				g    = xKsi*xKsi + yKsi*yKsi;
+
+				xEta = -yKsi*volume[i]/g;
+				yEta =  xKsi*volume[i]/g;
+
+				c11 = (xKsi*xEta - yKsi*yEta)/g;
+				c12 = (xKsi*yEta + yKsi*xEta)/g;
+
+				bb[4*i  ] = -0.5*c11 - 2*epsilon;
+				bb[4*i+1] = -0.5*c12;
+				bb[4*i+2] = -0.5*c12;
+				bb[4*i+3] =  0.5*c11 - 2*epsilon;
+
+				dd[4*i  ] = 1 + 4*epsilon;
+				dd[4*i+1] = 0;
+				dd[4*i+2] = 0;
+				dd[4*i+3] = 1 + 4*epsilon;
+
+				aa[4*i  ] =  0.5*c11 - 2*epsilon;
+				aa[4*i+1] =  0.5*c12;
+				aa[4*i+2] =  0.5*c12;
+				aa[4*i+3] = -0.5*c11 - 2*epsilon;
+
+				cc[2*i  ] = xEta + epsilon*(Result->x[loc_ksi_up] - 2*Result->x[loc] + Result->x[loc_ksi_down]);
+				cc[2*i+1] = yEta + epsilon*(Result->y[loc_ksi_up] - 2*Result->y[loc] + Result->y[loc_ksi_down]);
+			}
+
+			/*
+			** The ends stay on the outflow boundaries and step along them as
+			** far as their neighbours
+			*/
+			dd[0] = -yTangent0;
+			dd[1] =  xTangent0;
+			dd[2] =  xTangent0;
+			dd[3] =  yTangent0;
+			aa[0] =  0;
+			aa[1] =  0;
+			aa[2] = -xTangent0;
+			aa[3] = -yTangent0;
+			cc[0] =  0;
+			cc[1] =  0;
+
+			i = im-1;
+			bb[4*i  ] =  0;
+			bb[4*i+1] =  0;
+			bb[4*i+2] = -xTangent1;
+			bb[4*i+3] = -yTangent1;
+			dd[4*i  ] = -yTangent1;
+			dd[4*i+1] =  xTangent1;
+			dd[4*i+2] =  xTangent1;
+			dd[4*i+3] =  yTangent1;
+			cc[2*i  ] =  0;
+			cc[2*i+1] =  0;
+
+			if (SYBlockFactor(0, im-1, bb, dd, aa) == -1)
+			{
+				fprintf(stderr, "ERROR in function Hyperbolic: Singular system in row %d.\n", j);
+				ret = -1;
+			}
+			else
+			{
+				SYBlockSolve(0, im-1, bb, dd, aa, cc);
+
+				for(i=0; i<im; i++)
+				{
+					loc_eta_min = Loc(&(*Result), j-1, i);
+					loc         = Loc(&(*Result), j, i);
+
+					Result->x[loc] = Result->x[loc_eta_min] + cc[2*i];
+					Result->y[loc] = Result->y[loc_eta_min] + cc[2*i+1];
+				}
+
+				if (CheckRow(&(*Result), j, side) == -1)
+					folded = j;
+			}
+		}
+	}
+
+	if ((ret != -1) && (folded != 0))
+	{
+		fprintf(stderr, "ERROR in function Hyperbolic: Row %d folds with dissipation %.2f.\n", folded, dissipation);
+		ret = -1;
+	}
+
+	/* Shift the rows onto the outer boundary */
+	if (ret != -1)
+	{
+		for(i=0; i<im; i++)
+		{
+			loc_eta_max = Loc(&(*Result), jm-1, i);
+
+			xOuter[i] -= Result->x[loc_eta_max];
+			yOuter[i] -= Result->y[loc_eta_max];
+
+			shift = sqrt(xOuter[i]*xOuter[i] + yOuter[i]*yOuter[i]);
+			if (shift > shiftMax)
+				shiftMax = shift;
+		}
+
+		#pragma omp parallel for private(i, loc)
+		for(j=1; j<jm; j++)
+		{
+			for(i=0; i<im; i++)
+			{
+				loc = Loc(&(*Result), j, i);
+
+				Result->x[loc] += weight[j]*xOuter[i];
+				Result->y[loc] += weight[j]*yOuter[i];
+			}
+		}
+
+		for(j=1; (j<jm) && (ret != -1); j++)
+		{
+			if (CheckRow(&(*Result), j, side) == -1)
+			{
+				fprintf(stderr, "ERROR in function Hyperbolic: Row %d folds on the shift onto the outer boundary.\n", j);
+				ret = -1;
+			}
+		}
+	}
+
+	printf("Number of rows       = %d\n", jm-1);
+	printf("Largest shift        = %f\n", shiftMax);
+
+	/* Calculate the metrics of the new grid */
+	if (ret != -1)
+		ret = CalcMetrics(&(*log), &(*Result));
+
+	/* Free memory */
+	if (s)
+		free(s);
+	if (weight)
+		free(weight);
+	if (height)
+		free(height);
+	if (volume)
+		free(volume);
+	if (xOuter)
+		free(xOuter);
+	if (yOuter)
+		free(yOuter);
+	if (bb)
+		free(bb);
+	if (dd)
+		free(dd);
+	if (aa)
+		free(aa);
+	if (cc)
+		free(cc);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION HYPERBOLIC *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "Hyperbolic successfully ended.\n");
+			fprintf(log, "Number of rows: %d\n", jm-1);
+			fprintf(log, "Dissipation: %f\n", dissipation);
+			fprintf(log, "Number of marches: %d\n", march);
+			fprintf(log, "Largest shift onto the outer boundary: %f\n", shiftMax);
+		}
+		else
+		{
+			fprintf(log, "Hyperbolic NOT successfully ended.\n");
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function CheckRow
+** Checks the nodes of row j and the cells between rows j-1 and j: every
+** node must be finite and every corner of every cell must turn to the
+** side of the grid.
+**
+** In:       tResult  Result = Structure containg results
+**           int      j      = row
+**           double   side   = 1 or -1, the side of eta = 0 of the grid
+**
+** Return:   0 if the row is valid; -1 otherwise
+**
+** Author:   J.L. Klaufus
+*/
+
+int CheckRow(tResult *Result, int j, double side)
+{
+	int    i, k;
+	int    corner[4];
+	double xA, yA, xB, yB;
+
+	for(i=0; i<Result->im; i++)
+	{
+		k = Loc(&(*Result), j, i);
+
+		if (!isfinite(Result->x[k]) || !isfinite(Result->y[k]))
+			return -1;
+	}
+
+	for(i=0; i<Result->im-1; i++)
+	{
+		corner[0] = Loc(&(*Result), j-1, i);
+		corner[1] = Loc(&(*Result), j-1, i+1);
+		corner[2] = Loc(&(*Result), j,   i+1);
+		corner[3] = Loc(&(*Result), j,   i);
+
+		for(k=0; k<4; k++)
+		{
+			xA = Result->x[corner[(k+1)%4]] - Result->x[corner[k]];
+			yA = Result->y[corner[(k+1)%4]] - Result->y[corner[k]];
+			xB = Result->x[corner[(k+3)%4]] - Result->x[corner[k]];
+			yB = Result->y[corner[(k+3)%4]] - Result->y[corner[k]];
+
+			if (side*(xA*yB - yA*xB) <= 0)
+				return -1;
+		}
+	}
+
+	return 0;
+}
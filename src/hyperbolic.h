@@ -0,0 +1,11 @@
+/*
+** Header-file for Hyperbolic
+*/
+
+#ifndef HYPERBOLIC_H
+#define HYPERBOLIC_H
+
+int Hyperbolic(FILE*, tData*, tResult*);
+int CheckRow(tResult*, int, double);
+
+#endif
@@ -10,6 +10,8 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 
 #include "gridgen.h"
 #include "interpolate.h"
@@ -117,3 +119,274 @@ int Interpolate(FILE *log, tResult* Result)
 	return ret;
 }
 
+/*
+** Function HermiteInterpolate
+** Transfinite interpolation that leaves the eta = 0 line along its
+** normal. In eta the nodes are blended by cubic Hermite functions of
+** the nodes at eta = 0 and eta = max and the derivative at eta = 0,
+** along the normal of that line with the first spacing of the outflow
+** boundaries; the remainder on the ksi = min and ksi = max boundaries
+** is blended in linearly and shrinks with a limited derivative. The
+** rows follow the distribution of the outflow boundaries, so the grid
+** is clustered like them.
+**
+** In:       tResult Result   = structure containing Results
+** Out:      tResult Result   = structure containing Results
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int HermiteInterpolate(FILE *log, tResult* Result)
+{
+	int    ret;
+	int    i, j;
+	int    im, jm;
+	int    numLimited;
+
+	int    loc, loc_eta_min, loc_eta_max;
+
+	double *s       = NULL;
+	double *alpha0  = NULL, *alpha1 = NULL, *beta0 = NULL;
+	double *phi     = NULL;
+	double *xNormal = NULL, *yNormal = NULL;
+	double *h       = NULL;
+	double *magnitude = NULL;
+
+	double spacing;
+	double length, turn;
+	double side;
+	double xTangent, yTangent;
+	double xRest0, yRest0, xRest1, yRest1;
+
+	printf("Interpolating (Hermite)...\n");
+
+	ret        = 0;
+	im         = Result->im;
+	jm         = Result->jm;
+	spacing    = 0;
+	numLimited = 0;
+
+	/* Allocate memory */
+	s       = (double*)malloc(jm*sizeof(double));
+	alpha0  = (double*)malloc(jm*sizeof(double));
+	alpha1  = (double*)malloc(jm*sizeof(double));
+	beta0   = (double*)malloc(jm*sizeof(double));
+	phi     = (double*)malloc(im*sizeof(double));
+	xNormal = (double*)malloc(im*sizeof(double));
+	yNormal = (double*)malloc(im*sizeof(double));
+	h       = (double*)malloc(im*sizeof(double));
+	magnitude = (double*)malloc(im*sizeof(double));
+
+	if ((s == NULL) || (alpha0 == NULL) || (alpha1 == NULL) || (beta0 == NULL) ||
+	    (phi == NULL) || (xNormal == NULL) || (yNormal == NULL) || (h == NULL) || (magnitude == NULL))
+	{
+		fprintf(stderr, "ERROR in function HermiteInterpolate: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/*
+		** Eta of every row: the mean relative arc length along both outflow
+		** boundaries, whose arc lengths are kept in alpha0 and alpha1 first
+		*/
+		alpha0[0] = alpha1[0] = 0;
+		for(j=1; j<jm; j++)
+		{
+			loc_eta_min = Loc(&(*Result), j-1, 0);
+			loc         = Loc(&(*Result), j, 0);
+			alpha0[j]   = alpha0[j-1] + sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+			                                 pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+
+			loc_eta_min = Loc(&(*Result), j-1, im-1);
+			loc         = Loc(&(*Result), j, im-1);
+			alpha1[j]   = alpha1[j-1] + sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+			                                 pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+
+			if (j == 1)
+				spacing = (alpha0[1] < alpha1[1] ? alpha0[1] : alpha1[1]);
+		}
+
+		for(j=0; j<jm; j++)
+			s[j] = 0.5*(alpha0[j]/alpha0[jm-1] + alpha1[j]/alpha1[jm-1]);
+
+		/* Blending factor tables */
+		for(j=0; j<jm; j++)
+		{
+			alpha0[j] = 1 - s[j]*s[j]*(3 - 2*s[j]);
+			alpha1[j] = s[j]*s[j]*(3 - 2*s[j]);
+			beta0[j]  = s[j]*(1 - s[j])*(1 - s[j]);
+		}
+
+		for(i=0; i<im; i++)
+			phi[i] = i/(double)(im-1);
+
+		/* Unit normal of eta = 0 and the spacing to the next node */
+		side = 0;
+		for(i=0; i<im; i++)
+		{
+			loc_eta_min = Loc(&(*Result), 0, (i < im-1 ? i+1 : i));
+			loc         = Loc(&(*Result), 0, (i > 0 ? i-1 : i));
+
+			xTangent = Result->x[loc_eta_min] - Result->x[loc];
+			yTangent = Result->y[loc_eta_min] - Result->y[loc];
+			length   = sqrt(xTangent*xTangent + yTangent*yTangent);
+
+			xNormal[i] = -yTangent/length;
+			yNormal[i] =  xTangent/length;
+
+			loc_eta_min = Loc(&(*Result), 0, i);
+			loc_eta_max = Loc(&(*Result), jm-1, i);
+
+			side += xNormal[i]*(Result->x[loc_eta_max] - Result->x[loc_eta_min]) +
+			        yNormal[i]*(Result->y[loc_eta_max] - Result->y[loc_eta_min]);
+
+			if (i < im-1)
+			{
+				loc = Loc(&(*Result), 0, i+1);
+				h[i] = sqrt(pow(Result->x[loc] - Result->x[loc_eta_min], 2) +
+				            pow(Result->y[loc] - Result->y[loc_eta_min], 2));
+			}
+		}
+
+		/* The grid lies on one side of eta = 0, the side most columns go to */
+		if (side < 0)
+		{
+			for(i=0; i<im; i++)
+			{
+				xNormal[i] = -xNormal[i];
+				yNormal[i] = -yNormal[i];
+			}
+		}
+
+		/*
+		** The length of the derivative gives the first spacing in the first
+		** row. Where the normals turn towards each other, neighbouring lines
+		** must not cross: beta0 reaches 4/27, so the difference of neighbouring
+		** derivatives stays below 27/8 times the spacing of the nodes. Half
+		** of that goes to the turn of the normal, half to the change in
+		** length, so the length dies out smoothly into a concave corner, as
+		** at the trailing edge.
+		*/
+		for(i=0; i<im; i++)
+			length = magnitude[i] = spacing/s[1];
+
+		for(i=0; i<im-1; i++)
+		{
+			h[i] *= 27.0/8;
+
+			/* Only normals turning towards each other, at a concave corner */
+			loc         = Loc(&(*Result), 0, i);
+			loc_eta_min = Loc(&(*Result), 0, i+1);
+			if ((xNormal[i+1] - xNormal[i])*(Result->x[loc_eta_min] - Result->x[loc]) +
+			    (yNormal[i+1] - yNormal[i])*(Result->y[loc_eta_min] - Result->y[loc]) >= 0)
+				continue;
+
+			turn = sqrt(pow(xNormal[i+1] - xNormal[i], 2) + pow(yNormal[i+1] - yNormal[i], 2));
+			if (turn*magnitude[i] > 0.5*h[i])
+				magnitude[i] = 0.5*h[i]/turn;
+			if (turn*magnitude[i+1] > 0.5*h[i])
+				magnitude[i+1] = 0.5*h[i]/turn;
+		}
+
+		for(i=1; i<im; i++)
+			if (magnitude[i] > magnitude[i-1] + 0.5*h[i-1])
+				magnitude[i] = magnitude[i-1] + 0.5*h[i-1];
+
+		for(i=im-2; i>=0; i--)
+			if (magnitude[i] > magnitude[i+1] + 0.5*h[i])
+				magnitude[i] = magnitude[i+1] + 0.5*h[i];
+
+		/* What is left of the derivative also scales what the sides add */
+		for(i=0; i<im; i++)
+		{
+			if (magnitude[i] < length)
+				numLimited++;
+
+			h[i] = magnitude[i]/length;
+
+			xNormal[i] *= magnitude[i];
+			yNormal[i] *= magnitude[i];
+		}
+
+		#pragma omp parallel for private(i, loc, loc_eta_min, loc_eta_max, xRest0, yRest0, xRest1, yRest1)
+		for(j=1; j<jm-1; j++)
+		{
+			/* What the Hermite blend misses on the outflow boundaries */
+			loc         = Loc(&(*Result), j, 0);
+			loc_eta_min = Loc(&(*Result), 0, 0);
+			loc_eta_max = Loc(&(*Result), jm-1, 0);
+
+			xRest0 = Result->x[loc] - alpha0[j]*Result->x[loc_eta_min] - alpha1[j]*Result->x[loc_eta_max] - beta0[j]*xNormal[0];
+			yRest0 = Result->y[loc] - alpha0[j]*Result->y[loc_eta_min] - alpha1[j]*Result->y[loc_eta_max] - beta0[j]*yNormal[0];
+
+			loc         = Loc(&(*Result), j, im-1);
+			loc_eta_min = Loc(&(*Result), 0, im-1);
+			loc_eta_max = Loc(&(*Result), jm-1, im-1);
+
+			xRest1 = Result->x[loc] - alpha0[j]*Result->x[loc_eta_min] - alpha1[j]*Result->x[loc_eta_max] - beta0[j]*xNormal[im-1];
+			yRest1 = Result->y[loc] - alpha0[j]*Result->y[loc_eta_min] - alpha1[j]*Result->y[loc_eta_max] - beta0[j]*yNormal[im-1];
+
+			for(i=1; i<im-1; i++)
+			{
+				loc         = Loc(&(*Result), j, i);
+				loc_eta_min = Loc(&(*Result), 0, i);
+				loc_eta_max = Loc(&(*Result), jm-1, i);
+
+				Result->x[loc] = alpha0[j]*Result->x[loc_eta_min] + alpha1[j]*Result->x[loc_eta_max] + beta0[j]*xNormal[i] +
+				                 h[i]*((1 - phi[i])*xRest0 + phi[i]*xRest1);
+				Result->y[loc] = alpha0[j]*Result->y[loc_eta_min] + alpha1[j]*Result->y[loc_eta_max] + beta0[j]*yNormal[i] +
+				                 h[i]*((1 - phi[i])*yRest0 + phi[i]*yRest1);
+			}
+		}
+	}
+
+	/* Free memory */
+	if (s)
+		free(s);
+	if (alpha0)
+		free(alpha0);
+	if (alpha1)
+		free(alpha1);
+	if (beta0)
+		free(beta0);
+	if (phi)
+		free(phi);
+	if (xNormal)
+		free(xNormal);
+	if (yNormal)
+		free(yNormal);
+	if (h)
+		free(h);
+	if (magnitude)
+		free(magnitude);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION HERMITEINTERPOLATE *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "first spacing     = %e\n", spacing);
+			fprintf(log, "limited normals   = %d\n\n", numLimited);
+		}
+
+		fprintf(log, "  j   i          x          y\n");
+
+		for(j=0; j<Result->jm; j++)
+		{
+			for(i=0; i<Result->im; i++)
+			{
+				loc = Loc(&(*Result), j, i);
+
+				fprintf(log, "%3d %3d %10.6f %10.6f\n", j, i, Result->x[loc], Result->y[loc]);
+			}
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
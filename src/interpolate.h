@@ -6,5 +6,6 @@
 #define INTERPOLATE
 
 int Interpolate(FILE*, tResult*);
+int HermiteInterpolate(FILE*, tResult*);
 
 #endif
@@ -31,3 +31,145 @@ int Loc(tResult *Result, int j, int i)
 	return pos;
 }
 
+
+/*
+** Function Ksi
+** Returns the KSI co-ordinate of a node in computational space.
+** The computational space is not stored; it follows from the position.
+**
+** In:       tResult Result = structure containing all results
+**           int     loc    = position in array
+** Out:      -
+** Return:   KSI co-ordinate
+**
+** Author:   J.L. Klaufus
+*/
+
+double Ksi(tResult *Result, int loc)
+{
+	return (loc % Result->im)*Result->ksiDelta;
+}
+
+/*
+** Function Eta
+** Returns the ETA co-ordinate of a node in computational space.
+**
+** In:       tResult Result = structure containing all results
+**           int     loc    = position in array
+** Out:      -
+** Return:   ETA co-ordinate
+**
+** Author:   J.L. Klaufus
+*/
+
+double Eta(tResult *Result, int loc)
+{
+	return (loc / Result->im)*Result->etaDelta;
+}
+
+/*
+** Function CopyNodes
+** Copies all nodes for element e to a temporary array.
+** For structured grids the element array is not stored; the nodes of
+** quadrangle e = j*(im-1) + i then follow from (j,i).
+**
+** In:      tResult Result     = structure containing all results.
+**          int     element    = number identifying current element.
+** Out:     int     *nodes     = array with nodes
+** Return:  0 on success / -1 on failure
+**
+** Author:  J.L. Klaufus
+*/
+
+int CopyNodes(tResult *Result, int element, int *node)
+{
+	int ret;
+	int n;
+	int i, j;
+
+	ret = 0;
+
+	/*
+	** Copy all nodes.
+	*/
+	if(Result->structuredElements)
+	{
+		/* Quadrangle consists out of nodeSE, nodeSW, nodeNW and nodeNE */
+		i = element % (Result->im-1);
+		j = element / (Result->im-1);
+
+		node[0] = Loc(&(*Result), j, i+1);
+		node[1] = Loc(&(*Result), j, i);
+		node[2] = Loc(&(*Result), j+1, i);
+		node[3] = Loc(&(*Result), j+1, i+1);
+	}
+	else if(TypeOfElement(&(*Result), element) == etTriangle)
+	{
+		/* Fill the nodes array */
+		for(n=0; n<3; n++)
+			node[n] = Result->element[element].triangle.node[n];
+	}
+	else if(TypeOfElement(&(*Result), element) == etQuadrangle)
+	{
+		/* Fill the nodes array */
+		for(n=0; n<4; n++)
+			node[n] = Result->element[element].quadrangle.node[n];
+	}
+	else
+	{
+		fprintf(stderr, "ERROR in function CopyNodes: Unknown element type.\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+/*
+** Function TypeOfElement
+** Returns the type of element e; for mixed grids it is stored per element.
+**
+** In:      tResult Result     = structure containing all results.
+**          int     element    = number identifying current element.
+** Return:  element type
+**
+** Author:  J.L. Klaufus
+*/
+
+tElementType TypeOfElement(tResult *Result, int element)
+{
+	return (Result->elementType == etMixed ? Result->elementTypes[element] : Result->elementType);
+}
+
+/*
+** Function NodesOfElement
+** Returns the number of nodes of element e.
+**
+** In:      tResult Result     = structure containing all results.
+**          int     element    = number identifying current element.
+** Return:  number of nodes
+**
+** Author:  J.L. Klaufus
+*/
+
+int NodesOfElement(tResult *Result, int element)
+{
+	return (TypeOfElement(&(*Result), element) == etTriangle ? 3 : 4);
+}
+
+/*
+** Function PatchOfEdge
+** Returns the boundary patch of the boundary edge between nodes a and
+** b: the higher patch of its two nodes, as a corner node keeps the
+** lower patch of its two sides.
+**
+** In:      tResult Result     = structure containing all results.
+**          int     a, b       = nodes of a boundary edge.
+** Return:  boundary patch
+**
+** Author:  J.L. Klaufus
+*/
+
+tPatch PatchOfEdge(tResult *Result, int a, int b)
+{
+	return (Result->patch[a] > Result->patch[b] ? Result->patch[a] : Result->patch[b]);
+}
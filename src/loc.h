@@ -5,6 +5,12 @@
 #ifndef LOC_H
 #define LOC_H
 
-int Loc(tResult*, int, int);
+int    Loc(tResult*, int, int);
+double Ksi(tResult*, int);
+double Eta(tResult*, int);
+int    CopyNodes(tResult*, int, int*);
+tElementType TypeOfElement(tResult*, int);
+int    NodesOfElement(tResult*, int);
+tPatch PatchOfEdge(tResult*, int, int);
 
 #endif
@@ -0,0 +1,578 @@
+/*
+** Function Probe
+** Interpolates the wall distance and the Jacobian to the points of a
+** probe file, using the element index below.
+**
+** In:       char    probeFileName = file with one point "x y" per line
+**           tResult Result        = structure containing Results
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.prb: per point x, y, the containing element (-1
+**                        outside the grid), its four weights and the
+**                        interpolated wall distance and Jacobian.
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "locate.h"
+
+int Probe(FILE *log, char *probeFileName, tResult *Result)
+{
+	FILE   *probeFile = NULL;
+	FILE   *dataFile  = NULL;
+
+	int    ret;
+	int    p, numPoints, numOutside;
+	char   line[100];
+	double xProbe, yProbe;
+
+	int    *element      = NULL;
+	double *x            = NULL;
+	double *y            = NULL;
+	double *weight       = NULL;
+	double *wallDistance = NULL;
+	double *jac          = NULL;
+
+	tElementIndex Index = {0, 0, 0, 0, 0, 0, NULL, NULL};
+
+	printf("Probing...\n");
+
+	ret        = 0;
+	numPoints  = 0;
+	numOutside = 0;
+
+	probeFile = fopen(probeFileName, "r");
+
+	if (probeFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function Probe: Could not open '%s'.\n", probeFileName);
+		ret = -1;
+	}
+	else
+	{
+		/* Count the points */
+		while (fgets(line, 100, probeFile) != NULL)
+			if (line[0] != '#' && sscanf(line, "%lf %lf", &xProbe, &yProbe) == 2)
+				numPoints++;
+
+		rewind(probeFile);
+	}
+
+	if (ret != -1)
+	{
+		x            = (double*)malloc((numPoints > 0 ? numPoints : 1)*sizeof(double));
+		y            = (double*)malloc((numPoints > 0 ? numPoints : 1)*sizeof(double));
+		element      = (int*)malloc((numPoints > 0 ? numPoints : 1)*sizeof(int));
+		weight       = (double*)malloc((numPoints > 0 ? 4*numPoints : 1)*sizeof(double));
+		wallDistance = (double*)malloc((numPoints > 0 ? numPoints : 1)*sizeof(double));
+		jac          = (double*)malloc((numPoints > 0 ? numPoints : 1)*sizeof(double));
+
+		if (x == NULL || y == NULL || element == NULL || weight == NULL || wallDistance == NULL || jac == NULL)
+		{
+			fprintf(stderr, "ERROR in function Probe: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(p=0; p<numPoints && fgets(line, 100, probeFile) != NULL; )
+			if (line[0] != '#' && sscanf(line, "%lf %lf", &x[p], &y[p]) == 2)
+				p++;
+
+		numPoints = p;
+
+		ret = BuildElementIndex(&(*log), &(*Result), &Index);
+	}
+
+	if (ret != -1)
+	{
+		LocatePoints(&(*Result), &Index, numPoints, x, y, element, weight);
+
+		if (Result->wallDistance != NULL)
+			TransferField(&(*Result), &Index, Result->wallDistance, numPoints, x, y, element, weight, wallDistance);
+
+		TransferField(&(*Result), &Index, Result->jac, numPoints, x, y, element, weight, jac);
+
+		dataFile = fopen("gridgen.prb", "w");
+
+		if (dataFile == NULL)
+		{
+			fprintf(stderr, "ERROR in function Probe: Could not open 'gridgen.prb'.\n");
+			ret = -1;
+		}
+		else
+		{
+			fprintf(dataFile, "#        X          Y  Element         W1         W2         W3         W4 WallDistance   Jacobian\n");
+			for(p=0; p<numPoints; p++)
+			{
+				fprintf(dataFile, "%10.6f %10.6f %8d %10.6f %10.6f %10.6f %10.6f   %10.6f %10.6f\n", x[p], y[p], element[p],
+				        weight[4*p], weight[4*p+1], weight[4*p+2], weight[4*p+3],
+				        (Result->wallDistance != NULL ? wallDistance[p] : 0), jac[p]);
+
+				numOutside += (element[p] == -1);
+			}
+
+			fclose(dataFile);
+		}
+	}
+
+	printf("Number of probes     = %d (%d outside the grid)\n", numPoints, numOutside);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION PROBE *****\n\n");
+
+		fprintf(log, "number of probes     = %d\n", numPoints);
+		fprintf(log, "outside the grid     = %d\n", numOutside);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	/* Free allocated memory */
+	FreeElementIndex(&Index);
+
+	if (probeFile)
+		fclose(probeFile);
+
+	if (x)
+		free(x);
+
+	if (y)
+		free(y);
+
+	if (element)
+		free(element);
+
+	if (weight)
+		free(weight);
+
+	if (wallDistance)
+		free(wallDistance);
+
+	if (jac)
+		free(jac);
+
+	return ret;
+}
+
+/*
+** Function BuildElementIndex
+** Builds a uniform grid of buckets over the grid, with about one
+** element per bucket; every bucket lists the elements whose bounding
+** box overlaps it.
+**
+** In:       tResult       Result = structure containing Results
+**
+** Out:      tElementIndex Index  = the buckets
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int BuildElementIndex(FILE *log, tResult *Result, tElementIndex *Index)
+{
+	int    ret;
+	int    e, k, n, i, j;
+	int    iMin, iMax, jMin, jMax;
+	int    numBuckets, numEntries;
+	double xMax, yMax;
+
+	ret = 0;
+
+	/* Bounding box of the grid */
+	Index->xMin = xMax = Result->x[0];
+	Index->yMin = yMax = Result->y[0];
+	for(n=1; n<Result->numNodes; n++)
+	{
+		Index->xMin = fmin(Index->xMin, Result->x[n]);
+		Index->yMin = fmin(Index->yMin, Result->y[n]);
+		xMax        = fmax(xMax, Result->x[n]);
+		yMax        = fmax(yMax, Result->y[n]);
+	}
+
+	/* About square buckets, one element each */
+	Index->numX = (int)sqrt(Result->numElements*(xMax - Index->xMin)/(yMax - Index->yMin + SMALL));
+	Index->numX = (Index->numX < 1 ? 1 : Index->numX);
+	Index->numY = Result->numElements/Index->numX;
+	Index->numY = (Index->numY < 1 ? 1 : Index->numY);
+	Index->dx   = (xMax - Index->xMin)/Index->numX + SMALL;
+	Index->dy   = (yMax - Index->yMin)/Index->numY + SMALL;
+
+	numBuckets = Index->numX*Index->numY;
+
+	Index->start = (int*)calloc(numBuckets+1, sizeof(int));
+
+	if (Index->start == NULL)
+	{
+		fprintf(stderr, "ERROR in function BuildElementIndex: Could not allocate memory.\n");
+		return -1;
+	}
+
+	/* Count, then fill the elements of each bucket */
+	for(k=0; k<2 && ret != -1; k++)
+	{
+		for(e=0; e<Result->numElements; e++)
+		{
+			ElementBuckets(&(*Result), &(*Index), e, &iMin, &iMax, &jMin, &jMax);
+
+			for(j=jMin; j<=jMax; j++)
+				for(i=iMin; i<=iMax; i++)
+					if (k == 0)
+						Index->start[j*Index->numX+i+1]++;
+					else
+						Index->element[Index->start[j*Index->numX+i]++] = e;
+		}
+
+		if (k == 0)
+		{
+			for(n=0; n<numBuckets; n++)
+				Index->start[n+1] += Index->start[n];
+
+			numEntries     = Index->start[numBuckets];
+			Index->element = (int*)malloc((numEntries > 0 ? numEntries : 1)*sizeof(int));
+
+			if (Index->element == NULL)
+			{
+				fprintf(stderr, "ERROR in function BuildElementIndex: Could not allocate memory.\n");
+				ret = -1;
+			}
+		}
+		else
+		{
+			for(n=numBuckets; n>0; n--)
+				Index->start[n] = Index->start[n-1];
+			Index->start[0] = 0;
+		}
+	}
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION BUILDELEMENTINDEX *****\n\n");
+
+		fprintf(log, "buckets              = %d x %d\n", Index->numX, Index->numY);
+		fprintf(log, "entries              = %d\n", Index->start[numBuckets]);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function ElementBuckets
+** Returns the range of buckets overlapped by the bounding box of
+** element e.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int ElementBuckets(tResult *Result, tElementIndex *Index, int e, int *iMin, int *iMax, int *jMin, int *jMax)
+{
+	int    k;
+	int    node[4];
+	double xMin, xMax, yMin, yMax;
+
+	CopyNodes(&(*Result), e, node);
+
+	xMin = xMax = Result->x[node[0]];
+	yMin = yMax = Result->y[node[0]];
+	for(k=1; k<NodesOfElement(&(*Result), e); k++)
+	{
+		xMin = fmin(xMin, Result->x[node[k]]);
+		xMax = fmax(xMax, Result->x[node[k]]);
+		yMin = fmin(yMin, Result->y[node[k]]);
+		yMax = fmax(yMax, Result->y[node[k]]);
+	}
+
+	*iMin = BucketOf(xMin, Index->xMin, Index->dx, Index->numX);
+	*iMax = BucketOf(xMax, Index->xMin, Index->dx, Index->numX);
+	*jMin = BucketOf(yMin, Index->yMin, Index->dy, Index->numY);
+	*jMax = BucketOf(yMax, Index->yMin, Index->dy, Index->numY);
+
+	return 0;
+}
+
+/*
+** Function BucketOf
+** Returns the bucket of co-ordinate x in one direction, clamped to the
+** index.
+**
+** Author:   J.L. Klaufus
+*/
+
+int BucketOf(double x, double xMin, double dx, int num)
+{
+	int i = (int)floor((x - xMin)/dx);
+
+	return (i < 0 ? 0 : (i > num-1 ? num-1 : i));
+}
+
+/*
+** Function FreeElementIndex
+** Frees the arrays of an element index.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeElementIndex(tElementIndex *Index)
+{
+	if (Index->start)
+		free(Index->start);
+
+	if (Index->element)
+		free(Index->element);
+
+	Index->start   = NULL;
+	Index->element = NULL;
+
+	return 0;
+}
+
+/*
+** Function LocatePoints
+** Finds for every point the element containing it, and the weights of
+** the nodes of that element: barycentric for triangles, bilinear for
+** quadrangles; the fourth weight of a triangle is 0. Points outside the
+** grid get element -1. The index is only read, so the points are
+** located in parallel.
+**
+** In:       tResult       Result = structure containing Results
+**           tElementIndex Index  = the buckets
+**           int           num    = number of points
+**           double        x, y   = the points
+**
+** Out:      int           element = containing element of every point
+**           double        weight  = four weights per point
+**
+** Return:   number of points outside the grid
+**
+** Author:   J.L. Klaufus
+*/
+
+int LocatePoints(tResult *Result, tElementIndex *Index, int num, double *x, double *y, int *element, double *weight)
+{
+	int    p, b, m, numOutside;
+
+	numOutside = 0;
+
+	#pragma omp parallel for private(b, m) reduction(+:numOutside)
+	for(p=0; p<num; p++)
+	{
+		element[p] = -1;
+
+		b = BucketOf(y[p], Index->yMin, Index->dy, Index->numY)*Index->numX +
+		    BucketOf(x[p], Index->xMin, Index->dx, Index->numX);
+
+		for(m=Index->start[b]; m<Index->start[b+1] && element[p] == -1; m++)
+			if (ElementWeights(&(*Result), Index->element[m], x[p], y[p], &weight[4*p]))
+				element[p] = Index->element[m];
+
+		if (element[p] == -1)
+		{
+			weight[4*p] = weight[4*p+1] = weight[4*p+2] = weight[4*p+3] = 0;
+			numOutside++;
+		}
+	}
+
+	return numOutside;
+}
+
+/*
+** Function ElementWeights
+** Calculates the weights of the nodes of element e at point (x,y). The
+** bilinear co-ordinates (s,t) of a quadrangle follow by Newton
+** iteration.
+**
+** Out:      double  weight = weights of the nodes of e
+**
+** Return:   1 if the point lies in element e, 0 otherwise
+**
+** Author:   J.L. Klaufus
+*/
+
+int ElementWeights(tResult *Result, int e, double x, double y, double *weight)
+{
+	int    k, iter;
+	int    node[4];
+	double xe[4], ye[4];
+	double area, s, t, fx, fy, xs, xt, ys, yt, det, ds, dt;
+
+	CopyNodes(&(*Result), e, node);
+
+	for(k=0; k<NodesOfElement(&(*Result), e); k++)
+	{
+		xe[k] = Result->x[node[k]];
+		ye[k] = Result->y[node[k]];
+	}
+
+	if (TypeOfElement(&(*Result), e) == etTriangle)
+	{
+		area = (xe[1]-xe[0])*(ye[2]-ye[0]) - (xe[2]-xe[0])*(ye[1]-ye[0]);
+
+		if (area == 0)
+			return 0;
+
+		weight[0] = ((xe[1]-x)*(ye[2]-y) - (xe[2]-x)*(ye[1]-y))/area;
+		weight[1] = ((xe[2]-x)*(ye[0]-y) - (xe[0]-x)*(ye[2]-y))/area;
+		weight[2] = 1 - weight[0] - weight[1];
+		weight[3] = 0;
+
+		return (weight[0] >= -SMALL && weight[1] >= -SMALL && weight[2] >= -SMALL);
+	}
+
+	/* x(s,t) = (1-s)(1-t) x0 + s(1-t) x1 + st x2 + (1-s)t x3 */
+	s = 0.5;
+	t = 0.5;
+	for(iter=0; iter<20; iter++)
+	{
+		fx = (1-s)*(1-t)*xe[0] + s*(1-t)*xe[1] + s*t*xe[2] + (1-s)*t*xe[3] - x;
+		fy = (1-s)*(1-t)*ye[0] + s*(1-t)*ye[1] + s*t*ye[2] + (1-s)*t*ye[3] - y;
+
+		xs = (1-t)*(xe[1]-xe[0]) + t*(xe[2]-xe[3]);
+		ys = (1-t)*(ye[1]-ye[0]) + t*(ye[2]-ye[3]);
+		xt = (1-s)*(xe[3]-xe[0]) + s*(xe[2]-xe[1]);
+		yt = (1-s)*(ye[3]-ye[0]) + s*(ye[2]-ye[1]);
+
+		det = xs*yt - xt*ys;
+
+		if (det == 0)
+			return 0;
+
+		ds = ( yt*fx - xt*fy)/det;
+		dt = (-ys*fx + xs*fy)/det;
+
+		s -= ds;
+		t -= dt;
+
+		if (fabs(ds) + fabs(dt) < SMALLITER)
+			break;
+	}
+
+	weight[0] = (1-s)*(1-t);
+	weight[1] = s*(1-t);
+	weight[2] = s*t;
+	weight[3] = (1-s)*t;
+
+	return (s >= -SMALL && s <= 1+SMALL && t >= -SMALL && t <= 1+SMALL);
+}
+
+/*
+** Function TransferField
+** Interpolates a nodal field of the grid to a set of points located by
+** LocatePoints. A point outside the grid takes the value of the
+** nearest node of the elements in the nearest non-empty buckets.
+**
+** In:       tResult       Result   = structure containing Results
+**           tElementIndex Index    = the buckets
+**           double        field    = nodal field of the grid
+**           int           num      = number of points
+**           double        x, y     = the points
+**           int           element  = containing element of every point
+**           double        weight   = four weights per point
+**
+** Out:      double        value    = field at the points
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int TransferField(tResult *Result, tElementIndex *Index, double *field, int num, double *x, double *y, int *element, double *weight, double *value)
+{
+	int    p, k;
+	int    node[4];
+
+	#pragma omp parallel for private(k, node)
+	for(p=0; p<num; p++)
+	{
+		if (element[p] != -1)
+		{
+			CopyNodes(&(*Result), element[p], node);
+
+			value[p] = 0;
+			for(k=0; k<NodesOfElement(&(*Result), element[p]); k++)
+				value[p] += weight[4*p+k]*field[node[k]];
+		}
+		else
+		{
+			value[p] = field[NearestNode(&(*Result), &(*Index), x[p], y[p])];
+		}
+	}
+
+	return 0;
+}
+
+/*
+** Function NearestNode
+** Returns the node nearest to point (x,y) among the elements of the
+** buckets around it: rings of buckets are searched outwards from the
+** bucket of the point until a node is found, and one ring further.
+**
+** Author:   J.L. Klaufus
+*/
+
+int NearestNode(tResult *Result, tElementIndex *Index, double x, double y)
+{
+	int    i0, j0, i, j, r, rFound, m, k;
+	int    nearest;
+	int    node[4];
+	double distance, nearestDistance;
+
+	i0 = BucketOf(x, Index->xMin, Index->dx, Index->numX);
+	j0 = BucketOf(y, Index->yMin, Index->dy, Index->numY);
+
+	nearest         = -1;
+	nearestDistance = 0;
+	rFound          = -1;
+
+	for(r=0; (rFound == -1 || r <= rFound+1) && (r < Index->numX || r < Index->numY); r++)
+	{
+		for(j=j0-r; j<=j0+r; j++)
+		{
+			for(i=i0-r; i<=i0+r; i++)
+			{
+				/* The ring only */
+				if (i < 0 || j < 0 || i >= Index->numX || j >= Index->numY || (abs(i-i0) < r && abs(j-j0) < r))
+					continue;
+
+				for(m=Index->start[j*Index->numX+i]; m<Index->start[j*Index->numX+i+1]; m++)
+				{
+					CopyNodes(&(*Result), Index->element[m], node);
+
+					for(k=0; k<NodesOfElement(&(*Result), Index->element[m]); k++)
+					{
+						distance = pow(Result->x[node[k]]-x, 2) + pow(Result->y[node[k]]-y, 2);
+
+						if (nearest == -1 || distance < nearestDistance)
+						{
+							nearest         = node[k];
+							nearestDistance = distance;
+						}
+					}
+				}
+			}
+		}
+
+		if (nearest != -1 && rFound == -1)
+			rFound = r;
+	}
+
+	return nearest;
+}
@@ -0,0 +1,27 @@
+/*
+** Header-file for Locate
+*/
+
+#ifndef LOCATE_H
+#define LOCATE_H
+
+typedef struct
+{
+	int    numX, numY;        /* buckets in x and y                          */
+	double xMin, yMin;
+	double dx, dy;            /* size of a bucket                            */
+	int    *start;            /* first entry of every bucket, numX*numY+1    */
+	int    *element;          /* elements overlapping each bucket            */
+} tElementIndex;
+
+int Probe(FILE*, char*, tResult*);
+int BuildElementIndex(FILE*, tResult*, tElementIndex*);
+int ElementBuckets(tResult*, tElementIndex*, int, int*, int*, int*, int*);
+int BucketOf(double, double, double, int);
+int FreeElementIndex(tElementIndex*);
+int LocatePoints(tResult*, tElementIndex*, int, double*, double*, int*, double*);
+int ElementWeights(tResult*, int, double, double, double*);
+int TransferField(tResult*, tElementIndex*, double*, int, double*, double*, int*, double*, double*);
+int NearestNode(tResult*, tElementIndex*, double, double);
+
+#endif
@@ -14,10 +14,12 @@
 
 #include "gridgen.h"
 #include "memory.h"
+#include "spline.h"
 
 int Initialise(FILE *log, tData *Data, tResult *Result)
 {
 	int ret;
+	int n;
 
 	printf("Initialising...\n");
 
@@ -26,11 +28,15 @@ int Initialise(FILE *log, tData *Data, tResult *Result)
 	Result->im = Data->numNodes1 + 2*Data->numNodes2;
 	Result->jm = Data->numNodes3;
 
+	Result->numNodes = Result->im*Result->jm;
+
 	Result->xNode = (double*)malloc(Result->im*sizeof(double));
 	Result->yNode = (double*)malloc(Result->im*sizeof(double));
 
-	Result->ksi = (double*)malloc((Result->im*Result->jm)*sizeof(double));
-	Result->eta = (double*)malloc((Result->im*Result->jm)*sizeof(double));
+	Result->xNodeMid = (double*)malloc(Result->im*sizeof(double));
+	Result->yNodeMid = (double*)malloc(Result->im*sizeof(double));
+
+	Result->vNode    = (double*)malloc(Result->im*sizeof(double));
 
 	Result->xKsi    = (double*)malloc((Result->im*Result->jm)*sizeof(double));
 	Result->xEta    = (double*)malloc((Result->im*Result->jm)*sizeof(double));
@@ -54,10 +60,38 @@ int Initialise(FILE *log, tData *Data, tResult *Result)
 	Result->x = (double*)malloc((Result->im*Result->jm)*sizeof(double));
 	Result->y = (double*)malloc((Result->im*Result->jm)*sizeof(double));
 
+	Result->spline.numKnots = 0; /* Will be allocated in Spline */
+	Result->spline.u        = NULL;
+	Result->spline.x        = NULL;
+	Result->spline.y        = NULL;
+	Result->spline.xSecond  = NULL;
+	Result->spline.ySecond  = NULL;
+	Result->spline.arcLength = NULL;
+
+	Result->patch        = (tPatch*)calloc(Result->im*Result->jm, sizeof(tPatch)); /* ptInterior */
+	Result->periodicNode = (int*)malloc((Result->im*Result->jm)*sizeof(int));
+
+	Result->structuredElements = 0;
 	Result->element = NULL; /* Will be allocated later */
+	Result->elementTypes = NULL;
+
+	Result->elementalArea = NULL; /* Will be allocated in Quality */
+	Result->aspectRatio   = NULL;
+	Result->skewness      = NULL;
+	Result->minimumAngle  = NULL;
+
+	Result->nodeNumber    = NULL; /* Will be allocated in Renumber */
+	Result->wallDistance  = NULL; /* Will be allocated in WallDistance */
+
+	Result->numQuadraticNodes    = 0; /* Will be allocated in Quadratic */
+	Result->xQuadratic           = NULL;
+	Result->yQuadratic           = NULL;
+	Result->numQuadraticElements = 0;
+	Result->quadraticElement     = NULL;
+	Result->quadraticTypes       = NULL;
 
 	if((Result->xNode == NULL)   || (Result->yNode == NULL)    ||
-	   (Result->ksi == NULL)     || (Result->eta == NULL)      ||
+	   (Result->xNodeMid == NULL) || (Result->yNodeMid == NULL) || (Result->vNode == NULL) ||
 	   (Result->xKsi == NULL)    || (Result->xEta == NULL)     ||
 	   (Result->yKsi == NULL)    || (Result->yEta == NULL)     ||
 	   (Result->xKsiKsi == NULL) || (Result->xEtaEta == NULL)  || (Result->xKsiEta == NULL) ||
@@ -65,13 +99,20 @@ int Initialise(FILE *log, tData *Data, tResult *Result)
 	   (Result->ksiX == NULL)    || (Result->ksiY == NULL)     ||
 	   (Result->etaX == NULL)    || (Result->etaY == NULL)     ||
 	   (Result->jac == NULL)     ||
-	   (Result->x == NULL)       || (Result->y == NULL)) 
+	   (Result->x == NULL)       || (Result->y == NULL)        ||
+	   (Result->patch == NULL)   || (Result->periodicNode == NULL))
 	{
 		if (log)
 			fprintf(log, "ERROR in function Prepare: could not allocate memory...\n");
 
 		ret = -1;
 	}
+	else
+	{
+		/* Paired across the cut by MakeCut */
+		for(n=0; n<Result->numNodes; n++)
+			Result->periodicNode[n] = -1;
+	}
 
 	return ret;
 }
@@ -101,9 +142,11 @@ int Finish(tData *Data, tResult *Result)
 
 	free(Result->xNode);
 	free(Result->yNode);
+	free(Result->xNodeMid);
+	free(Result->yNodeMid);
+	free(Result->vNode);
 
-	free(Result->ksi);
-	free(Result->eta);
+	FreeSpline(&Result->spline);
 
 	free(Result->xKsi);
 	free(Result->xEta);
@@ -127,6 +170,23 @@ int Finish(tData *Data, tResult *Result)
 	free(Result->y);
 
 	free(Result->element);
+	free(Result->elementTypes);
+
+	free(Result->elementalArea);
+	free(Result->aspectRatio);
+	free(Result->skewness);
+	free(Result->minimumAngle);
+
+	free(Result->nodeNumber);
+	free(Result->wallDistance);
+
+	free(Result->xQuadratic);
+	free(Result->yQuadratic);
+	free(Result->quadraticElement);
+	free(Result->quadraticTypes);
+
+	free(Result->patch);
+	free(Result->periodicNode);
 
 	return ret;
 }
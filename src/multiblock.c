@@ -0,0 +1,938 @@
+/*
+** Function Multiblock
+** Builds a multiblock grid from a block file, for geometries the single
+** C-grid cannot follow, like the slat, main aerofoil and flap of a
+** multi-element aerofoil. Every block is a structured grid of its own;
+** its sides are curves or interfaces with a side of another block. The
+** blocks are interpolated and smoothed concurrently, exchanging the
+** nodes on the interfaces after every sweep.
+**
+** In:       char   blockFileName = name of the block file
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: the block file, see ReadBlockFile
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "multiblock.h"
+#include "cursor.h"
+#include "halfedge.h"
+#include "data.h"
+#include "interpolate.h"
+#include "loc.h"
+#include "stretch.h"
+
+int Multiblock(FILE *log, char *blockFileName)
+{
+	int    ret;
+	int    b;
+	int    i, j;
+	int    numInverted, numCells;
+
+	double area, areaSum;
+
+	tMultiblock Multiblock = {0, 0, NULL, NULL, NULL, NULL, NULL, NULL};
+
+	printf("Building multiblock grid...\n");
+
+	ret = 0;
+
+	/* Read the blocks and distribute the nodes on their curves */
+	if (ret != -1)
+		ret = ReadBlockFile(&(*log), blockFileName, &Multiblock);
+
+	/* Copy the nodes over the interfaces into the blocks */
+	if (ret != -1)
+		ret = ConnectBlocks(&(*log), &Multiblock);
+
+	/* Interpolate all blocks at once */
+	if (ret != -1)
+	{
+		#pragma omp parallel for schedule(dynamic)
+		for(b=0; b<Multiblock.numBlocks; b++)
+			Interpolate(NULL, &(Multiblock.block[b]));
+	}
+
+	/* Smooth them, the interfaces included */
+	if (ret != -1 && Multiblock.omega > SMALL)
+		ret = SmoothBlocks(&(*log), &Multiblock);
+
+	/* Every block should keep the orientation of most of its cells */
+	for(b=0; b<Multiblock.numBlocks && ret != -1; b++)
+	{
+		numInverted = 0;
+		numCells    = (Multiblock.block[b].im - 1)*(Multiblock.block[b].jm - 1);
+		areaSum     = 0;
+
+		for(j=0; j<Multiblock.block[b].jm-1; j++)
+			for(i=0; i<Multiblock.block[b].im-1; i++)
+				areaSum += BlockCellArea(&(Multiblock.block[b]), j, i);
+
+		for(j=0; j<Multiblock.block[b].jm-1; j++)
+		{
+			for(i=0; i<Multiblock.block[b].im-1; i++)
+			{
+				area = BlockCellArea(&(Multiblock.block[b]), j, i);
+				if (area*areaSum <= 0)
+					numInverted++;
+			}
+		}
+
+		if (numInverted > 0)
+			fprintf(stderr, "WARNING in function Multiblock: %d of %d cells of block %d are inverted.\n",
+			        numInverted, numCells, b);
+
+		if (log)
+			fprintf(log, "block %3d: %4d x %4d nodes, %d inverted cells\n",
+			        b, Multiblock.block[b].im, Multiblock.block[b].jm, numInverted);
+	}
+
+	/* Write the blocks and their interfaces */
+	if (ret != -1)
+		ret = WriteBlockData(&(*log), &Multiblock);
+
+	FreeBlocks(&Multiblock);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION MULTIBLOCK *****\n\n");
+
+		if (ret != -1)
+			fprintf(log, "Succesfully built %d blocks.\n", Multiblock.numBlocks);
+		else
+			fprintf(log, "NOT succesfully built the blocks.\n");
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function ReadBlockFile
+** Reads the block file:
+**
+**   numBlocks omega
+**
+** then for every block its numbers of nodes "im jm" and its four sides
+** j = 0, i = im-1, j = jm-1 and i = 0, each running with increasing i
+** or j, as one of
+**
+**   c numPoints first last      a curve through numPoints lines "x y",
+**                               with first and last spacing, 0: free
+**   b block side reversed       an interface with a side of a block,
+**                               reversed 1 if that runs the other way
+**
+** The nodes on the curves are distributed by Vinokur's stretching
+** function, uniformly without spacings.
+**
+** In:       char        blockFileName = name of the block file
+**
+** Out:      tMultiblock Multiblock    = the blocks and their sides
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ReadBlockFile(FILE *log, char *blockFileName, tMultiblock *Multiblock)
+{
+	int    ret;
+	int    b, s, n, p;
+	int    numPoints;
+
+	char   type;
+
+	double first, last;
+	double *xPoint = NULL, *yPoint = NULL;
+
+	FILE   *blockFile = NULL;
+
+	printf("Reading blocks...\n");
+
+	ret = 0;
+
+	blockFile = fopen(blockFileName, "r");
+	if (blockFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadBlockFile: Could not open '%s'.\n", blockFileName);
+		return -1;
+	}
+
+	if (fscanf(blockFile, "%d %lf", &(Multiblock->numBlocks), &(Multiblock->omega)) != 2 || Multiblock->numBlocks < 1)
+	{
+		fprintf(stderr, "ERROR in function ReadBlockFile: No blocks in '%s'.\n", blockFileName);
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		n = Multiblock->numBlocks;
+
+		Multiblock->block         = (tResult*)calloc(n, sizeof(tResult));
+		Multiblock->neighbour     = (int*)malloc(NUMSIDES*n*sizeof(int));
+		Multiblock->neighbourSide = (int*)malloc(NUMSIDES*n*sizeof(int));
+		Multiblock->reversed      = (int*)malloc(NUMSIDES*n*sizeof(int));
+		Multiblock->xSide         = (double**)calloc(NUMSIDES*n, sizeof(double*));
+		Multiblock->ySide         = (double**)calloc(NUMSIDES*n, sizeof(double*));
+
+		if ((Multiblock->block == NULL) || (Multiblock->neighbour == NULL) || (Multiblock->neighbourSide == NULL) ||
+		    (Multiblock->reversed == NULL) || (Multiblock->xSide == NULL) || (Multiblock->ySide == NULL))
+		{
+			fprintf(stderr, "ERROR in function ReadBlockFile: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	for(b=0; b<Multiblock->numBlocks && ret != -1; b++)
+	{
+		if (fscanf(blockFile, "%d %d", &(Multiblock->block[b].im), &(Multiblock->block[b].jm)) != 2 ||
+		    Multiblock->block[b].im < 2 || Multiblock->block[b].jm < 2)
+		{
+			fprintf(stderr, "ERROR in function ReadBlockFile: Could not read the size of block %d.\n", b);
+			ret = -1;
+			break;
+		}
+
+		Multiblock->block[b].numNodes = Multiblock->block[b].im*Multiblock->block[b].jm;
+		Multiblock->block[b].x = (double*)malloc(Multiblock->block[b].numNodes*sizeof(double));
+		Multiblock->block[b].y = (double*)malloc(Multiblock->block[b].numNodes*sizeof(double));
+
+		if ((Multiblock->block[b].x == NULL) || (Multiblock->block[b].y == NULL))
+		{
+			fprintf(stderr, "ERROR in function ReadBlockFile: Could not allocate memory.\n");
+			ret = -1;
+		}
+
+		for(s=0; s<NUMSIDES && ret != -1; s++)
+		{
+			n = (s % 2 == 0 ? Multiblock->block[b].im : Multiblock->block[b].jm);
+
+			Multiblock->neighbour[NUMSIDES*b + s]     = -1;
+			Multiblock->neighbourSide[NUMSIDES*b + s] = -1;
+			Multiblock->reversed[NUMSIDES*b + s]      = 0;
+
+			if (fscanf(blockFile, " %c", &type) != 1)
+				type = ' ';
+
+			if (type == 'c' || type == 'C')
+			{
+				if (fscanf(blockFile, "%d %lf %lf", &numPoints, &first, &last) != 3 || numPoints < 2)
+				{
+					fprintf(stderr, "ERROR in function ReadBlockFile: Could not read side %d of block %d.\n", s, b);
+					ret = -1;
+					break;
+				}
+
+				xPoint = (double*)malloc(numPoints*sizeof(double));
+				yPoint = (double*)malloc(numPoints*sizeof(double));
+				Multiblock->xSide[NUMSIDES*b + s] = (double*)malloc(n*sizeof(double));
+				Multiblock->ySide[NUMSIDES*b + s] = (double*)malloc(n*sizeof(double));
+
+				if ((xPoint == NULL) || (yPoint == NULL) ||
+				    (Multiblock->xSide[NUMSIDES*b + s] == NULL) || (Multiblock->ySide[NUMSIDES*b + s] == NULL))
+				{
+					fprintf(stderr, "ERROR in function ReadBlockFile: Could not allocate memory.\n");
+					ret = -1;
+				}
+
+				for(p=0; p<numPoints && ret != -1; p++)
+				{
+					if (fscanf(blockFile, "%lf %lf", &xPoint[p], &yPoint[p]) != 2)
+					{
+						fprintf(stderr, "ERROR in function ReadBlockFile: Could not read side %d of block %d.\n", s, b);
+						ret = -1;
+					}
+				}
+
+				if (ret != -1)
+					ret = DistributeOnCurve(numPoints, xPoint, yPoint, n, first, last,
+					                        Multiblock->xSide[NUMSIDES*b + s], Multiblock->ySide[NUMSIDES*b + s]);
+
+				if (ret == -1)
+					fprintf(stderr, "ERROR in function ReadBlockFile: Could not distribute side %d of block %d.\n", s, b);
+
+				if (xPoint)
+					free(xPoint);
+				if (yPoint)
+					free(yPoint);
+				xPoint = yPoint = NULL;
+			}
+			else if (type == 'b' || type == 'B')
+			{
+				if (fscanf(blockFile, "%d %d %d", &(Multiblock->neighbour[NUMSIDES*b + s]),
+				           &(Multiblock->neighbourSide[NUMSIDES*b + s]), &(Multiblock->reversed[NUMSIDES*b + s])) != 3 ||
+				    Multiblock->neighbour[NUMSIDES*b + s] < 0 || Multiblock->neighbour[NUMSIDES*b + s] >= Multiblock->numBlocks ||
+				    Multiblock->neighbourSide[NUMSIDES*b + s] < 0 || Multiblock->neighbourSide[NUMSIDES*b + s] >= NUMSIDES)
+				{
+					fprintf(stderr, "ERROR in function ReadBlockFile: Could not read side %d of block %d.\n", s, b);
+					ret = -1;
+				}
+			}
+			else
+			{
+				fprintf(stderr, "ERROR in function ReadBlockFile: Unknown type of side %d of block %d.\n", s, b);
+				ret = -1;
+			}
+		}
+	}
+
+	fclose(blockFile);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION READBLOCKFILE *****\n\n");
+
+		fprintf(log, "number of blocks = %d\n", Multiblock->numBlocks);
+		fprintf(log, "omega            = %f\n\n", Multiblock->omega);
+
+		if (ret != -1)
+		{
+			fprintf(log, "block side neighbour side reversed\n");
+			for(b=0; b<Multiblock->numBlocks; b++)
+				for(s=0; s<NUMSIDES; s++)
+					fprintf(log, "%5d %4d %9d %4d %8d\n", b, s, Multiblock->neighbour[NUMSIDES*b + s],
+					        Multiblock->neighbourSide[NUMSIDES*b + s], Multiblock->reversed[NUMSIDES*b + s]);
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function DistributeOnCurve
+** Distributes nodes over the arc length of a polyline.
+**
+** In:       int    numPoints      = number of points of the polyline
+**           double xPoint, yPoint = its points
+**           int    numNodes       = number of nodes
+**           double first, last    = first and last spacing, 0: free
+**
+** Out:      double xSide, ySide   = the nodes
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int DistributeOnCurve(int numPoints, double *xPoint, double *yPoint, int numNodes, double first, double last, double *xSide, double *ySide)
+{
+	int    ret;
+	int    k, p;
+
+	double t;
+	double *arcLength = NULL;
+	double *sNode     = NULL;
+
+	ret = 0;
+
+	arcLength = (double*)malloc(numPoints*sizeof(double));
+	sNode     = (double*)malloc(numNodes*sizeof(double));
+
+	if ((arcLength == NULL) || (sNode == NULL))
+	{
+		fprintf(stderr, "ERROR in function DistributeOnCurve: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		arcLength[0] = 0;
+		for(p=1; p<numPoints; p++)
+			arcLength[p] = arcLength[p-1] + sqrt(pow(xPoint[p] - xPoint[p-1], 2) + pow(yPoint[p] - yPoint[p-1], 2));
+
+		if (arcLength[numPoints-1] < SMALL)
+			ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		if (first > 0 || last > 0)
+			ret = Stretch(NULL, 'V', numNodes, arcLength[numPoints-1], first, last, sNode);
+		else
+		{
+			for(k=0; k<numNodes; k++)
+				sNode[k] = arcLength[numPoints-1]*k/(numNodes - 1);
+		}
+	}
+
+	if (ret != -1)
+	{
+		p = 0;
+		for(k=0; k<numNodes; k++)
+		{
+			while ((p < numPoints-2) && (arcLength[p+1] < sNode[k]))
+				p++;
+
+			t = (sNode[k] - arcLength[p])/(arcLength[p+1] - arcLength[p]);
+
+			xSide[k] = (1 - t)*xPoint[p] + t*xPoint[p+1];
+			ySide[k] = (1 - t)*yPoint[p] + t*yPoint[p+1];
+		}
+
+		/* The ends of the curve exactly */
+		xSide[0]          = xPoint[0];
+		ySide[0]          = yPoint[0];
+		xSide[numNodes-1] = xPoint[numPoints-1];
+		ySide[numNodes-1] = yPoint[numPoints-1];
+	}
+
+	if (arcLength)
+		free(arcLength);
+	if (sNode)
+		free(sNode);
+
+	return ret;
+}
+
+/*
+** Function ConnectBlocks
+** Pairs the interfaces, copies the nodes of a curve over its
+** interfaces, checks that the sides of every block meet in its corners
+** and puts the sides in the blocks.
+**
+** In:       tMultiblock Multiblock = the blocks and their sides
+**
+** Out:      tMultiblock Multiblock = the blocks with their sides filled in
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ConnectBlocks(FILE *log, tMultiblock *Multiblock)
+{
+	int    ret;
+	int    b, s, k, n;
+	int    nb, ns, pass;
+	int    side, other;
+	int    numCopied;
+
+	double size, gap;
+
+	printf("Connecting blocks...\n");
+
+	ret  = 0;
+	size = 0;
+
+	/* Every interface from both sides, with the same number of nodes */
+	for(b=0; b<Multiblock->numBlocks && ret != -1; b++)
+	{
+		for(s=0; s<NUMSIDES && ret != -1; s++)
+		{
+			side = NUMSIDES*b + s;
+			nb   = Multiblock->neighbour[side];
+			ns   = Multiblock->neighbourSide[side];
+
+			if (nb == -1)
+				continue;
+
+			other = NUMSIDES*nb + ns;
+
+			if (Multiblock->neighbour[other] == -1)
+			{
+				Multiblock->neighbour[other]     = b;
+				Multiblock->neighbourSide[other] = s;
+				Multiblock->reversed[other]      = Multiblock->reversed[side];
+			}
+			else if ((Multiblock->neighbour[other] != b) || (Multiblock->neighbourSide[other] != s) ||
+			         (Multiblock->reversed[other] != Multiblock->reversed[side]) || (other == side))
+			{
+				fprintf(stderr, "ERROR in function ConnectBlocks: Side %d of block %d and side %d of block %d do not match.\n",
+				        s, b, ns, nb);
+				ret = -1;
+			}
+
+			if ((s % 2 == 0 ? Multiblock->block[b].im : Multiblock->block[b].jm) !=
+			    (ns % 2 == 0 ? Multiblock->block[nb].im : Multiblock->block[nb].jm))
+			{
+				fprintf(stderr, "ERROR in function ConnectBlocks: Side %d of block %d and side %d of block %d differ in nodes.\n",
+				        s, b, ns, nb);
+				ret = -1;
+			}
+		}
+	}
+
+	/* Copy the curves over the interfaces */
+	for(pass=0; pass<NUMSIDES*Multiblock->numBlocks && ret != -1; pass++)
+	{
+		numCopied = 0;
+
+		for(side=0; side<NUMSIDES*Multiblock->numBlocks && ret != -1; side++)
+		{
+			other = NUMSIDES*Multiblock->neighbour[side] + Multiblock->neighbourSide[side];
+
+			if ((Multiblock->xSide[side] != NULL) || (Multiblock->neighbour[side] == -1) || (Multiblock->xSide[other] == NULL))
+				continue;
+
+			b = side/NUMSIDES;
+			s = side % NUMSIDES;
+			n = (s % 2 == 0 ? Multiblock->block[b].im : Multiblock->block[b].jm);
+
+			Multiblock->xSide[side] = (double*)malloc(n*sizeof(double));
+			Multiblock->ySide[side] = (double*)malloc(n*sizeof(double));
+
+			if ((Multiblock->xSide[side] == NULL) || (Multiblock->ySide[side] == NULL))
+			{
+				fprintf(stderr, "ERROR in function ConnectBlocks: Could not allocate memory.\n");
+				ret = -1;
+				break;
+			}
+
+			for(k=0; k<n; k++)
+			{
+				Multiblock->xSide[side][k] = Multiblock->xSide[other][Multiblock->reversed[side] ? n-1-k : k];
+				Multiblock->ySide[side][k] = Multiblock->ySide[other][Multiblock->reversed[side] ? n-1-k : k];
+			}
+
+			numCopied++;
+		}
+
+		if (numCopied == 0)
+			break;
+	}
+
+	for(side=0; side<NUMSIDES*Multiblock->numBlocks && ret != -1; side++)
+	{
+		if (Multiblock->xSide[side] == NULL)
+		{
+			fprintf(stderr, "ERROR in function ConnectBlocks: No curve for side %d of block %d.\n",
+			        side % NUMSIDES, side/NUMSIDES);
+			ret = -1;
+		}
+	}
+
+	/* The sides meet in the corners, within SMALL of the size of the grid */
+	for(side=0; side<NUMSIDES*Multiblock->numBlocks && ret != -1; side++)
+	{
+		s = side % NUMSIDES;
+		n = (s % 2 == 0 ? Multiblock->block[side/NUMSIDES].im : Multiblock->block[side/NUMSIDES].jm);
+
+		for(k=0; k<n; k++)
+		{
+			size = (fabs(Multiblock->xSide[side][k]) > size ? fabs(Multiblock->xSide[side][k]) : size);
+			size = (fabs(Multiblock->ySide[side][k]) > size ? fabs(Multiblock->ySide[side][k]) : size);
+		}
+	}
+
+	for(b=0; b<Multiblock->numBlocks && ret != -1; b++)
+	{
+		for(s=0; s<NUMSIDES; s++)
+		{
+			/* The corner at the start of side s, with the end of the side before it */
+			side  = NUMSIDES*b + s;
+			other = NUMSIDES*b + (s + NUMSIDES - 1) % NUMSIDES;
+
+			k = (s % 2 == 0 ? Multiblock->block[b].im : Multiblock->block[b].jm) - 1;
+			n = (s % 2 == 0 ? Multiblock->block[b].jm : Multiblock->block[b].im) - 1;
+
+			/* Side 0 starts where 3 starts, 1 where 0 ends; 2 ends where 1 ends, 3 where 2 starts */
+			if (s == 0)
+				gap = sqrt(pow(Multiblock->xSide[side][0] - Multiblock->xSide[other][0], 2) +
+				           pow(Multiblock->ySide[side][0] - Multiblock->ySide[other][0], 2));
+			else if (s == 1)
+				gap = sqrt(pow(Multiblock->xSide[side][0] - Multiblock->xSide[other][n], 2) +
+				           pow(Multiblock->ySide[side][0] - Multiblock->ySide[other][n], 2));
+			else if (s == 2)
+				gap = sqrt(pow(Multiblock->xSide[side][k] - Multiblock->xSide[other][n], 2) +
+				           pow(Multiblock->ySide[side][k] - Multiblock->ySide[other][n], 2));
+			else
+				gap = sqrt(pow(Multiblock->xSide[side][k] - Multiblock->xSide[other][0], 2) +
+				           pow(Multiblock->ySide[side][k] - Multiblock->ySide[other][0], 2));
+
+			if (gap > SMALL*(1 + size))
+			{
+				fprintf(stderr, "ERROR in function ConnectBlocks: Sides %d and %d of block %d do not meet.\n",
+				        (s + NUMSIDES - 1) % NUMSIDES, s, b);
+				ret = -1;
+			}
+		}
+
+		/* Put the sides in the block */
+		for(s=0; s<NUMSIDES && ret != -1; s++)
+		{
+			side = NUMSIDES*b + s;
+			n    = (s % 2 == 0 ? Multiblock->block[b].im : Multiblock->block[b].jm);
+
+			for(k=0; k<n; k++)
+			{
+				Multiblock->block[b].x[SideLoc(&(Multiblock->block[b]), s, k, 0)] = Multiblock->xSide[side][k];
+				Multiblock->block[b].y[SideLoc(&(Multiblock->block[b]), s, k, 0)] = Multiblock->ySide[side][k];
+			}
+		}
+	}
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION CONNECTBLOCKS *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "size of the grid = %f\n\n", size);
+
+			fprintf(log, "block side          x          y\n");
+			for(side=0; side<NUMSIDES*Multiblock->numBlocks; side++)
+			{
+				s = side % NUMSIDES;
+				n = (s % 2 == 0 ? Multiblock->block[side/NUMSIDES].im : Multiblock->block[side/NUMSIDES].jm);
+
+				for(k=0; k<n; k++)
+					fprintf(log, "%5d %4d %10.6f %10.6f\n", side/NUMSIDES, s, Multiblock->xSide[side][k], Multiblock->ySide[side][k]);
+			}
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function SmoothBlocks
+** Smooths all blocks with the elliptic equations of Laplace, as
+** function Laplace does. Every iteration sweeps the blocks at the same
+** time, then moves each node inside an interface with the stencil of
+** the nodes next to it in both blocks, and copies it to both.
+**
+** In:       tMultiblock Multiblock = the interpolated blocks
+**
+** Out:      tMultiblock Multiblock = the smoothed blocks
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int SmoothBlocks(FILE *log, tMultiblock *Multiblock)
+{
+	int    ret;
+	int    b, s, k, n;
+	int    iter;
+	int    diverge;
+	int    side, other;
+
+	int    loc, loc_ksi_up, loc_ksi_down;
+	int    locA, locA_up, locA_down;
+	int    locB, locB_up, locB_down;
+	int    kB;
+
+	double resMax, resMin, res;
+	double xKsi, xEta, yKsi, yEta;
+	double alpha, beta, gamma;
+	double resX, resY;
+
+	tResult *blockA, *blockB;
+
+	fprintf(stderr, "Smoothing blocks... ");
+
+	ret    = 0;
+	resMax = SMALLITER;
+	resMin = 0;
+
+	diverge = 0;
+	iter    = 0;
+	while ((resMax >= SMALLITER) && (diverge == 0))
+	{
+		iter++;
+		resMax = 0;
+
+		/* Show cursor animation */
+		fprintf(stderr, "\b%c", Cursor(iter));
+
+		/* The blocks, each on its own */
+		#pragma omp parallel for schedule(dynamic) private(res) reduction(max:resMax)
+		for(b=0; b<Multiblock->numBlocks; b++)
+		{
+			res = SweepBlock(&(Multiblock->block[b]), Multiblock->omega);
+			if (res > resMax)
+				resMax = res;
+		}
+
+		/*
+		** The interfaces: in a stencil across side s of block A eta
+		** runs from the nodes of A to those of block B
+		*/
+		for(side=0; side<NUMSIDES*Multiblock->numBlocks; side++)
+		{
+			other = NUMSIDES*Multiblock->neighbour[side] + Multiblock->neighbourSide[side];
+
+			if ((Multiblock->neighbour[side] == -1) || (other < side))
+				continue;
+
+			blockA = &(Multiblock->block[side/NUMSIDES]);
+			blockB = &(Multiblock->block[other/NUMSIDES]);
+			s      = side % NUMSIDES;
+			n      = (s % 2 == 0 ? blockA->im : blockA->jm);
+
+			for(k=1; k<n-1; k++)
+			{
+				kB = (Multiblock->reversed[side] ? n-1-k : k);
+
+				loc          = SideLoc(blockA, s, k, 0);
+				loc_ksi_up   = SideLoc(blockA, s, k+1, 0);
+				loc_ksi_down = SideLoc(blockA, s, k-1, 0);
+				locA         = SideLoc(blockA, s, k, 1);
+				locA_up      = SideLoc(blockA, s, k+1, 1);
+				locA_down    = SideLoc(blockA, s, k-1, 1);
+				locB         = SideLoc(blockB, other % NUMSIDES, kB, 1);
+				locB_up      = SideLoc(blockB, other % NUMSIDES, (Multiblock->reversed[side] ? kB-1 : kB+1), 1);
+				locB_down    = SideLoc(blockB, other % NUMSIDES, (Multiblock->reversed[side] ? kB+1 : kB-1), 1);
+
+				xKsi  = (blockA->x[loc_ksi_up] - blockA->x[loc_ksi_down])/2;
+				yKsi  = (blockA->y[loc_ksi_up] - blockA->y[loc_ksi_down])/2;
+				xEta  = (blockB->x[locB] - blockA->x[locA])/2;
+				yEta  = (blockB->y[locB] - blockA->y[locA])/2;
+
+				alpha = xEta*xEta + yEta*yEta;
+				beta  = xKsi*xEta + yKsi*yEta;
+				gamma = xKsi*xKsi + yKsi*yKsi;
+
+				resX  = alpha*(blockA->x[loc_ksi_up] - 2*blockA->x[loc] + blockA->x[loc_ksi_down]) -
+				        2*beta*(blockB->x[locB_up] - blockB->x[locB_down] - blockA->x[locA_up] + blockA->x[locA_down])/4 +
+				        gamma*(blockB->x[locB] - 2*blockA->x[loc] + blockA->x[locA]);
+				resY  = alpha*(blockA->y[loc_ksi_up] - 2*blockA->y[loc] + blockA->y[loc_ksi_down]) -
+				        2*beta*(blockB->y[locB_up] - blockB->y[locB_down] - blockA->y[locA_up] + blockA->y[locA_down])/4 +
+				        gamma*(blockB->y[locB] - 2*blockA->y[loc] + blockA->y[locA]);
+
+				resMax = (fabs(resX) > resMax) ? fabs(resX) : resMax;
+				resMax = (fabs(resY) > resMax) ? fabs(resY) : resMax;
+
+				blockA->x[loc] += Multiblock->omega*resX/(2*(alpha + gamma));
+				blockA->y[loc] += Multiblock->omega*resY/(2*(alpha + gamma));
+
+				/* Exchange */
+				blockB->x[SideLoc(blockB, other % NUMSIDES, kB, 0)] = blockA->x[loc];
+				blockB->y[SideLoc(blockB, other % NUMSIDES, kB, 0)] = blockA->y[loc];
+			}
+		}
+
+		/*
+		** Check for convergence; the largest residue moves between the
+		** blocks and may rise for a while, so only a doubling diverges
+		*/
+		if ((iter == 1) || (resMax < resMin))
+			resMin = resMax;
+		else if (resMax > 2*resMin)
+			diverge = 1;
+	}
+
+	/* Print some information */
+	printf("\b \n");
+	if (diverge != 0)
+	{
+		printf("ERROR in function SmoothBlocks: Diverging...\n");
+		printf("Aborting operation...\n");
+		ret = -1;
+	}
+	printf("Maximum residue      = %f\n", resMax);
+	printf("Number of iterations = %d\n", iter);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION SMOOTHBLOCKS *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "SmoothBlocks successfully ended.\n");
+			fprintf(log, "Number of iterations: %d\n", iter);
+		}
+		else
+		{
+			fprintf(log, "SmoothBlocks NOT successfully ended.\n");
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function SweepBlock
+** One Gauss-Seidel sweep of the Laplace equations over the interior
+** nodes of a block.
+**
+** In:       tResult Block = the block
+**           double  omega = relaxation factor
+**
+** Out:      tResult Block = the block
+**
+** Return:   largest residue
+**
+** Author:   J.L. Klaufus
+*/
+
+double SweepBlock(tResult *Block, double omega)
+{
+	int    i, j;
+	int    loc;
+	int    loc_ksi_up, loc_ksi_down;
+	int    loc_eta_up, loc_eta_down;
+
+	double resMax;
+	double xKsi, xEta, yKsi, yEta;
+	double xKsiEta, yKsiEta;
+	double alpha, beta, gamma;
+	double resX, resY;
+
+	resMax = 0;
+
+	for(j=1; j<Block->jm-1; j++)
+	{
+		for(i=1; i<Block->im-1; i++)
+		{
+			loc          = Loc(&(*Block), j, i);
+			loc_ksi_up   = loc + 1;
+			loc_ksi_down = loc - 1;
+			loc_eta_up   = loc + Block->im;
+			loc_eta_down = loc - Block->im;
+
+			xKsi    = (Block->x[loc_ksi_up] - Block->x[loc_ksi_down])/2;
+			yKsi    = (Block->y[loc_ksi_up] - Block->y[loc_ksi_down])/2;
+			xEta    = (Block->x[loc_eta_up] - Block->x[loc_eta_down])/2;
+			yEta    = (Block->y[loc_eta_up] - Block->y[loc_eta_down])/2;
+			xKsiEta = (Block->x[loc_eta_up+1] - Block->x[loc_eta_down+1] - Block->x[loc_eta_up-1] + Block->x[loc_eta_down-1])/4;
+			yKsiEta = (Block->y[loc_eta_up+1] - Block->y[loc_eta_down+1] - Block->y[loc_eta_up-1] + Block->y[loc_eta_down-1])/4;
+
+			alpha = xEta*xEta + yEta*yEta;
+			beta  = xKsi*xEta + yKsi*yEta;
+			gamma = xKsi*xKsi + yKsi*yKsi;
+
+			resX  = alpha*(Block->x[loc_ksi_up] - 2*Block->x[loc] + Block->x[loc_ksi_down]) - 2*beta*xKsiEta +
+			        gamma*(Block->x[loc_eta_up] - 2*Block->x[loc] + Block->x[loc_eta_down]);
+			resY  = alpha*(Block->y[loc_ksi_up] - 2*Block->y[loc] + Block->y[loc_ksi_down]) - 2*beta*yKsiEta +
+			        gamma*(Block->y[loc_eta_up] - 2*Block->y[loc] + Block->y[loc_eta_down]);
+
+			resMax = (fabs(resX) > resMax) ? fabs(resX) : resMax;
+			resMax = (fabs(resY) > resMax) ? fabs(resY) : resMax;
+
+			Block->x[loc] += omega*resX/(2*(alpha + gamma));
+			Block->y[loc] += omega*resY/(2*(alpha + gamma));
+		}
+	}
+
+	return resMax;
+}
+
+/*
+** Function SideLoc
+** Position of a node of a side of a block, or of the row of nodes at a
+** given depth into the block.
+**
+** In:       tResult Block = the block
+**           int     side  = 0: j = 0, 1: i = im-1, 2: j = jm-1, 3: i = 0
+**           int     k     = node along the side, with increasing i or j
+**           int     depth = rows into the block
+**
+** Out:      -
+**
+** Return:   position in the arrays of the block; -1 on error
+**
+** Author:   J.L. Klaufus
+*/
+
+int SideLoc(tResult *Block, int side, int k, int depth)
+{
+	if (side == 0)
+		return Loc(&(*Block), depth, k);
+	else if (side == 1)
+		return Loc(&(*Block), k, Block->im-1-depth);
+	else if (side == 2)
+		return Loc(&(*Block), Block->jm-1-depth, k);
+	else if (side == 3)
+		return Loc(&(*Block), k, depth);
+
+	return -1;
+}
+
+/*
+** Function BlockCellArea
+** Signed area of cell (j,i) of a block, between nodes (j,i) and
+** (j+1,i+1).
+**
+** In:       tResult Block = the block
+**           int     j, i  = lower left node of the cell
+**
+** Out:      -
+**
+** Return:   area, positive if i, j turn counterclockwise
+**
+** Author:   J.L. Klaufus
+*/
+
+double BlockCellArea(tResult *Block, int j, int i)
+{
+	int    loc1, loc2, loc3, loc4;
+
+	loc1 = Loc(&(*Block), j, i);
+	loc2 = Loc(&(*Block), j, i+1);
+	loc3 = Loc(&(*Block), j+1, i+1);
+	loc4 = Loc(&(*Block), j+1, i);
+
+	return 0.5*((Block->x[loc3] - Block->x[loc1])*(Block->y[loc4] - Block->y[loc2]) -
+	            (Block->y[loc3] - Block->y[loc1])*(Block->x[loc4] - Block->x[loc2]));
+}
+
+/*
+** Function FreeBlocks
+** Clears the memory of the blocks.
+**
+** In:       tMultiblock Multiblock = the blocks
+**
+** Out:      -
+**
+** Return:   0
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeBlocks(tMultiblock *Multiblock)
+{
+	int    b;
+
+	for(b=0; b<NUMSIDES*Multiblock->numBlocks; b++)
+	{
+		if (Multiblock->xSide && Multiblock->xSide[b])
+			free(Multiblock->xSide[b]);
+		if (Multiblock->ySide && Multiblock->ySide[b])
+			free(Multiblock->ySide[b]);
+	}
+
+	for(b=0; b<Multiblock->numBlocks; b++)
+	{
+		if (Multiblock->block && Multiblock->block[b].x)
+			free(Multiblock->block[b].x);
+		if (Multiblock->block && Multiblock->block[b].y)
+			free(Multiblock->block[b].y);
+	}
+
+	if (Multiblock->block)
+		free(Multiblock->block);
+	if (Multiblock->neighbour)
+		free(Multiblock->neighbour);
+	if (Multiblock->neighbourSide)
+		free(Multiblock->neighbourSide);
+	if (Multiblock->reversed)
+		free(Multiblock->reversed);
+	if (Multiblock->xSide)
+		free(Multiblock->xSide);
+	if (Multiblock->ySide)
+		free(Multiblock->ySide);
+
+	return 0;
+}
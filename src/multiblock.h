@@ -0,0 +1,18 @@
+/*
+** Header-file for Multiblock
+*/
+
+#ifndef MULTIBLOCK_H
+#define MULTIBLOCK_H
+
+int    Multiblock(FILE*, char*);
+int    ReadBlockFile(FILE*, char*, tMultiblock*);
+int    DistributeOnCurve(int, double*, double*, int, double, double, double*, double*);
+int    ConnectBlocks(FILE*, tMultiblock*);
+int    SmoothBlocks(FILE*, tMultiblock*);
+double SweepBlock(tResult*, double);
+int    SideLoc(tResult*, int, int, int);
+double BlockCellArea(tResult*, int, int);
+int    FreeBlocks(tMultiblock*);
+
+#endif
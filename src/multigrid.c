@@ -0,0 +1,698 @@
+/*
+** Function Multigrid
+** Writes a nested hierarchy of numLevels coarse levels for multigrid
+** solvers. Structured grids are coarsened by removing every other grid
+** line (the last line is always kept); unstructured grids by greedy
+** agglomeration of the median dual control volumes, each seed taking
+** its free neighbours.
+**
+** Structured grids (gridgen.mg):
+**   structured L                  number of levels, the grid included
+**   level l im jm                 for l = 1..L-1:
+**   nodes n                         level 0 node of every coarse node
+**   quadrangles n                   coarse elements
+**   prolongation n                  per node of level l-1: the number of
+**                                   coarse nodes, then node and weight
+** Unstructured grids (gridgen.mg):
+**   agglomerated L
+**   level l n                     for l = 0..L-1:
+**   parents n                       (l > 0) agglomerate of every
+**                                   control volume of level l-1
+**   volumes n                       area of every control volume
+**   edges n                         from, to and the dual face normal,
+**                                   pointing from 'from' to 'to'
+** Restriction is the transpose of prolongation, or the sum over the
+** control volumes of an agglomerate.
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.mg: the coarse levels and the transfer maps.
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "multigrid.h"
+
+int Multigrid(FILE *log, tData *Data, tResult *Result)
+{
+	FILE   *mgFile = NULL;
+
+	int    ret;
+	int    l, numLevels;
+
+	tLevel *level = NULL;
+
+	printf("Creating multigrid levels...\n");
+
+	ret       = 0;
+	numLevels = 0;
+
+	mgFile = fopen("gridgen.mg", "w");
+	level  = (tLevel*)calloc(Data->numLevels+1, sizeof(tLevel));
+
+	if (mgFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function Multigrid: Could not open gridgen.mg.\n");
+		ret = -1;
+	}
+	else if (level == NULL)
+	{
+		fprintf(stderr, "ERROR in function Multigrid: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else if (Result->elementType == etQuadrangle)
+	{
+		ret = CoarsenStructured(mgFile, &(*Result), Data->numLevels, &numLevels);
+	}
+	else
+	{
+		/* Control volumes of the grid, then agglomerate until nothing is left */
+		ret       = DualGraph(&(*Result), &level[0]);
+		numLevels = 1;
+
+		for(l=1; l<=Data->numLevels && ret != -1; l++)
+		{
+			ret = Agglomerate(&level[l-1], &level[l]);
+
+			if (ret != -1 && (level[l].numNodes == level[l-1].numNodes || level[l].numNodes < 2))
+			{
+				FreeLevel(&level[l]);
+				free(level[l-1].parent);
+				level[l-1].parent = NULL;
+				break;
+			}
+
+			numLevels++;
+		}
+
+		if (ret != -1)
+		{
+			fprintf(mgFile, "agglomerated %d\n", numLevels);
+
+			for(l=0; l<numLevels; l++)
+				WriteLevel(mgFile, l, &level[l], (l > 0 ? &level[l-1] : NULL));
+		}
+
+		for(l=0; l<=Data->numLevels; l++)
+			FreeLevel(&level[l]);
+	}
+
+	if (mgFile)
+		fclose(mgFile);
+
+	if (level)
+		free(level);
+
+	printf("Number of levels     = %d\n", numLevels);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION MULTIGRID *****\n\n");
+
+		fprintf(log, "levels requested     = %d\n", Data->numLevels+1);
+		fprintf(log, "levels written       = %d\n", numLevels);
+		fprintf(log, "coarsening           = %s\n", (Result->elementType == etQuadrangle ? "structured" : "agglomerated"));
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function CoarsenStructured
+** Writes the structured coarse levels: every level keeps every other
+** grid line of the previous one, and always its last line. Coarsening
+** stops when a direction has fewer than three lines left.
+**
+** In:       tResult Result    = structure containing Results
+**           int     maxLevels = maximum number of coarse levels
+**
+** Out:      int     numLevels = number of levels, the grid included
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int CoarsenStructured(FILE *mgFile, tResult *Result, int maxLevels, int *numLevels)
+{
+	int    l, i, j, n, ic, jc, lattice;
+	int    numI, numJ, numFineI, numFineJ, numWeights;
+	int    nodeI[2], nodeJ[2];
+	double weightI[2], weightJ[2];
+
+	int    *lineI    = NULL;   /* level 0 lines of the current level   */
+	int    *lineJ    = NULL;
+	int    *fineI    = NULL;   /* level 0 lines of the previous level  */
+	int    *fineJ    = NULL;
+	int    *parentI  = NULL;   /* coarse interval of every fine line   */
+	int    *parentJ  = NULL;
+	double *tI       = NULL;   /* position in that interval            */
+	double *tJ       = NULL;
+
+	lineI   = (int*)malloc(Result->im*sizeof(int));
+	lineJ   = (int*)malloc(Result->jm*sizeof(int));
+	fineI   = (int*)malloc(Result->im*sizeof(int));
+	fineJ   = (int*)malloc(Result->jm*sizeof(int));
+	parentI = (int*)malloc(Result->im*sizeof(int));
+	parentJ = (int*)malloc(Result->jm*sizeof(int));
+	tI      = (double*)malloc(Result->im*sizeof(double));
+	tJ      = (double*)malloc(Result->jm*sizeof(double));
+
+	if (lineI == NULL || lineJ == NULL || fineI == NULL || fineJ == NULL ||
+	    parentI == NULL || parentJ == NULL || tI == NULL || tJ == NULL)
+	{
+		fprintf(stderr, "ERROR in function CoarsenStructured: Could not allocate memory.\n");
+		return -1;
+	}
+
+	/* Count the levels */
+	for(*numLevels=1, numI=Result->im, numJ=Result->jm; *numLevels<=maxLevels && numI>=3 && numJ>=3; (*numLevels)++)
+	{
+		numI = (numI-1)/2 + 1 + ((numI-1)%2);
+		numJ = (numJ-1)/2 + 1 + ((numJ-1)%2);
+	}
+
+	fprintf(mgFile, "structured %d\n", *numLevels);
+
+	for(i=0; i<Result->im; i++)
+		lineI[i] = i;
+
+	for(j=0; j<Result->jm; j++)
+		lineJ[j] = j;
+
+	numI = Result->im;
+	numJ = Result->jm;
+
+	for(l=1; l<*numLevels; l++)
+	{
+		/* Keep every other line and the last one */
+		for(i=0; i<numI; i++)
+			fineI[i] = lineI[i];
+
+		for(j=0; j<numJ; j++)
+			fineJ[j] = lineJ[j];
+
+		numFineI = numI;
+		numFineJ = numJ;
+
+		CoarsenLines(fineI, numFineI, lineI, &numI, parentI, tI);
+		CoarsenLines(fineJ, numFineJ, lineJ, &numJ, parentJ, tJ);
+
+		fprintf(mgFile, "level %d %d %d\n", l, numI, numJ);
+
+		/* Level 0 nodes of the coarse nodes */
+		fprintf(mgFile, "nodes %d\n", numI*numJ);
+		for(jc=0; jc<numJ; jc++)
+		{
+			for(ic=0; ic<numI; ic++)
+			{
+				lattice = Loc(&(*Result), lineJ[jc], lineI[ic]);
+				fprintf(mgFile, "\t%d\n", (Result->nodeNumber ? Result->nodeNumber[lattice] : lattice));
+			}
+		}
+
+		/* Coarse quadrangles: SE, SW, NW, NE */
+		fprintf(mgFile, "quadrangles %d\n", (numI-1)*(numJ-1));
+		for(jc=0; jc<numJ-1; jc++)
+			for(ic=0; ic<numI-1; ic++)
+				fprintf(mgFile, "\t%d %d %d %d\n", jc*numI+ic+1, jc*numI+ic, (jc+1)*numI+ic, (jc+1)*numI+ic+1);
+
+		/* Bilinear prolongation to the nodes of the previous level */
+		fprintf(mgFile, "prolongation %d\n", numFineI*numFineJ);
+		for(j=0; j<numFineJ; j++)
+		{
+			for(i=0; i<numFineI; i++)
+			{
+				nodeI[0] = parentI[i];    weightI[0] = 1 - tI[i];
+				nodeI[1] = parentI[i]+1;  weightI[1] = tI[i];
+				nodeJ[0] = parentJ[j];    weightJ[0] = 1 - tJ[j];
+				nodeJ[1] = parentJ[j]+1;  weightJ[1] = tJ[j];
+
+				for(n=0, numWeights=0; n<4; n++)
+					numWeights += (weightI[n%2] > 0 && weightJ[n/2] > 0);
+
+				fprintf(mgFile, "\t%d", numWeights);
+
+				for(n=0; n<4; n++)
+					if (weightI[n%2] > 0 && weightJ[n/2] > 0)
+						fprintf(mgFile, " %d %f", nodeJ[n/2]*numI + nodeI[n%2], weightI[n%2]*weightJ[n/2]);
+
+				fprintf(mgFile, "\n");
+			}
+		}
+	}
+
+	/* Free allocated memory */
+	free(lineI);
+	free(lineJ);
+	free(fineI);
+	free(fineJ);
+	free(parentI);
+	free(parentJ);
+	free(tI);
+	free(tJ);
+
+	return 0;
+}
+
+/*
+** Function CoarsenLines
+** Keeps every other line of a family of grid lines, and the last one.
+**
+** In:       int    fine       = fine lines
+**           int    numFine    = number of fine lines
+**
+** Out:      int    coarse     = coarse lines
+**           int    numCoarse  = number of coarse lines
+**           int    parent     = first coarse line of the interval
+**                               holding every fine line
+**           double t          = position of every fine line in its
+**                               interval, 0 <= t <= 1
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int CoarsenLines(int *fine, int numFine, int *coarse, int *numCoarse, int *parent, double *t)
+{
+	int    k, c;
+
+	*numCoarse = 0;
+	for(k=0; k<numFine; k++)
+		if (k%2 == 0 || k == numFine-1)
+			coarse[(*numCoarse)++] = fine[k];
+
+	for(k=0, c=0; k<numFine; k++)
+	{
+		if (c < *numCoarse-1 && fine[k] >= coarse[c+1])
+			c++;
+
+		if (c == *numCoarse-1)
+		{
+			/* The last line coincides */
+			parent[k] = c-1;
+			t[k]      = 1;
+		}
+		else
+		{
+			parent[k] = c;
+			t[k]      = (fine[k] == coarse[c] ? 0 : 0.5);
+		}
+	}
+
+	return 0;
+}
+
+/*
+** Function DualGraph
+** Sets up level 0 of an unstructured grid: the median dual control
+** volume of every node, and the edges with their dual face normals.
+** The dual face of an edge joins its middle to the centroids of its
+** elements.
+**
+** In:       tResult Result = structure containing Results
+**
+** Out:      tLevel  Level  = control volumes and edges
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int DualGraph(tResult *Result, tLevel *Level)
+{
+	int    ret;
+	int    e, k, h, a, b, n, numNodes;
+	int    node[4];
+
+	int    *edgeOf = NULL;
+
+	double area, xc, yc, nx, ny;
+
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
+	ret = BuildHalfEdges(NULL, &(*Result), &HalfEdge);
+
+	Level->numNodes = Result->numNodes;
+	Level->numEdges = 0;
+
+	edgeOf        = (int*)malloc((HalfEdge.numHalfEdges > 0 ? HalfEdge.numHalfEdges : 1)*sizeof(int));
+	Level->edge   = (int*)malloc((HalfEdge.numHalfEdges > 0 ? 2*HalfEdge.numHalfEdges : 1)*sizeof(int));
+	Level->normal = (double*)calloc((HalfEdge.numHalfEdges > 0 ? 2*HalfEdge.numHalfEdges : 1), sizeof(double));
+	Level->volume = (double*)calloc(Result->numNodes, sizeof(double));
+
+	if (ret == -1 || edgeOf == NULL || Level->edge == NULL || Level->normal == NULL || Level->volume == NULL)
+	{
+		fprintf(stderr, "ERROR in function DualGraph: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* One edge per pair of twins */
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+		{
+			edgeOf[h] = -1;
+
+			if (HalfEdge.origin[h] != -1 && (HalfEdge.twin[h] == -1 || HalfEdge.twin[h] > h))
+			{
+				Level->edge[2*Level->numEdges]   = HalfEdge.origin[h];
+				Level->edge[2*Level->numEdges+1] = HalfEdgeDest(&HalfEdge, h);
+				edgeOf[h] = Level->numEdges++;
+			}
+		}
+
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] != -1 && HalfEdge.twin[h] < h)
+				edgeOf[h] = edgeOf[HalfEdge.twin[h]];
+
+		for(e=0; e<Result->numElements; e++)
+		{
+			CopyNodes(&(*Result), e, node);
+			numNodes = NodesOfElement(&(*Result), e);
+
+			/* Area and centroid */
+			area = 0;
+			xc   = 0;
+			yc   = 0;
+			for(k=0; k<numNodes; k++)
+			{
+				a     = node[k];
+				b     = node[(k+1)%numNodes];
+				area += 0.5*(Result->x[a]*Result->y[b] - Result->x[b]*Result->y[a]);
+				xc   += Result->x[a]/numNodes;
+				yc   += Result->y[a]/numNodes;
+			}
+
+			for(k=0; k<numNodes; k++)
+			{
+				Level->volume[node[k]] += fabs(area)/numNodes;
+
+				/* Dual face from the middle of edge a-b to the centroid */
+				h  = e*HalfEdge.nodesPerElement + k;
+				a  = Level->edge[2*edgeOf[h]];
+				b  = Level->edge[2*edgeOf[h]+1];
+				nx =   yc - 0.5*(Result->y[a] + Result->y[b]);
+				ny = -(xc - 0.5*(Result->x[a] + Result->x[b]));
+
+				/* Pointing from a to b */
+				if (nx*(Result->x[b] - Result->x[a]) + ny*(Result->y[b] - Result->y[a]) < 0)
+				{
+					nx = -nx;
+					ny = -ny;
+				}
+
+				n = edgeOf[h];
+				Level->normal[2*n]   += nx;
+				Level->normal[2*n+1] += ny;
+			}
+		}
+	}
+
+	/* Free allocated memory */
+	FreeHalfEdges(&HalfEdge);
+
+	if (edgeOf)
+		free(edgeOf);
+
+	return ret;
+}
+
+/*
+** Function Agglomerate
+** Agglomerates the control volumes of a level. Every free control
+** volume, in the order of the node numbers, becomes the seed of an
+** agglomerate that takes all its free neighbours; a control volume
+** without free neighbours joins the smallest neighbouring agglomerate.
+** The dual face normals of the edges between two agglomerates are
+** summed.
+**
+** In:       tLevel Fine   = level to agglomerate
+**
+** Out:      tLevel Fine   = parent agglomerate of each control volume
+**           tLevel Coarse = agglomerated level
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int Agglomerate(tLevel *Fine, tLevel *Coarse)
+{
+	int    n, m, k, e, a, b, lo, hi, best;
+	int    numFree;
+
+	int    *start  = NULL;   /* neighbours of n: neighbour[start[n]..start[n+1]-1] */
+	int    *neighbour = NULL;
+	int    *size   = NULL;
+	int    *first  = NULL;   /* coarse edges sorted by their lower agglomerate */
+	int    *order  = NULL;
+	int    *slot   = NULL;   /* coarse edge of (lo,hi) while lo is treated     */
+
+	Coarse->numNodes = 0;
+	Coarse->numEdges = 0;
+	Coarse->parent   = NULL;
+
+	start     = (int*)calloc(Fine->numNodes+1, sizeof(int));
+	neighbour = (int*)malloc((Fine->numEdges > 0 ? 2*Fine->numEdges : 1)*sizeof(int));
+	size      = (int*)calloc(Fine->numNodes, sizeof(int));
+	first     = (int*)calloc(Fine->numNodes+1, sizeof(int));
+	order     = (int*)malloc((Fine->numEdges > 0 ? Fine->numEdges : 1)*sizeof(int));
+	slot      = (int*)malloc(Fine->numNodes*sizeof(int));
+
+	Fine->parent   = (int*)malloc(Fine->numNodes*sizeof(int));
+	Coarse->volume = (double*)calloc(Fine->numNodes, sizeof(double));
+	Coarse->edge   = (int*)malloc((Fine->numEdges > 0 ? 2*Fine->numEdges : 1)*sizeof(int));
+	Coarse->normal = (double*)calloc((Fine->numEdges > 0 ? 2*Fine->numEdges : 1), sizeof(double));
+
+	if (start == NULL || neighbour == NULL || size == NULL || first == NULL || order == NULL || slot == NULL ||
+	    Fine->parent == NULL || Coarse->volume == NULL || Coarse->edge == NULL || Coarse->normal == NULL)
+	{
+		fprintf(stderr, "ERROR in function Agglomerate: Could not allocate memory.\n");
+
+		if (start)     free(start);
+		if (neighbour) free(neighbour);
+		if (size)      free(size);
+		if (first)     free(first);
+		if (order)     free(order);
+		if (slot)      free(slot);
+
+		return -1;
+	}
+
+	/* Neighbours of every control volume */
+	for(e=0; e<Fine->numEdges; e++)
+	{
+		start[Fine->edge[2*e]+1]++;
+		start[Fine->edge[2*e+1]+1]++;
+	}
+
+	for(n=0; n<Fine->numNodes; n++)
+		start[n+1] += start[n];
+
+	for(e=0; e<Fine->numEdges; e++)
+	{
+		neighbour[start[Fine->edge[2*e]]++]   = Fine->edge[2*e+1];
+		neighbour[start[Fine->edge[2*e+1]]++] = Fine->edge[2*e];
+	}
+
+	for(n=Fine->numNodes; n>0; n--)
+		start[n] = start[n-1];
+	start[0] = 0;
+
+	/* Seeds take their free neighbours */
+	for(n=0; n<Fine->numNodes; n++)
+		Fine->parent[n] = -1;
+
+	for(n=0; n<Fine->numNodes; n++)
+	{
+		if (Fine->parent[n] != -1)
+			continue;
+
+		numFree = 0;
+		best    = -1;
+		for(k=start[n]; k<start[n+1]; k++)
+		{
+			m = neighbour[k];
+
+			if (Fine->parent[m] == -1)
+				numFree++;
+			else if (best == -1 || size[Fine->parent[m]] < size[best])
+				best = Fine->parent[m];
+		}
+
+		if (numFree == 0 && best != -1)
+		{
+			/* Join the smallest neighbouring agglomerate */
+			Fine->parent[n] = best;
+			size[best]++;
+			continue;
+		}
+
+		Fine->parent[n] = Coarse->numNodes;
+		size[Coarse->numNodes] = 1;
+
+		for(k=start[n]; k<start[n+1]; k++)
+		{
+			m = neighbour[k];
+
+			if (Fine->parent[m] == -1)
+			{
+				Fine->parent[m] = Coarse->numNodes;
+				size[Coarse->numNodes]++;
+			}
+		}
+
+		Coarse->numNodes++;
+	}
+
+	for(n=0; n<Fine->numNodes; n++)
+		Coarse->volume[Fine->parent[n]] += Fine->volume[n];
+
+	/* Edges between agglomerates, grouped by their lower agglomerate */
+	for(e=0; e<Fine->numEdges; e++)
+	{
+		a = Fine->parent[Fine->edge[2*e]];
+		b = Fine->parent[Fine->edge[2*e+1]];
+
+		if (a != b)
+			first[(a < b ? a : b)+1]++;
+	}
+
+	for(n=0; n<Coarse->numNodes; n++)
+		first[n+1] += first[n];
+
+	for(e=0; e<Fine->numEdges; e++)
+	{
+		a = Fine->parent[Fine->edge[2*e]];
+		b = Fine->parent[Fine->edge[2*e+1]];
+
+		if (a != b)
+			order[first[(a < b ? a : b)]++] = e;
+	}
+
+	for(n=Coarse->numNodes; n>0; n--)
+		first[n] = first[n-1];
+	first[0] = 0;
+
+	for(n=0; n<Coarse->numNodes; n++)
+		slot[n] = -1;
+
+	for(lo=0; lo<Coarse->numNodes; lo++)
+	{
+		for(k=first[lo]; k<first[lo+1]; k++)
+		{
+			e  = order[k];
+			a  = Fine->parent[Fine->edge[2*e]];
+			b  = Fine->parent[Fine->edge[2*e+1]];
+			hi = (a < b ? b : a);
+
+			/* A new coarse edge lo-hi, unless lo met hi before */
+			if (slot[hi] == -1 || Coarse->edge[2*slot[hi]] != lo)
+			{
+				slot[hi] = Coarse->numEdges++;
+				Coarse->edge[2*slot[hi]]   = lo;
+				Coarse->edge[2*slot[hi]+1] = hi;
+			}
+
+			/* The normal points from the lower to the higher agglomerate */
+			Coarse->normal[2*slot[hi]]   += (a < b ? 1 : -1)*Fine->normal[2*e];
+			Coarse->normal[2*slot[hi]+1] += (a < b ? 1 : -1)*Fine->normal[2*e+1];
+		}
+	}
+
+	/* Free allocated memory */
+	free(start);
+	free(neighbour);
+	free(size);
+	free(first);
+	free(order);
+	free(slot);
+
+	return 0;
+}
+
+/*
+** Function WriteLevel
+** Writes a level of agglomerated control volumes.
+**
+** In:       int    l      = level
+**           tLevel Level  = control volumes and edges
+**           tLevel Finer  = the previous level, holding the parents;
+**                           NULL for level 0
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int WriteLevel(FILE *mgFile, int l, tLevel *Level, tLevel *Finer)
+{
+	int    n, e;
+
+	fprintf(mgFile, "level %d %d\n", l, Level->numNodes);
+
+	if (Finer != NULL)
+	{
+		fprintf(mgFile, "parents %d\n", Finer->numNodes);
+		for(n=0; n<Finer->numNodes; n++)
+			fprintf(mgFile, "\t%d\n", Finer->parent[n]);
+	}
+
+	fprintf(mgFile, "volumes %d\n", Level->numNodes);
+	for(n=0; n<Level->numNodes; n++)
+		fprintf(mgFile, "\t%10.6e\n", Level->volume[n]);
+
+	fprintf(mgFile, "edges %d\n", Level->numEdges);
+	for(e=0; e<Level->numEdges; e++)
+		fprintf(mgFile, "\t%d %d %10.6e %10.6e\n", Level->edge[2*e], Level->edge[2*e+1], Level->normal[2*e], Level->normal[2*e+1]);
+
+	return 0;
+}
+
+/*
+** Function FreeLevel
+** Frees the arrays of a level.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeLevel(tLevel *Level)
+{
+	if (Level->edge)
+		free(Level->edge);
+
+	if (Level->normal)
+		free(Level->normal);
+
+	if (Level->volume)
+		free(Level->volume);
+
+	if (Level->parent)
+		free(Level->parent);
+
+	Level->edge   = NULL;
+	Level->normal = NULL;
+	Level->volume = NULL;
+	Level->parent = NULL;
+
+	return 0;
+}
@@ -0,0 +1,27 @@
+/*
+** Header-file for Multigrid
+*/
+
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+typedef struct
+{
+	int    numNodes;       /* control volumes (agglomerates) of the level      */
+	int    numEdges;
+	int    *edge;          /* from and to of every edge, from < to for l > 0   */
+	double *normal;        /* dual face normal of every edge, from -> to       */
+	double *volume;        /* area of every control volume                     */
+	int    *parent;        /* agglomerate of every control volume on the next  */
+	                       /* level; NULL on the coarsest level                */
+} tLevel;
+
+int Multigrid(FILE*, tData*, tResult*);
+int CoarsenStructured(FILE*, tResult*, int, int*);
+int CoarsenLines(int*, int, int*, int*, int*, double*);
+int DualGraph(tResult*, tLevel*);
+int Agglomerate(tLevel*, tLevel*);
+int WriteLevel(FILE*, int, tLevel*, tLevel*);
+int FreeLevel(tLevel*);
+
+#endif
@@ -0,0 +1,682 @@
+/*
+** Function Overset
+** Assembles the grid around the aerofoil with a Cartesian background
+** grid of the windtunnel into an overset (chimera) grid, for bodies
+** like flaps and stores that are easier to overlay than to mesh into
+** one conforming grid:
+** - NUMFRINGELAYERS layers of nodes inside the outer boundary of the
+**   body grid are fringe nodes, which receive their values from the
+**   background grid;
+** - the background nodes inside the aerofoil, or in a cell of the body
+**   grid smaller than their own, are cut out as holes, unless that
+**   would take a node from the donors of the body grid, or make a
+**   fringe node that cannot receive from the body grid;
+** - NUMFRINGELAYERS layers of nodes around the holes are the fringe
+**   nodes of the background grid;
+** - every fringe node gets a donor element of the other grid and the
+**   weights of its nodes, found through the element index of Locate;
+**   a donor with a fringe or hole node of its own makes an orphan.
+** The body grid is kept as it is; the background grid and the
+** connectivity are written alongside it.
+**
+** In:       char    backgroundFileName = file with the background grid
+**           tResult Result             = structure containing Results
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: the background file, see ReadBackground
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "halfedge.h"
+#include "adjacency.h"
+#include "data.h"
+#include "loc.h"
+#include "locate.h"
+#include "overset.h"
+
+int Overset(FILE *log, char *backgroundFileName, tResult *Result)
+{
+	int    ret;
+	int    n, r, k, h;
+	int    numAerofoilEdges, numBodyFringe, numBackgroundFringe, numHoles, numOrphans;
+	int    node[4];
+
+	double cellArea, x, y;
+
+	int    *bodyLayer       = NULL;
+	int    *backgroundLayer = NULL;
+	int    *aerofoilEdge    = NULL;
+	int    *element         = NULL;
+	int    *bodyElement     = NULL;
+	double *weight          = NULL;
+	double *bodyWeight      = NULL;
+	double *xReceptor       = NULL;
+	double *yReceptor       = NULL;
+
+	tOverset      Overset         = {NULL, NULL, NULL, 0, NULL, NULL, NULL, NULL};
+	tHalfEdge     HalfEdge        = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+	tAdjacency    Adjacency       = {0, NULL, NULL, NULL, 0, NULL, NULL};
+	tElementIndex BodyIndex       = {0, 0, 0, 0, 0, 0, NULL, NULL};
+	tElementIndex BackgroundIndex = {0, 0, 0, 0, 0, 0, NULL, NULL};
+
+	printf("Assembling overset grid...\n");
+
+	ret                 = 0;
+	numAerofoilEdges    = 0;
+	numBodyFringe       = 0;
+	numBackgroundFringe = 0;
+	numHoles            = 0;
+	numOrphans          = 0;
+
+	/* Read the background grid */
+	if (ret != -1)
+		ret = ReadBackground(&(*log), backgroundFileName, &Overset);
+
+	if (ret != -1)
+	{
+		bodyLayer       = (int*)malloc(Result->numNodes*sizeof(int));
+		backgroundLayer = (int*)malloc(Overset.background->numNodes*sizeof(int));
+		element         = (int*)malloc(Overset.background->numNodes*sizeof(int));
+		weight          = (double*)malloc(4*Overset.background->numNodes*sizeof(double));
+
+		Overset.bodyType       = (tOversetType*)malloc(Result->numNodes*sizeof(tOversetType));
+		Overset.backgroundType = (tOversetType*)malloc(Overset.background->numNodes*sizeof(tOversetType));
+
+		if ((bodyLayer == NULL) || (backgroundLayer == NULL) || (element == NULL) || (weight == NULL) ||
+		    (Overset.bodyType == NULL) || (Overset.backgroundType == NULL))
+		{
+			fprintf(stderr, "ERROR in function Overset: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	/*
+	** Body grid: the layers inside its outer boundary, where the wall,
+	** inflow and outflow patches are no longer boundaries of the flow
+	*/
+	if (ret != -1)
+		ret = BuildHalfEdges(&(*log), &(*Result), &HalfEdge);
+
+	if (ret != -1)
+		ret = BuildAdjacency(&(*log), &HalfEdge, &Adjacency);
+
+	if (ret != -1)
+	{
+		aerofoilEdge = (int*)malloc((HalfEdge.numBoundaryEdges > 0 ? 2*HalfEdge.numBoundaryEdges : 1)*sizeof(int));
+
+		if (aerofoilEdge == NULL)
+		{
+			fprintf(stderr, "ERROR in function Overset: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		/* The aerofoil edges of the boundary, to find the points inside */
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+		{
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] == -1 &&
+			    PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h)) == ptAerofoil)
+			{
+				aerofoilEdge[2*numAerofoilEdges]   = HalfEdge.origin[h];
+				aerofoilEdge[2*numAerofoilEdges+1] = HalfEdgeDest(&HalfEdge, h);
+				numAerofoilEdges++;
+			}
+		}
+
+		for(n=0; n<Result->numNodes; n++)
+			bodyLayer[n] = ((Adjacency.boundary[n] && Result->patch[n] >= ptWall) ? 0 : -1);
+
+		NodeLayers(&Adjacency, bodyLayer, NUMFRINGELAYERS-1);
+
+		for(n=0; n<Result->numNodes; n++)
+		{
+			Overset.bodyType[n] = (bodyLayer[n] != -1 ? otFringe : otField);
+			numBodyFringe      += (Overset.bodyType[n] == otFringe);
+		}
+	}
+
+	FreeAdjacency(&Adjacency);
+	FreeHalfEdges(&HalfEdge);
+
+	/* Locate the fringe of the body grid in the background grid, and the background grid in the body grid */
+	if (ret != -1)
+	{
+		xReceptor   = (double*)malloc((numBodyFringe > 0 ? numBodyFringe : 1)*sizeof(double));
+		yReceptor   = (double*)malloc((numBodyFringe > 0 ? numBodyFringe : 1)*sizeof(double));
+		bodyElement = (int*)malloc((numBodyFringe > 0 ? numBodyFringe : 1)*sizeof(int));
+		bodyWeight  = (double*)malloc((numBodyFringe > 0 ? 4*numBodyFringe : 1)*sizeof(double));
+
+		if ((xReceptor == NULL) || (yReceptor == NULL) || (bodyElement == NULL) || (bodyWeight == NULL))
+		{
+			fprintf(stderr, "ERROR in function Overset: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(n=0, r=0; n<Result->numNodes; n++)
+		{
+			if (Overset.bodyType[n] == otFringe)
+			{
+				xReceptor[r] = Result->x[n];
+				yReceptor[r] = Result->y[n];
+				r++;
+			}
+		}
+
+		ret = BuildElementIndex(&(*log), Overset.background, &BackgroundIndex);
+	}
+
+	if (ret != -1)
+		ret = BuildElementIndex(&(*log), &(*Result), &BodyIndex);
+
+	if (ret != -1)
+	{
+		LocatePoints(Overset.background, &BackgroundIndex, numBodyFringe, xReceptor, yReceptor, bodyElement, bodyWeight);
+
+		LocatePoints(&(*Result), &BodyIndex, Overset.background->numNodes,
+		             Overset.background->x, Overset.background->y, element, weight);
+
+		/*
+		** Background grid: the candidate holes, and layer 0 for the nodes
+		** that cannot receive from the body grid
+		*/
+		cellArea = ElementArea(Overset.background, 0);
+
+		#pragma omp parallel for private(k, node)
+		for(n=0; n<Overset.background->numNodes; n++)
+		{
+			Overset.backgroundType[n] = otField;
+			backgroundLayer[n]        = -1;
+
+			if (element[n] == -1)
+			{
+				if (InsideAerofoil(&(*Result), numAerofoilEdges, aerofoilEdge, Overset.background->x[n], Overset.background->y[n]))
+					Overset.backgroundType[n] = otHole;
+				else
+					backgroundLayer[n] = 0;
+			}
+			else
+			{
+				CopyNodes(&(*Result), element[n], node);
+
+				for(k=0; k<NodesOfElement(&(*Result), element[n]); k++)
+					if (Overset.bodyType[node[k]] != otField)
+						backgroundLayer[n] = 0;
+
+				if (backgroundLayer[n] == -1 && ElementArea(&(*Result), element[n]) < cellArea)
+					Overset.backgroundType[n] = otHole;
+			}
+		}
+
+		/* Layer 0 also for the donors of the body grid */
+		for(r=0; r<numBodyFringe; r++)
+		{
+			if (bodyElement[r] != -1)
+			{
+				CopyNodes(Overset.background, bodyElement[r], node);
+
+				for(k=0; k<4; k++)
+					backgroundLayer[node[k]] = 0;
+			}
+		}
+
+		ret = BuildHalfEdges(&(*log), Overset.background, &HalfEdge);
+	}
+
+	if (ret != -1)
+		ret = BuildAdjacency(&(*log), &HalfEdge, &Adjacency);
+
+	if (ret != -1)
+	{
+		/* A candidate hole within a fringe of layer 0 stays; the aerofoil is cut out anyway */
+		NodeLayers(&Adjacency, backgroundLayer, NUMFRINGELAYERS);
+
+		for(n=0; n<Overset.background->numNodes; n++)
+		{
+			if (Overset.backgroundType[n] == otHole && element[n] != -1 && backgroundLayer[n] != -1)
+				Overset.backgroundType[n] = otField;
+
+			numHoles += (Overset.backgroundType[n] == otHole);
+		}
+
+		/* Background grid: the layers around the holes */
+		for(n=0; n<Overset.background->numNodes; n++)
+			backgroundLayer[n] = (Overset.backgroundType[n] == otHole ? 0 : -1);
+
+		NodeLayers(&Adjacency, backgroundLayer, NUMFRINGELAYERS);
+
+		for(n=0; n<Overset.background->numNodes; n++)
+		{
+			if (backgroundLayer[n] > 0)
+				Overset.backgroundType[n] = otFringe;
+
+			numBackgroundFringe += (Overset.backgroundType[n] == otFringe);
+		}
+	}
+
+	/* The receptors, the body first, and their donors */
+	if (ret != -1)
+	{
+		Overset.numReceptors = numBodyFringe + numBackgroundFringe;
+
+		Overset.receptorGrid = (int*)malloc((Overset.numReceptors > 0 ? Overset.numReceptors : 1)*sizeof(int));
+		Overset.receptorNode = (int*)malloc((Overset.numReceptors > 0 ? Overset.numReceptors : 1)*sizeof(int));
+		Overset.donorElement = (int*)malloc((Overset.numReceptors > 0 ? Overset.numReceptors : 1)*sizeof(int));
+		Overset.donorWeight  = (double*)malloc((Overset.numReceptors > 0 ? 4*Overset.numReceptors : 1)*sizeof(double));
+
+		if ((Overset.receptorGrid == NULL) || (Overset.receptorNode == NULL) || (Overset.donorElement == NULL) ||
+		    (Overset.donorWeight == NULL))
+		{
+			fprintf(stderr, "ERROR in function Overset: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(n=0, r=0; n<Result->numNodes; n++)
+		{
+			if (Overset.bodyType[n] == otFringe)
+			{
+				Overset.receptorGrid[r] = 0;
+				Overset.receptorNode[r] = n;
+				Overset.donorElement[r] = bodyElement[r];
+				for(k=0; k<4; k++)
+					Overset.donorWeight[4*r+k] = bodyWeight[4*r+k];
+				r++;
+			}
+		}
+
+		for(n=0; n<Overset.background->numNodes; n++)
+		{
+			if (Overset.backgroundType[n] == otFringe)
+			{
+				Overset.receptorGrid[r] = 1;
+				Overset.receptorNode[r] = n;
+				Overset.donorElement[r] = element[n];
+				for(k=0; k<4; k++)
+					Overset.donorWeight[4*r+k] = weight[4*n+k];
+				r++;
+			}
+		}
+
+		/* Only field nodes can donate */
+		numOrphans = CheckDonors(Overset.background, Overset.backgroundType, numBodyFringe,
+		                         Overset.donorElement, Overset.donorWeight) +
+		             CheckDonors(&(*Result), Overset.bodyType, numBackgroundFringe,
+		                         &Overset.donorElement[numBodyFringe], &Overset.donorWeight[4*numBodyFringe]);
+
+		if (numOrphans > 0)
+			fprintf(stderr, "WARNING in function Overset: %d of %d fringe nodes without donor.\n",
+			        numOrphans, Overset.numReceptors);
+	}
+
+	printf("Number of receptors  = %d (%d orphans)\n", Overset.numReceptors, numOrphans);
+
+	/* Write the background grid and the connectivity */
+	if (ret != -1)
+		ret = WriteOversetData(&(*log), &Overset, &(*Result));
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION OVERSET *****\n\n");
+
+		fprintf(log, "background grid      = %d x %d\n", Overset.background->im, Overset.background->jm);
+		fprintf(log, "holes                = %d\n", numHoles);
+		fprintf(log, "fringe of background = %d\n", numBackgroundFringe);
+		fprintf(log, "fringe of body       = %d\n", numBodyFringe);
+		fprintf(log, "orphans              = %d\n", numOrphans);
+
+		/* The first orphans, to find where the grids overlap too little */
+		for(r=0, k=0; r<Overset.numReceptors && k<10; r++)
+		{
+			if (Overset.donorElement[r] == -1)
+			{
+				n = Overset.receptorNode[r];
+				x = (Overset.receptorGrid[r] == 0 ? Result->x[n] : Overset.background->x[n]);
+				y = (Overset.receptorGrid[r] == 0 ? Result->y[n] : Overset.background->y[n]);
+
+				fprintf(log, "orphan of %-10s = node %d at (%f, %f)\n",
+				        (Overset.receptorGrid[r] == 0 ? "body" : "background"), n, x, y);
+				k++;
+			}
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	/* Free allocated memory */
+	FreeAdjacency(&Adjacency);
+	FreeHalfEdges(&HalfEdge);
+	FreeElementIndex(&BodyIndex);
+	FreeElementIndex(&BackgroundIndex);
+	FreeOverset(&Overset);
+
+	if (bodyLayer)
+		free(bodyLayer);
+
+	if (backgroundLayer)
+		free(backgroundLayer);
+
+	if (aerofoilEdge)
+		free(aerofoilEdge);
+
+	if (element)
+		free(element);
+
+	if (bodyElement)
+		free(bodyElement);
+
+	if (weight)
+		free(weight);
+
+	if (bodyWeight)
+		free(bodyWeight);
+
+	if (xReceptor)
+		free(xReceptor);
+
+	if (yReceptor)
+		free(yReceptor);
+
+	return ret;
+}
+
+/*
+** Function ReadBackground
+** Reads the background grid, a uniform Cartesian grid of the
+** windtunnel, and sets it up as a structured grid of quadrangles.
+**
+** In:       char     backgroundFileName = file with one line
+**                                         "xMin xMax yMin yMax im jm"
+**
+** Out:      tOverset Overset            = the background grid
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ReadBackground(FILE *log, char *backgroundFileName, tOverset *Overset)
+{
+	FILE   *backgroundFile = NULL;
+
+	int    ret;
+	int    i, j;
+	double xMin, xMax, yMin, yMax;
+
+	tResult *Background;
+
+	ret = 0;
+
+	backgroundFile = fopen(backgroundFileName, "r");
+
+	if (backgroundFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadBackground: Could not open '%s'.\n", backgroundFileName);
+		return -1;
+	}
+
+	Overset->background = (tResult*)calloc(1, sizeof(tResult));
+
+	if (Overset->background == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadBackground: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	Background = Overset->background;
+
+	if (ret != -1 &&
+	    (fscanf(backgroundFile, "%lf %lf %lf %lf %d %d", &xMin, &xMax, &yMin, &yMax, &(Background->im), &(Background->jm)) != 6 ||
+	     xMax <= xMin || yMax <= yMin || Background->im < 2 || Background->jm < 2))
+	{
+		fprintf(stderr, "ERROR in function ReadBackground: Could not read the background grid.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		Background->numNodes = Background->im*Background->jm;
+		Background->x        = (double*)malloc(Background->numNodes*sizeof(double));
+		Background->y        = (double*)malloc(Background->numNodes*sizeof(double));
+
+		if ((Background->x == NULL) || (Background->y == NULL))
+		{
+			fprintf(stderr, "ERROR in function ReadBackground: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(j=0; j<Background->jm; j++)
+		{
+			for(i=0; i<Background->im; i++)
+			{
+				Background->x[Loc(Background, j, i)] = xMin + (xMax - xMin)*i/(Background->im-1);
+				Background->y[Loc(Background, j, i)] = yMin + (yMax - yMin)*j/(Background->jm-1);
+			}
+		}
+
+		/* Quadrangles following from (j,i), as Quadrangulate sets them up */
+		Background->numElements        = (Background->im-1)*(Background->jm-1);
+		Background->elementType        = etQuadrangle;
+		Background->nodesPerElement    = 4;
+		Background->structuredElements = 1;
+	}
+
+	fclose(backgroundFile);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION READBACKGROUND *****\n\n");
+
+		fprintf(log, "x                    = %f to %f\n", xMin, xMax);
+		fprintf(log, "y                    = %f to %f\n", yMin, yMax);
+		fprintf(log, "nodes                = %d x %d\n", Background->im, Background->jm);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function NodeLayers
+** Numbers the layers of nodes around the nodes of layer 0: a node next
+** to one of layer l-1 gets layer l, up to numLayers. Other nodes keep
+** layer -1.
+**
+** In:       tAdjacency Adjacency = node-to-node adjacency
+**           int        layer     = 0 for the first layer, -1 for others
+**           int        numLayers = number of layers to add
+**
+** Out:      int        layer     = layer of every node
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int NodeLayers(tAdjacency *Adjacency, int *layer, int numLayers)
+{
+	int    l, n, m;
+
+	for(l=1; l<=numLayers; l++)
+		for(n=0; n<Adjacency->numNodes; n++)
+			if (layer[n] == -1)
+				for(m=Adjacency->start[n]; m<Adjacency->start[n+1] && layer[n] == -1; m++)
+					if (layer[Adjacency->node[m]] == l-1)
+						layer[n] = l;
+
+	return 0;
+}
+
+/*
+** Function InsideAerofoil
+** Returns whether point (x,y) lies inside the aerofoil, by counting the
+** aerofoil edges crossing a ray from the point in the x-direction.
+**
+** In:       tResult Result   = structure containing Results
+**           int     numEdges = number of aerofoil edges
+**           int     edge     = two nodes per aerofoil edge
+**           double  x, y     = the point
+**
+** Return:   1 inside, 0 outside
+**
+** Author:   J.L. Klaufus
+*/
+
+int InsideAerofoil(tResult *Result, int numEdges, int *edge, double x, double y)
+{
+	int    e, a, b;
+	int    inside;
+
+	inside = 0;
+
+	for(e=0; e<numEdges; e++)
+	{
+		a = edge[2*e];
+		b = edge[2*e+1];
+
+		if (((Result->y[a] > y) != (Result->y[b] > y)) &&
+		    (x < Result->x[a] + (y - Result->y[a])*(Result->x[b] - Result->x[a])/(Result->y[b] - Result->y[a])))
+			inside = !inside;
+	}
+
+	return inside;
+}
+
+/*
+** Function ElementArea
+** Returns the area of element e.
+**
+** Author:   J.L. Klaufus
+*/
+
+double ElementArea(tResult *Result, int e)
+{
+	int    k, l;
+	int    node[4];
+	double area;
+
+	CopyNodes(&(*Result), e, node);
+
+	area = 0;
+	for(k=0; k<NodesOfElement(&(*Result), e); k++)
+	{
+		l     = (k+1) % NodesOfElement(&(*Result), e);
+		area += Result->x[node[k]]*Result->y[node[l]] - Result->x[node[l]]*Result->y[node[k]];
+	}
+
+	return 0.5*fabs(area);
+}
+
+/*
+** Function CheckDonors
+** Checks the donors of a set of receptors in parallel: a donor element
+** with a node that is not a field node of its grid cannot donate, and
+** the receptor becomes an orphan with element -1.
+**
+** In:       tResult      Donor   = grid of the donor elements
+**           tOversetType type    = of the nodes of that grid
+**           int          num     = number of receptors
+**           int          element = donor element of every receptor
+**
+** Out:      int          element = idem, -1 for orphans
+**           double       weight  = four weights per receptor, 0 for orphans
+**
+** Return:   number of orphans
+**
+** Author:   J.L. Klaufus
+*/
+
+int CheckDonors(tResult *Donor, tOversetType *type, int num, int *element, double *weight)
+{
+	int    r, k, numOrphans;
+	int    node[4];
+
+	numOrphans = 0;
+
+	#pragma omp parallel for private(k, node) reduction(+:numOrphans)
+	for(r=0; r<num; r++)
+	{
+		if (element[r] != -1)
+		{
+			CopyNodes(&(*Donor), element[r], node);
+
+			for(k=0; k<NodesOfElement(&(*Donor), element[r]); k++)
+				if (type[node[k]] != otField)
+					element[r] = -1;
+		}
+
+		if (element[r] == -1)
+		{
+			weight[4*r] = weight[4*r+1] = weight[4*r+2] = weight[4*r+3] = 0;
+			numOrphans++;
+		}
+	}
+
+	return numOrphans;
+}
+
+/*
+** Function FreeOverset
+** Frees the background grid and the connectivity.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeOverset(tOverset *Overset)
+{
+	if (Overset->background)
+	{
+		if (Overset->background->x)
+			free(Overset->background->x);
+
+		if (Overset->background->y)
+			free(Overset->background->y);
+
+		free(Overset->background);
+	}
+
+	if (Overset->bodyType)
+		free(Overset->bodyType);
+
+	if (Overset->backgroundType)
+		free(Overset->backgroundType);
+
+	if (Overset->receptorGrid)
+		free(Overset->receptorGrid);
+
+	if (Overset->receptorNode)
+		free(Overset->receptorNode);
+
+	if (Overset->donorElement)
+		free(Overset->donorElement);
+
+	if (Overset->donorWeight)
+		free(Overset->donorWeight);
+
+	Overset->background = NULL;
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+/*
+** Header-file for Overset
+*/
+
+#ifndef OVERSET_H
+#define OVERSET_H
+
+int    Overset(FILE*, char*, tResult*);
+int    ReadBackground(FILE*, char*, tOverset*);
+int    NodeLayers(tAdjacency*, int*, int);
+int    InsideAerofoil(tResult*, int, int*, double, double);
+double ElementArea(tResult*, int);
+int    CheckDonors(tResult*, tOversetType*, int, int*, double*);
+int    FreeOverset(tOverset*);
+
+#endif
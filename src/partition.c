@@ -0,0 +1,474 @@
+/*
+** Function Partition
+** Divides the elements of the grid over numPartitions partitions by
+** recursive coordinate bisection of the element centroids, each cut
+** across the longer side of the bounding box and placed such that the
+** partitions get equal numbers of elements. Every partition is written
+** with one layer of ghost elements, the elements of other partitions
+** that share an edge with it, and the communication maps.
+**
+** Per partition (gridgen.part.P):
+**   partition p P
+**   nodes n             global number, x, y, owning partition (the
+**                       lowest partition of the elements around it)
+**   elements n m        the m owned elements first, then the ghosts: global
+**                       number, owning partition, number of nodes and
+**                       the nodes in local numbering
+**   boundaries n        boundary edges of the owned elements: the two
+**                       local nodes and the boundary patch
+**   periodic n          local nodes on the cut, with the global number
+**                       of the node across the cut
+**   neighbours n        per neighbouring partition q:
+**   send q n              local owned elements that are ghosts of q
+**   receive q n           local ghost elements owned by q
+** Send and receive lists are in the order of the global numbers, so
+** they match between the two partitions.
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      -
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.part.P: grid of partition P.
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "partition.h"
+
+typedef struct
+{
+	double key;
+	int    element;
+} tElementKey;
+
+static int CompareElementKey(const void *a, const void *b)
+{
+	const tElementKey *keyA = (const tElementKey*)a;
+	const tElementKey *keyB = (const tElementKey*)b;
+
+	if (keyA->key != keyB->key)
+		return (keyA->key < keyB->key ? -1 : 1);
+
+	return (keyA->element < keyB->element ? -1 : (keyA->element > keyB->element ? 1 : 0));
+}
+
+int Partition(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    e, k, h, p, n;
+	int    numPartitions, numCut, maxElements;
+	int    node[4];
+
+	int    *part      = NULL;
+	int    *count     = NULL;
+	int    *nodeOwner = NULL;  /* lowest partition of the elements around a node */
+	double *xc    = NULL;
+	double *yc    = NULL;
+
+	tElementKey *elementKey = NULL;
+
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
+	printf("Partitioning...\n");
+
+	ret           = 0;
+	numPartitions = (Data->numPartitions < Result->numElements ? Data->numPartitions : Result->numElements);
+	numCut        = 0;
+	maxElements   = 0;
+
+	/* Allocate memory */
+	part       = (int*)malloc(Result->numElements*sizeof(int));
+	count      = (int*)calloc(numPartitions, sizeof(int));
+	xc         = (double*)malloc(Result->numElements*sizeof(double));
+	yc         = (double*)malloc(Result->numElements*sizeof(double));
+	elementKey = (tElementKey*)malloc(Result->numElements*sizeof(tElementKey));
+	nodeOwner  = (int*)malloc(Result->numNodes*sizeof(int));
+
+	if (part == NULL || count == NULL || xc == NULL || yc == NULL || elementKey == NULL || nodeOwner == NULL)
+	{
+		fprintf(stderr, "ERROR in function Partition: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+		ret = BuildHalfEdges(NULL, &(*Result), &HalfEdge);
+
+	if (ret != -1)
+	{
+		/* Centroids */
+		for(e=0; e<Result->numElements; e++)
+		{
+			CopyNodes(&(*Result), e, node);
+			n = NodesOfElement(&(*Result), e);
+
+			xc[e] = 0;
+			yc[e] = 0;
+			for(k=0; k<n; k++)
+			{
+				xc[e] += Result->x[node[k]]/n;
+				yc[e] += Result->y[node[k]]/n;
+			}
+
+			elementKey[e].element = e;
+		}
+
+		BisectElements(elementKey, Result->numElements, 0, numPartitions, xc, yc, part);
+
+		/* Load balance and edge cut */
+		for(e=0; e<Result->numElements; e++)
+			count[part[e]]++;
+
+		for(p=0; p<numPartitions; p++)
+			maxElements = (count[p] > maxElements ? count[p] : maxElements);
+
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] > h &&
+			    part[HalfEdgeElement(&HalfEdge, h)] != part[HalfEdgeElement(&HalfEdge, HalfEdge.twin[h])])
+				numCut++;
+
+		/* Owners of the nodes */
+		for(n=0; n<Result->numNodes; n++)
+			nodeOwner[n] = numPartitions;
+
+		for(e=0; e<Result->numElements; e++)
+		{
+			CopyNodes(&(*Result), e, node);
+
+			for(k=0; k<NodesOfElement(&(*Result), e); k++)
+				nodeOwner[node[k]] = (part[e] < nodeOwner[node[k]] ? part[e] : nodeOwner[node[k]]);
+		}
+
+		for(p=0; p<numPartitions && ret != -1; p++)
+			ret = WritePartition(&(*Result), &HalfEdge, part, nodeOwner, p, numPartitions);
+
+		printf("Number of partitions = %d\n", numPartitions);
+		printf("Load imbalance       = %f\n", (double)maxElements*numPartitions/Result->numElements);
+		printf("Edge cut             = %d\n", numCut);
+	}
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION PARTITION *****\n\n");
+
+		fprintf(log, "number of partitions = %d\n", numPartitions);
+		fprintf(log, "load imbalance       = %f\n", (double)maxElements*numPartitions/Result->numElements);
+		fprintf(log, "edge cut             = %d\n", numCut);
+		fprintf(log, "\n  P   Elements\n");
+		for(p=0; p<numPartitions; p++)
+			fprintf(log, "%3d %10d\n", p, count[p]);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	/* Free allocated memory */
+	FreeHalfEdges(&HalfEdge);
+
+	if (part)
+		free(part);
+
+	if (count)
+		free(count);
+
+	if (xc)
+		free(xc);
+
+	if (yc)
+		free(yc);
+
+	if (elementKey)
+		free(elementKey);
+
+	if (nodeOwner)
+		free(nodeOwner);
+
+	return ret;
+}
+
+/*
+** Function BisectElements
+** Assigns numPartitions partitions, starting at firstPartition, to a
+** set of elements: the set is sorted along the longer side of its
+** bounding box and cut in proportion to the number of partitions on
+** either side, after which both halves are bisected in turn.
+**
+** In:       tElementKey elementKey = elements of the set
+**           int         num        = number of elements
+**           double      xc, yc     = element centroids
+**
+** Out:      int         part       = partition of every element
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int BisectElements(void *elementKey, int num, int firstPartition, int numPartitions, double *xc, double *yc, int *part)
+{
+	int    k, e, numLeft, partitionsLeft;
+	double xMin, xMax, yMin, yMax;
+
+	tElementKey *key = (tElementKey*)elementKey;
+
+	if (num == 0)
+		return 0;
+
+	if (numPartitions == 1)
+	{
+		for(k=0; k<num; k++)
+			part[key[k].element] = firstPartition;
+
+		return 0;
+	}
+
+	/* Bounding box of the centroids */
+	xMin = xMax = xc[key[0].element];
+	yMin = yMax = yc[key[0].element];
+	for(k=1; k<num; k++)
+	{
+		e    = key[k].element;
+		xMin = (xc[e] < xMin ? xc[e] : xMin);
+		xMax = (xc[e] > xMax ? xc[e] : xMax);
+		yMin = (yc[e] < yMin ? yc[e] : yMin);
+		yMax = (yc[e] > yMax ? yc[e] : yMax);
+	}
+
+	/* Cut across the longer side */
+	for(k=0; k<num; k++)
+		key[k].key = (xMax - xMin >= yMax - yMin ? xc[key[k].element] : yc[key[k].element]);
+
+	qsort(key, num, sizeof(tElementKey), CompareElementKey);
+
+	partitionsLeft = numPartitions/2;
+	numLeft        = (int)((long)num*partitionsLeft/numPartitions);
+
+	BisectElements(key, numLeft, firstPartition, partitionsLeft, xc, yc, part);
+	BisectElements(key+numLeft, num-numLeft, firstPartition+partitionsLeft, numPartitions-partitionsLeft, xc, yc, part);
+
+	return 0;
+}
+
+/*
+** Function WritePartition
+** Writes partition p with its ghost elements and communication maps
+** to gridgen.part.p.
+**
+** In:       tResult   Result    = structure containing Results
+**           tHalfEdge HalfEdge  = half-edge structure of the grid
+**           int       part      = partition of every element
+**           int       nodeOwner = lowest partition of the elements around every node
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int WritePartition(tResult *Result, tHalfEdge *HalfEdge, int *part, int *nodeOwner, int p, int numPartitions)
+{
+	FILE   *partFile = NULL;
+	char   fileName[30];
+
+	int    e, k, h, g, n, q, l;
+	int    numOwned, numLocal, numNodes, numNeighbours, numList;
+	int    node[4];
+
+	int    *local     = NULL;   /* local number of every element, -1 if not present */
+	int    *localNode = NULL;   /* local number of every node, -1 if not present    */
+	int    *element   = NULL;   /* global number of every local element             */
+	int    *nodes     = NULL;   /* global number of every local node                */
+	int    *isGhost   = NULL;   /* 1 for owned elements that are ghosts of q        */
+
+	local     = (int*)malloc(Result->numElements*sizeof(int));
+	localNode = (int*)malloc(Result->numNodes*sizeof(int));
+	element   = (int*)malloc(Result->numElements*sizeof(int));
+	nodes     = (int*)malloc(Result->numNodes*sizeof(int));
+	isGhost   = (int*)malloc(Result->numElements*sizeof(int));
+
+	sprintf(fileName, "gridgen.part.%d", p);
+	partFile = fopen(fileName, "w");
+
+	if (local == NULL || localNode == NULL || element == NULL || nodes == NULL || isGhost == NULL || partFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function WritePartition: Could not write %s.\n", fileName);
+
+		if (local)     free(local);
+		if (localNode) free(localNode);
+		if (element)   free(element);
+		if (nodes)     free(nodes);
+		if (isGhost)   free(isGhost);
+		if (partFile)  fclose(partFile);
+
+		return -1;
+	}
+
+	for(n=0; n<Result->numNodes; n++)
+		localNode[n] = -1;
+
+	/* Owned elements, then the ghosts across their edges, in global order */
+	numLocal = 0;
+	for(e=0; e<Result->numElements; e++)
+	{
+		local[e] = -1;
+
+		if (part[e] == p)
+		{
+			local[e]            = numLocal;
+			element[numLocal++] = e;
+		}
+	}
+
+	numOwned = numLocal;
+
+	for(e=0; e<Result->numElements; e++)
+	{
+		if (part[e] == p)
+			continue;
+
+		for(k=0; k<NodesOfElement(&(*Result), e); k++)
+		{
+			g = HalfEdge->twin[e*HalfEdge->nodesPerElement+k];
+
+			if (g != -1 && part[HalfEdgeElement(&(*HalfEdge), g)] == p)
+			{
+				local[e]            = numLocal;
+				element[numLocal++] = e;
+				break;
+			}
+		}
+	}
+
+	/* Nodes of the local elements */
+	numNodes = 0;
+	for(l=0; l<numLocal; l++)
+	{
+		CopyNodes(&(*Result), element[l], node);
+
+		for(k=0; k<NodesOfElement(&(*Result), element[l]); k++)
+		{
+			if (localNode[node[k]] == -1)
+			{
+				localNode[node[k]] = numNodes;
+				nodes[numNodes++]  = node[k];
+			}
+		}
+	}
+
+	fprintf(partFile, "partition %d %d\n", p, numPartitions);
+
+	fprintf(partFile, "nodes %d\n", numNodes);
+	for(n=0; n<numNodes; n++)
+		fprintf(partFile, "\t%d %10.6f %10.6f %d\n", nodes[n], Result->x[nodes[n]], Result->y[nodes[n]], nodeOwner[nodes[n]]);
+
+	fprintf(partFile, "elements %d %d\n", numLocal, numOwned);
+	for(l=0; l<numLocal; l++)
+	{
+		CopyNodes(&(*Result), element[l], node);
+
+		fprintf(partFile, "\t%d %d %d", element[l], part[element[l]], NodesOfElement(&(*Result), element[l]));
+
+		for(k=0; k<NodesOfElement(&(*Result), element[l]); k++)
+			fprintf(partFile, " %d", localNode[node[k]]);
+
+		fprintf(partFile, "\n");
+	}
+
+	/* Boundary edges of the owned elements, and the nodes across the cut */
+	numList = 0;
+	for(l=0; l<numOwned; l++)
+		for(k=0; k<NodesOfElement(&(*Result), element[l]); k++)
+			numList += (HalfEdge->twin[element[l]*HalfEdge->nodesPerElement+k] == -1);
+
+	fprintf(partFile, "boundaries %d\n", numList);
+	for(l=0; l<numOwned; l++)
+	{
+		for(k=0; k<NodesOfElement(&(*Result), element[l]); k++)
+		{
+			h = element[l]*HalfEdge->nodesPerElement+k;
+
+			if (HalfEdge->twin[h] == -1)
+				fprintf(partFile, "\t%d %d %d\n", localNode[HalfEdge->origin[h]], localNode[HalfEdgeDest(&(*HalfEdge), h)],
+				        PatchOfEdge(&(*Result), HalfEdge->origin[h], HalfEdgeDest(&(*HalfEdge), h)));
+		}
+	}
+
+	numList = 0;
+	for(n=0; n<numNodes; n++)
+		numList += (Result->periodicNode[nodes[n]] != -1);
+
+	fprintf(partFile, "periodic %d\n", numList);
+	for(n=0; n<numNodes; n++)
+		if (Result->periodicNode[nodes[n]] != -1)
+			fprintf(partFile, "\t%d %d\n", n, Result->periodicNode[nodes[n]]);
+
+	/* Neighbouring partitions */
+	numNeighbours = 0;
+	for(q=0; q<numPartitions; q++)
+	{
+		for(l=numOwned; l<numLocal && part[element[l]] != q; l++);
+
+		if (q != p && l < numLocal)
+			numNeighbours++;
+	}
+
+	fprintf(partFile, "neighbours %d\n", numNeighbours);
+
+	for(q=0; q<numPartitions; q++)
+	{
+		if (q == p)
+			continue;
+
+		/* Owned elements sharing an edge with q */
+		numList = 0;
+		for(l=0; l<numOwned; l++)
+		{
+			isGhost[l] = 0;
+
+			for(k=0; k<NodesOfElement(&(*Result), element[l]); k++)
+			{
+				h = HalfEdge->twin[element[l]*HalfEdge->nodesPerElement+k];
+
+				if (h != -1 && part[HalfEdgeElement(&(*HalfEdge), h)] == q)
+					isGhost[l] = 1;
+			}
+
+			numList += isGhost[l];
+		}
+
+		if (numList == 0)
+			continue;
+
+		fprintf(partFile, "send %d %d\n", q, numList);
+		for(l=0; l<numOwned; l++)
+			if (isGhost[l])
+				fprintf(partFile, "\t%d\n", l);
+
+		numList = 0;
+		for(l=numOwned; l<numLocal; l++)
+			numList += (part[element[l]] == q);
+
+		fprintf(partFile, "receive %d %d\n", q, numList);
+		for(l=numOwned; l<numLocal; l++)
+			if (part[element[l]] == q)
+				fprintf(partFile, "\t%d\n", l);
+	}
+
+	fclose(partFile);
+
+	/* Free allocated memory */
+	free(local);
+	free(localNode);
+	free(element);
+	free(nodes);
+	free(isGhost);
+
+	return 0;
+}
@@ -0,0 +1,12 @@
+/*
+** Header-file for Partition
+*/
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+int Partition(FILE*, tData*, tResult*);
+int BisectElements(void*, int, int, int, double*, double*, int*);
+int WritePartition(tResult*, tHalfEdge*, int*, int*, int, int);
+
+#endif
@@ -1,6 +1,6 @@
 /*
 ** Function Quadrangulate
-** Creates quadrangular elements.
+** Defines the quadrangular elements of the structured grid.
 **
 ** In:       tResult Result   = structure containing Results
 **           
@@ -21,47 +21,29 @@
 int Quadrangulate(FILE *log, tResult* Result)
 {
 	int    ret;
-	int    i, j;
-	int    quadrangleNum;
-	int    nodeSW, nodeSE, nodeNW, nodeNE;
+	int    i;
+	int    node[4];
 
 	printf("Quadrangulating...\n");
 
 	ret = 0;
 
 	/* Set the characateristics in the Result structure */
-	Result->numElements     = (Result->im-1)*(Result->jm-1);
-	Result->elementType     = etQuadrangle;
-	Result->nodesPerElement = 4;
+	Result->numElements        = (Result->im-1)*(Result->jm-1);
+	Result->elementType        = etQuadrangle;
+	Result->nodesPerElement    = 4;
+
+	/*
+	** The connectivity of a structured grid is a pure function of (j,i),
+	** so no quadrangles array is stored. Quadrangle j*(im-1)+i consists
+	** out of nodeSE, nodeSW, nodeNW and nodeNE; see CopyNodes.
+	*/
+	Result->structuredElements = 1;
 
-	/* Allocate memory */
 	if (Result->element != NULL)
 		free(Result->element);
 
-	Result->element = (tElement*)malloc(Result->numElements*sizeof(tElement));
-
-	/* Fill the quadrangles array */
-	quadrangleNum = 0;
-	for(j=0; j<Result->jm-1; j++)
-	{
-		for(i=0; i<Result->im-1; i++)
-		{
-			/* Select the nodes */
-			nodeSE = Loc(&(*Result), j, i+1);
-			nodeSW = Loc(&(*Result), j, i);
-			nodeNW = Loc(&(*Result), j+1, i);
-			nodeNE = Loc(&(*Result), j+1, i+1);
-
-			/* The quadrangle consists out of nodeSW, nodeSE, nodeNW and node NE*/
-			Result->element[quadrangleNum].quadrangle.node[0] = nodeSE;
-			Result->element[quadrangleNum].quadrangle.node[1] = nodeSW;
-			Result->element[quadrangleNum].quadrangle.node[2] = nodeNW;
-			Result->element[quadrangleNum].quadrangle.node[3] = nodeNE;
-
-			/* Calculate the number of the current quadrangle */
-			quadrangleNum++;
-		}
-	}
+	Result->element = NULL;
 
 	/* Write report */
 	if (log)
@@ -72,12 +54,9 @@ int Quadrangulate(FILE *log, tResult* Result)
 
 		for(i=0; i<Result->numElements; i++)
 		{
-			nodeSE = Result->element[i].quadrangle.node[0];
-			nodeSW = Result->element[i].quadrangle.node[1];
-			nodeNW = Result->element[i].quadrangle.node[2];
-			nodeNE = Result->element[i].quadrangle.node[3];
+			CopyNodes(&(*Result), i, node);
 
-			fprintf(log, "%3d   %3d   %3d   %3d   %3d\n", i, nodeSE, nodeSW, nodeNW, nodeNE);
+			fprintf(log, "%3d   %3d   %3d   %3d   %3d\n", i, node[0], node[1], node[2], node[3]);
 		}
 
 		fprintf(log, "\n*****************************\n\n");
@@ -85,4 +64,3 @@ int Quadrangulate(FILE *log, tResult* Result)
 
 	return ret;
 }
-
@@ -0,0 +1,591 @@
+/*
+** Function Quadratic
+** Creates quadratic (P2) elements on every other grid line, so one
+** curved element replaces four straight ones at the same geometric
+** accuracy. Corners, mid-edge nodes and centres are nodes of the grid:
+** along the aerofoil they lie on the spline, in the field they follow
+** the elliptic solution. A stretch with an odd number of intervals gets
+** one element of a single interval, whose mid-edge nodes are added:
+** halfway along the spline on the aerofoil, halfway along the straight
+** edge elsewhere. The trailing edge stays a corner and both sides of
+** the cut are coarsened from the outflow, so the cut nodes keep facing
+** each other.
+**
+** Quadrangular grids give 9-node quadrangles, triangular grids two
+** 6-node triangles per coarse cell, split along the diagonal giving
+** the largest smallest angle as with triangulationType 'Q'; hybrid
+** grids keep quadrangles within the quadrangle layers. Grids not on
+** the structured lattice (Delaunay, refined) are not supported.
+** Elements whose Jacobian changes sign, where grid lines bend strongly
+** over two cells, get straight edges: their mid-edge nodes and centre
+** go to the middle of the corners, and all elements are checked again.
+** An element that still folds with straight edges is an error.
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "flip.h"
+#include "quadratic.h"
+
+int Quadratic(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    i, j, k, n, e;
+	int    numLinesI, numLinesJ, numQuadLayers;
+	int    I0, I1, Im, J0, J1, Jm;
+	int    iFirst, iLast, jFirst, jLast;
+	int    numHalfI, numHalfJ;
+	int    numTriangles, numQuadrangles;
+	int    nodeSE, nodeSW, nodeNW, nodeNE;
+	double angleSENW, angleSWNE;
+	double area;
+	int    numFolded, numStraightened, numMoved;
+
+	int    *lineI = NULL;      /* grid lines kept, every other one */
+	int    *lineJ = NULL;
+	int    *added = NULL;      /* added node at every half index, or -1 */
+
+	tQuadraticElement *element;
+
+	printf("Creating quadratic elements...\n");
+
+	ret            = 0;
+	numTriangles   = 0;
+	numQuadrangles = 0;
+	numFolded      = 0;
+	numStraightened = 0;
+
+	if (Data->gridType == 'D' || Result->numNodes != Result->im*Result->jm)
+	{
+		fprintf(stderr, "WARNING in function Quadratic: Quadratic elements need the structured lattice, not written.\n");
+		return 0;
+	}
+
+	numHalfI = 2*Result->im - 1;
+	numHalfJ = 2*Result->jm - 1;
+
+	lineI = (int*)malloc(Result->im*sizeof(int));
+	lineJ = (int*)malloc(Result->jm*sizeof(int));
+	added = (int*)malloc(numHalfI*numHalfJ*sizeof(int));
+
+	if (lineI == NULL || lineJ == NULL || added == NULL)
+	{
+		fprintf(stderr, "ERROR in function Quadratic: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		/* Lower cut, aerofoil, upper cut from the outflow; eta from the wall */
+		lineI[0]  = 0;
+		numLinesI = 1;
+		CoarseLines(0, Data->numNodes2, 0, lineI, &numLinesI);
+		CoarseLines(Data->numNodes2, Data->numNodes2+Data->numNodes1-1, 0, lineI, &numLinesI);
+		CoarseLines(Data->numNodes2+Data->numNodes1-1, Result->im-1, 1, lineI, &numLinesI);
+
+		lineJ[0]  = 0;
+		numLinesJ = 1;
+		CoarseLines(0, Result->jm-1, 0, lineJ, &numLinesJ);
+
+		numQuadLayers = (Data->numQuadLayers < Result->jm-2 ? Data->numQuadLayers : Result->jm-2);
+
+		for(n=0; n<numHalfI*numHalfJ; n++)
+			added[n] = -1;
+
+		Result->numQuadraticNodes    = Result->numNodes;
+		Result->numQuadraticElements = 0;
+		Result->quadraticElement     = (tQuadraticElement*)malloc(2*(numLinesI-1)*(numLinesJ-1)*sizeof(tQuadraticElement));
+		Result->quadraticTypes       = (tElementType*)malloc(2*(numLinesI-1)*(numLinesJ-1)*sizeof(tElementType));
+
+		if (Result->quadraticElement == NULL || Result->quadraticTypes == NULL)
+		{
+			fprintf(stderr, "ERROR in function Quadratic: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		/* Elements, in half indices: 2*i is grid line i */
+		for(j=0; j<numLinesJ-1; j++)
+		{
+			J0 = 2*lineJ[j];
+			J1 = 2*lineJ[j+1];
+			Jm = lineJ[j] + lineJ[j+1];
+
+			for(i=0; i<numLinesI-1; i++)
+			{
+				I0 = 2*lineI[i];
+				I1 = 2*lineI[i+1];
+				Im = lineI[i] + lineI[i+1];
+
+				if (Result->elementType == etQuadrangle ||
+				   (Result->elementType == etMixed && lineJ[j+1] <= numQuadLayers))
+				{
+					/* SE, SW, NW, NE, their middles, centre */
+					e       = Result->numQuadraticElements++;
+					element = &Result->quadraticElement[e];
+
+					Result->quadraticTypes[e] = etQuadrangle9;
+
+					element->quadrangle.node[0] = QuadraticNode(&(*Result), added, J0, I1);
+					element->quadrangle.node[1] = QuadraticNode(&(*Result), added, J0, I0);
+					element->quadrangle.node[2] = QuadraticNode(&(*Result), added, J1, I0);
+					element->quadrangle.node[3] = QuadraticNode(&(*Result), added, J1, I1);
+					element->quadrangle.node[4] = QuadraticNode(&(*Result), added, J0, Im);
+					element->quadrangle.node[5] = QuadraticNode(&(*Result), added, Jm, I0);
+					element->quadrangle.node[6] = QuadraticNode(&(*Result), added, J1, Im);
+					element->quadrangle.node[7] = QuadraticNode(&(*Result), added, Jm, I1);
+					element->quadrangle.node[8] = QuadraticNode(&(*Result), added, Jm, Im);
+
+					numQuadrangles++;
+				}
+				else
+				{
+					/* West: SE, SW, NW; east: SE, NW, NE, or along the */
+					/* other diagonal if that gives the larger smallest angle */
+					nodeSE = QuadraticNode(&(*Result), added, J0, I1);
+					nodeSW = QuadraticNode(&(*Result), added, J0, I0);
+					nodeNW = QuadraticNode(&(*Result), added, J1, I0);
+					nodeNE = QuadraticNode(&(*Result), added, J1, I1);
+
+					angleSENW = fmin(TriangleMinimumAngle(&(*Result), nodeSE, nodeSW, nodeNW),
+					                 TriangleMinimumAngle(&(*Result), nodeSE, nodeNW, nodeNE));
+					angleSWNE = fmin(TriangleMinimumAngle(&(*Result), nodeSE, nodeSW, nodeNE),
+					                 TriangleMinimumAngle(&(*Result), nodeSW, nodeNW, nodeNE));
+
+					e       = Result->numQuadraticElements++;
+					element = &Result->quadraticElement[e];
+
+					Result->quadraticTypes[e] = etTriangle6;
+
+					element->triangle.node[0] = nodeSE;
+					element->triangle.node[1] = nodeSW;
+					element->triangle.node[3] = QuadraticNode(&(*Result), added, J0, Im);
+
+					if (angleSWNE > angleSENW)
+					{
+						element->triangle.node[2] = nodeNE;
+						element->triangle.node[4] = QuadraticNode(&(*Result), added, Jm, Im);
+						element->triangle.node[5] = QuadraticNode(&(*Result), added, Jm, I1);
+					}
+					else
+					{
+						element->triangle.node[2] = nodeNW;
+						element->triangle.node[4] = QuadraticNode(&(*Result), added, Jm, I0);
+						element->triangle.node[5] = QuadraticNode(&(*Result), added, Jm, Im);
+					}
+
+					e       = Result->numQuadraticElements++;
+					element = &Result->quadraticElement[e];
+
+					Result->quadraticTypes[e] = etTriangle6;
+
+					element->triangle.node[1] = nodeNW;
+					element->triangle.node[2] = nodeNE;
+					element->triangle.node[4] = QuadraticNode(&(*Result), added, J1, Im);
+
+					if (angleSWNE > angleSENW)
+					{
+						element->triangle.node[0] = nodeSW;
+						element->triangle.node[3] = QuadraticNode(&(*Result), added, Jm, I0);
+						element->triangle.node[5] = QuadraticNode(&(*Result), added, Jm, Im);
+					}
+					else
+					{
+						element->triangle.node[0] = nodeSE;
+						element->triangle.node[3] = QuadraticNode(&(*Result), added, Jm, Im);
+						element->triangle.node[5] = QuadraticNode(&(*Result), added, Jm, I1);
+					}
+
+					numTriangles += 2;
+				}
+			}
+		}
+
+		Result->xQuadratic = (double*)malloc(Result->numQuadraticNodes*sizeof(double));
+		Result->yQuadratic = (double*)malloc(Result->numQuadraticNodes*sizeof(double));
+
+		if (Result->xQuadratic == NULL || Result->yQuadratic == NULL)
+		{
+			fprintf(stderr, "ERROR in function Quadratic: Could not allocate memory.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(n=0; n<Result->numNodes; n++)
+		{
+			Result->xQuadratic[n] = Result->x[n];
+			Result->yQuadratic[n] = Result->y[n];
+		}
+
+		/* Added nodes: the mean of the grid nodes around them */
+		for(j=0; j<numHalfJ; j++)
+		{
+			for(i=0; i<numHalfI; i++)
+			{
+				n = added[j*numHalfI + i];
+
+				if (n == -1)
+					continue;
+
+				jFirst = j/2;
+				jLast  = (j+1)/2;
+				iFirst = i/2;
+				iLast  = (i+1)/2;
+
+				if (j == 0 && iFirst >= Data->numNodes2 && iLast <= Data->numNodes2+Data->numNodes1-1)
+				{
+					/* On the aerofoil: on the spline */
+					Result->xQuadratic[n] = Result->xNodeMid[iFirst - Data->numNodes2];
+					Result->yQuadratic[n] = Result->yNodeMid[iFirst - Data->numNodes2];
+				}
+				else
+				{
+					Result->xQuadratic[n] = 0;
+					Result->yQuadratic[n] = 0;
+
+					for(k=0; k<4; k++)
+					{
+						e = QuadraticNode(&(*Result), added, 2*(k/2 ? jLast : jFirst), 2*(k%2 ? iLast : iFirst));
+
+						Result->xQuadratic[n] += Result->x[e]/4;
+						Result->yQuadratic[n] += Result->y[e]/4;
+					}
+				}
+			}
+		}
+	}
+
+	if (ret != -1)
+	{
+		/* The Jacobian at the nodes must have the sign of the grid */
+		area = 0;
+		for(e=0; e<Result->numQuadraticElements; e++)
+			area += QuadraticJacobian(&(*Result), e, 0.5, 0.5);
+
+		/* Straighten the folded elements until none is left or all are straight */
+		do
+		{
+			numFolded = 0;
+			numMoved  = 0;
+
+			for(e=0; e<Result->numQuadraticElements; e++)
+			{
+				if (QuadraticFolded(&(*Result), e, area) == 0)
+					continue;
+
+				numFolded++;
+				k = StraightenQuadratic(&(*Result), e);
+
+				numStraightened += (k > 0);
+				numMoved        += k;
+			}
+		} while (numFolded > 0 && numMoved > 0);
+
+		if (numStraightened > 0)
+			fprintf(stderr, "WARNING in function Quadratic: %d folded quadratic elements straightened.\n", numStraightened);
+
+		if (numFolded > 0)
+		{
+			fprintf(stderr, "ERROR in function Quadratic: %d quadratic elements fold with straight edges.\n", numFolded);
+			ret = -1;
+		}
+	}
+
+	printf("Number of quadratic elements = %d\n", Result->numQuadraticElements);
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION QUADRATIC *****\n\n");
+
+		fprintf(log, "linear elements      = %d\n", Result->numElements);
+		fprintf(log, "triangles (P2)       = %d\n", numTriangles);
+		fprintf(log, "quadrangles (P2)     = %d\n", numQuadrangles);
+		fprintf(log, "nodes                = %d\n", Result->numQuadraticNodes);
+		fprintf(log, "added mid-edge nodes = %d\n", Result->numQuadraticNodes - Result->numNodes);
+		fprintf(log, "straightened         = %d\n", numStraightened);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	/* Free allocated memory */
+	if (lineI)
+		free(lineI);
+
+	if (lineJ)
+		free(lineJ);
+
+	if (added)
+		free(added);
+
+	return ret;
+}
+
+/*
+** Function CoarseLines
+** Appends every other grid line of the stretch first..last to the
+** lines kept, ending with last. An odd number of intervals leaves one
+** single interval: at the end of the stretch, or with oddFirst at its
+** start.
+**
+** In:       int first, last = first and last grid line of the stretch,
+**                             first is already kept
+**           int oddFirst    = 1: single interval at the start
+**           int line        = lines kept
+**           int numLines    = number of lines kept
+**
+** Out:      int line        = lines kept
+**           int numLines    = number of lines kept
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int CoarseLines(int first, int last, int oddFirst, int *line, int *numLines)
+{
+	int    k;
+
+	k = first;
+
+	if (oddFirst && (last-first)%2 == 1)
+		line[(*numLines)++] = ++k;
+
+	while (k+2 <= last)
+	{
+		k += 2;
+		line[(*numLines)++] = k;
+	}
+
+	if (k < last)
+		line[(*numLines)++] = last;
+
+	return 0;
+}
+
+/*
+** Function QuadraticNode
+** Returns the node at half index (J,I), with grid line j at 2*j. Even
+** indices give the grid node; odd ones a node that is added on first
+** use and numbered after the nodes of the grid.
+**
+** In:       tResult Result = structure containing Results
+**           int     added  = added node at every half index, or -1
+**           int     J, I   = half index
+**
+** Out:      int     added  = added node at every half index, or -1
+**
+** Return:   node number
+**
+** Author:   J.L. Klaufus
+*/
+
+int QuadraticNode(tResult *Result, int *added, int J, int I)
+{
+	int    lattice, h;
+
+	if (J%2 == 0 && I%2 == 0)
+	{
+		lattice = Loc(&(*Result), J/2, I/2);
+
+		return (Result->nodeNumber ? Result->nodeNumber[lattice] : lattice);
+	}
+
+	h = J*(2*Result->im - 1) + I;
+
+	if (added[h] == -1)
+		added[h] = Result->numQuadraticNodes++;
+
+	return added[h];
+}
+
+/*
+** Function QuadraticFolded
+** Checks the Jacobian of quadratic element e at its nodes against the
+** sign of the grid.
+**
+** In:       tResult Result = structure containing Results
+**           int     e      = quadratic element
+**           double  area   = sum of the Jacobians of all elements
+**
+** Return:   1 if the element is folded, 0 otherwise
+**
+** Author:   J.L. Klaufus
+*/
+
+int QuadraticFolded(tResult *Result, int e, double area)
+{
+	int    k;
+
+	for(k=0; k<9; k++)
+	{
+		if (Result->quadraticTypes[e] == etTriangle6 && k/3 + k%3 > 2)
+			continue;
+
+		if (QuadraticJacobian(&(*Result), e, (k%3)/2.0, (k/3)/2.0)*area <= 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+** Function StraightenQuadratic
+** Moves the mid-edge nodes of quadratic element e to the middle of the
+** corners of their edge, and the centre of a quadrangle to the mean of
+** its corners. Neighbours sharing an edge get the same straight edge.
+**
+** In:       tResult Result = structure containing Results
+**           int     e      = quadratic element
+**
+** Out:      tResult Result = xQuadratic and yQuadratic
+**
+** Return:   number of nodes moved
+**
+** Author:   J.L. Klaufus
+*/
+
+int StraightenQuadratic(tResult *Result, int e)
+{
+	int    k, a, b, m, numCorners, numMoved;
+	int    *node;
+	double x, y;
+
+	double *xq = Result->xQuadratic;
+	double *yq = Result->yQuadratic;
+
+	if (Result->quadraticTypes[e] == etTriangle6)
+	{
+		node       = Result->quadraticElement[e].triangle.node;
+		numCorners = 3;
+	}
+	else
+	{
+		node       = Result->quadraticElement[e].quadrangle.node;
+		numCorners = 4;
+	}
+
+	numMoved = 0;
+	for(k=0; k<=numCorners; k++)
+	{
+		m = node[numCorners + k];
+
+		if (k < numCorners)
+		{
+			/* Middle of edge k */
+			a = node[k];
+			b = node[(k+1)%numCorners];
+			x = (xq[a] + xq[b])/2;
+			y = (yq[a] + yq[b])/2;
+		}
+		else if (numCorners == 4)
+		{
+			/* Centre */
+			x = (xq[node[0]] + xq[node[1]] + xq[node[2]] + xq[node[3]])/4;
+			y = (yq[node[0]] + yq[node[1]] + yq[node[2]] + yq[node[3]])/4;
+		}
+		else
+			break;
+
+		if (fabs(xq[m] - x) + fabs(yq[m] - y) > SMALL)
+		{
+			xq[m] = x;
+			yq[m] = y;
+			numMoved++;
+		}
+	}
+
+	return numMoved;
+}
+
+/*
+** Function QuadraticJacobian
+** Returns the Jacobian of quadratic element e at (s,t). Triangles map
+** corners 0, 1, 2 to (0,0), (1,0), (0,1); quadrangles corners 0..3 to
+** (0,0), (1,0), (1,1), (0,1). The sign is that of the corner order.
+**
+** In:       tResult Result = structure containing Results
+**           int     e      = quadratic element
+**           double  s, t   = reference coordinates
+**
+** Return:   Jacobian
+**
+** Author:   J.L. Klaufus
+*/
+
+double QuadraticJacobian(tResult *Result, int e, double s, double t)
+{
+	int    n, numNodes;
+	int    *node;
+	int    iS[9] = {0, 2, 2, 0, 1, 2, 1, 0, 1};   /* position of the nodes, */
+	int    iT[9] = {0, 0, 2, 2, 0, 1, 2, 1, 1};   /* in halves              */
+	double l0, l1, l2;
+	double L[2][3], dL[2][3];
+	double dNdS[9], dNdT[9];
+	double xS, xT, yS, yT;
+
+	if (Result->quadraticTypes[e] == etTriangle6)
+	{
+		node     = Result->quadraticElement[e].triangle.node;
+		numNodes = 6;
+
+		l0 = 1 - s - t;
+		l1 = s;
+		l2 = t;
+
+		dNdS[0] = 1 - 4*l0;  dNdT[0] = 1 - 4*l0;
+		dNdS[1] = 4*l1 - 1;  dNdT[1] = 0;
+		dNdS[2] = 0;         dNdT[2] = 4*l2 - 1;
+		dNdS[3] = 4*(l0-l1); dNdT[3] = -4*l1;
+		dNdS[4] = 4*l2;      dNdT[4] = 4*l1;
+		dNdS[5] = -4*l2;     dNdT[5] = 4*(l0-l2);
+	}
+	else
+	{
+		node     = Result->quadraticElement[e].quadrangle.node;
+		numNodes = 9;
+
+		/* Lagrange polynomials through 0, 1/2, 1 */
+		L[0][0] = (1-s)*(1-2*s);  dL[0][0] = 4*s - 3;
+		L[0][1] = 4*s*(1-s);      dL[0][1] = 4 - 8*s;
+		L[0][2] = s*(2*s-1);      dL[0][2] = 4*s - 1;
+		L[1][0] = (1-t)*(1-2*t);  dL[1][0] = 4*t - 3;
+		L[1][1] = 4*t*(1-t);      dL[1][1] = 4 - 8*t;
+		L[1][2] = t*(2*t-1);      dL[1][2] = 4*t - 1;
+
+		for(n=0; n<9; n++)
+		{
+			dNdS[n] = dL[0][iS[n]]*L[1][iT[n]];
+			dNdT[n] = L[0][iS[n]]*dL[1][iT[n]];
+		}
+	}
+
+	xS = xT = yS = yT = 0;
+	for(n=0; n<numNodes; n++)
+	{
+		xS += dNdS[n]*Result->xQuadratic[node[n]];
+		xT += dNdT[n]*Result->xQuadratic[node[n]];
+		yS += dNdS[n]*Result->yQuadratic[node[n]];
+		yT += dNdT[n]*Result->yQuadratic[node[n]];
+	}
+
+	return xS*yT - xT*yS;
+}
@@ -0,0 +1,15 @@
+/*
+** Header-file for Quadratic
+*/
+
+#ifndef QUADRATIC_H
+#define QUADRATIC_H
+
+int    Quadratic(FILE*, tData*, tResult*);
+int    CoarseLines(int, int, int, int*, int*);
+int    QuadraticNode(tResult*, int*, int, int);
+int    QuadraticFolded(tResult*, int, double);
+int    StraightenQuadratic(tResult*, int);
+double QuadraticJacobian(tResult*, int, double, double);
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "gridgen.h"
 #include "quality.h"
+#include "loc.h"
 
 int Quality(FILE *log, tResult *Result)
 {
@@ -33,6 +34,24 @@ int Quality(FILE *log, tResult *Result)
 	skewness    = 0;
 	minAngle    = 0;
 
+	/* Allocate memory for the quality parameters of all elements */
+	free(Result->elementalArea);
+	free(Result->aspectRatio);
+	free(Result->skewness);
+	free(Result->minimumAngle);
+
+	Result->elementalArea = (double*)malloc(Result->numElements*sizeof(double));
+	Result->aspectRatio   = (double*)malloc(Result->numElements*sizeof(double));
+	Result->skewness      = (double*)malloc(Result->numElements*sizeof(double));
+	Result->minimumAngle  = (double*)malloc(Result->numElements*sizeof(double));
+
+	if ((Result->elementalArea == NULL) || (Result->aspectRatio == NULL) ||
+	    (Result->skewness == NULL)      || (Result->minimumAngle == NULL))
+	{
+		fprintf(stderr, "ERROR in function Quality: Could not allocate memory.\n");
+		ret = -1;
+	}
+
 	/* Calculate the elemental areas */
 	if (ret != -1)
 		ret = CalcElementalArea(&(*log), &(*Result));
@@ -58,19 +77,19 @@ int Quality(FILE *log, tResult *Result)
 
 		for(n=0; n<Result->numElements; n++)
 		{
-			if (Result->elementType == etTriangle)
+			if (TypeOfElement(&(*Result), n) == etTriangle)
 			{
-				area        = Result->element[n].triangle.elementalArea;
-				aspectRatio = Result->element[n].triangle.aspectRatio;
+				area        = Result->elementalArea[n];
+				aspectRatio = Result->aspectRatio[n];
 				skewness    = 0;
-				minAngle    = Result->element[n].triangle.minimumAngle;
+				minAngle    = Result->minimumAngle[n];
 			}
-			else if (Result->elementType == etQuadrangle)
+			else if (TypeOfElement(&(*Result), n) == etQuadrangle)
 			{
-				area        = Result->element[n].quadrangle.elementalArea;
-				aspectRatio = Result->element[n].quadrangle.aspectRatio;
-				skewness    = Result->element[n].quadrangle.skewness;
-				minAngle    = Result->element[n].quadrangle.minimumAngle;
+				area        = Result->elementalArea[n];
+				aspectRatio = Result->aspectRatio[n];
+				skewness    = Result->skewness[n];
+				minAngle    = Result->minimumAngle[n];
 			}
 			else
 			{
@@ -103,6 +122,7 @@ int CalcElementalArea(FILE *log, tResult *Result)
 	int ret;
 	int e;
 	int nodePrev, nodeCur, nodeNext;
+	int node[4];
 
 	double vecA[2], vecB[2];
 	double lengthA, lengthB;
@@ -113,14 +133,16 @@ int CalcElementalArea(FILE *log, tResult *Result)
 
 	ret = 0;
 
-	for(e=0; e<Result->numElements; e++)
+	for(e=0; e<Result->numElements && ret != -1; e++)
 	{
-		if(Result->elementType == etTriangle)
+		ret = CopyNodes(&(*Result), e, node);
+
+		if((ret != -1) && (TypeOfElement(&(*Result), e) == etTriangle))
 		{
 			/* Set up two vectors intersecting at node 1 */
-			nodePrev = Result->element[e].triangle.node[0];
-			nodeCur  = Result->element[e].triangle.node[1];
-			nodeNext = Result->element[e].triangle.node[2];
+			nodePrev = node[0];
+			nodeCur  = node[1];
+			nodeNext = node[2];
 
 			vecA[0] = Result->x[nodeCur] - Result->x[nodePrev];
 			vecA[1] = Result->y[nodeCur] - Result->y[nodePrev];
@@ -133,14 +155,14 @@ int CalcElementalArea(FILE *log, tResult *Result)
 			angle = acos((vecA[0]*vecB[0] + vecA[1]*vecB[1])/(lengthA*lengthB));
 			area  = 0.5*lengthA*lengthB*sin(angle);
 
-			Result->element[e].triangle.elementalArea = area;
+			Result->elementalArea[e] = area;
 		}
-		else if (Result->elementType == etQuadrangle)
+		else if ((ret != -1) && (TypeOfElement(&(*Result), e) == etQuadrangle))
 		{
 			/* Set up two vectors intersecting at node 1 */
-			nodePrev = Result->element[e].quadrangle.node[0];
-			nodeCur  = Result->element[e].quadrangle.node[1];
-			nodeNext = Result->element[e].quadrangle.node[2];
+			nodePrev = node[0];
+			nodeCur  = node[1];
+			nodeNext = node[2];
 
 			vecA[0] = Result->x[nodeCur] - Result->x[nodePrev];
 			vecA[1] = Result->y[nodeCur] - Result->y[nodePrev];
@@ -153,12 +175,7 @@ int CalcElementalArea(FILE *log, tResult *Result)
 			angle = acos((vecA[0]*vecB[0] + vecA[1]*vecB[1])/(lengthA*lengthB));
 			area  = lengthA*lengthB*sin(angle);
 
-			Result->element[e].quadrangle.elementalArea = area;
-		}
-		else
-		{
-			fprintf(stderr, "ERROR in funtion CalcSkewness: Unknown element type\n");
-			ret = -1;
+			Result->elementalArea[e] = area;
 		}
 	}
 
@@ -196,6 +213,7 @@ int CalcSkewness(FILE *log, tResult *Result)
 	int ret;
 	int e;
 	int nodeSE, nodeSW, nodeNW, nodeNE;
+	int node[4];
 
 	double diagNWSE, diagSWNE;
 	double skewness;
@@ -208,15 +226,27 @@ int CalcSkewness(FILE *log, tResult *Result)
 	{
 		fprintf(stderr, "\nWARNING in funtion CalcSkewness: Cannot calculate skewness of triangular elements\n");
 		fprintf(stderr, "Skipping...\n\n");
+
+		for (e = 0; e < Result->numElements; e++)
+			Result->skewness[e] = 0;
 	}
-	else if (Result->elementType == etQuadrangle)
+	else if (Result->elementType == etQuadrangle || Result->elementType == etMixed)
 	{
 		for (e = 0; e < Result->numElements; e++)
 		{
-			nodeSE = Result->element[e].quadrangle.node[0];
-			nodeSW = Result->element[e].quadrangle.node[1];
-			nodeNW = Result->element[e].quadrangle.node[2];
-			nodeNE = Result->element[e].quadrangle.node[3];
+			/* Triangles of a mixed grid have no skewness */
+			if (TypeOfElement(&(*Result), e) == etTriangle)
+			{
+				Result->skewness[e] = 0;
+				continue;
+			}
+
+			CopyNodes(&(*Result), e, node);
+
+			nodeSE = node[0];
+			nodeSW = node[1];
+			nodeNW = node[2];
+			nodeNE = node[3];
 
 			diagNWSE = sqrt(pow((Result->x[nodeNW] - Result->x[nodeSE]), 2) +
 		                	pow((Result->y[nodeNW] - Result->y[nodeSE]), 2));
@@ -225,7 +255,7 @@ int CalcSkewness(FILE *log, tResult *Result)
 
 			skewness = (diagNWSE > diagSWNE ? (diagSWNE/diagNWSE) : (diagNWSE/diagSWNE));
 
-			Result->element[e].quadrangle.skewness = skewness;
+			Result->skewness[e] = skewness;
 		}
 	}
 	else
@@ -267,7 +297,7 @@ int CalcAspectRatio(FILE *log, tResult *Result)
 {
 	int    ret;
 	int    e;
-	int    n, nn;
+	int    n, nn, numNodes;
 	int    *node;
 
 	double side, minSide, maxSide;
@@ -293,6 +323,8 @@ int CalcAspectRatio(FILE *log, tResult *Result)
 			if (ret != -1)
 				ret = CopyNodes(&(*Result), e, node);
 
+			numNodes = NodesOfElement(&(*Result), e);
+
 			if (ret != -1)
 			{
 				/*
@@ -306,10 +338,10 @@ int CalcAspectRatio(FILE *log, tResult *Result)
 				minSide  = side;
 
 				/* Now the rest of the sides to update minSide and maxSide */
-				for(n=1; n<Result->nodesPerElement; n++)
+				for(n=1; n<numNodes; n++)
 				{
 					/* Find next node */
-					nn = (n == Result->nodesPerElement-1 ? 0 : n+1);
+					nn = (n == numNodes-1 ? 0 : n+1);
 
 					/* calculate side length */
 					side = sqrt(pow(Result->x[node[n]] - Result->x[node[nn]], 2) +
@@ -323,10 +355,7 @@ int CalcAspectRatio(FILE *log, tResult *Result)
 				/*
 				** Calculate the aspect ratio of the element
 				*/
-				if (Result->elementType == etTriangle)
-					Result->element[e].triangle.aspectRatio = minSide / maxSide;
-				else if (Result->elementType == etQuadrangle)
-					Result->element[e].quadrangle.aspectRatio = minSide / maxSide;
+				Result->aspectRatio[e] = minSide / maxSide;
 			}
 		}
 	}
@@ -366,7 +395,7 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 {
 	int    ret;
 	int    e;
-	int    np, n, nn;
+	int    np, n, nn, numNodes;
 	int    *node = NULL;
 
 	double vecA[2], vecB[2];
@@ -394,6 +423,8 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 			if (ret != -1)
 				ret = CopyNodes(&(*Result), e, node);
 
+			numNodes = NodesOfElement(&(*Result), e);
+
 			if (ret != -1)
 			{
 				/*
@@ -402,8 +433,8 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 				*/
 
 				/* First the first angle to set minAngle */
-				vecA[0] = Result->x[node[Result->nodesPerElement-1]] - Result->x[node[0]];
-				vecA[1] = Result->y[node[Result->nodesPerElement-1]] - Result->y[node[0]];
+				vecA[0] = Result->x[node[numNodes-1]] - Result->x[node[0]];
+				vecA[1] = Result->y[node[numNodes-1]] - Result->y[node[0]];
 				vecB[0] = Result->x[node[1]] - Result->x[node[0]];
 				vecB[1] = Result->y[node[1]] - Result->y[node[0]];
 
@@ -414,11 +445,11 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 				minAngle = angle;
 		
 				/* Now the rest to update minAngle */
-				for (n=1; n<Result->nodesPerElement; n++)
+				for (n=1; n<numNodes; n++)
 				{
 					/* Find previous and next node */
-					np = (n == 0 ? Result->nodesPerElement-1 : n-1);
-					nn = (n == Result->nodesPerElement-1 ? 0 : n+1);
+					np = (n == 0 ? numNodes-1 : n-1);
+					nn = (n == numNodes-1 ? 0 : n+1);
 
 					vecA[0] = Result->x[node[np]] - Result->x[node[n]];
 					vecA[1] = Result->y[node[np]] - Result->y[node[n]];
@@ -433,10 +464,7 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 				}
 
 				/* Store minimum angle */
-				if (Result->elementType == etTriangle)
-					Result->element[e].triangle.minimumAngle = minAngle;
-				else if (Result->elementType == etQuadrangle)
-					Result->element[e].quadrangle.minimumAngle = minAngle;
+				Result->minimumAngle[e] = minAngle;
 			}
 		}
 	}
@@ -460,50 +488,3 @@ int CalcMinimumAngle(FILE *log, tResult *Result)
 
 	return ret;
 }
-
-/*
-** Function CopyNodes
-** Copies all nodes for element e to a temporary array.
-**
-** In:      tResult Result     = structure containing all results.
-**          int     element    = number identifying current element.
-** Out:     int     *nodes     = array with nodes
-** Return:  0 on success / -1 on failure
-**
-** Author:  J.L. Klaufus
-*/
-
-int CopyNodes(tResult *Result, int element, int *node)
-{
-	int ret;
-	int n;
-
-	/*printf("copying nodes...\n");*/
-
-	ret = 0;
-
-	/*
-	** Copy all nodes.
-	*/
-	if(Result->elementType == etTriangle)
-	{
-		/* Fill the nodes array */
-		for(n=0; n<Result->nodesPerElement; n++)
-			node[n] = Result->element[element].triangle.node[n];
-	}
-	else if(Result->elementType == etQuadrangle)
-	{
-		/* Fill the nodes array */
-		for(n=0; n<Result->nodesPerElement; n++)
-			node[n] = Result->element[element].quadrangle.node[n];
-	}
-	else
-	{
-		fprintf(stderr, "ERROR in function CopyNodes: Unknown element type.\n");
-		ret = -1;
-	}
-
-	return ret;
-}
-
-
@@ -10,6 +10,5 @@ int CalcElementalArea(FILE*, tResult*);
 int CalcSkewness(FILE*, tResult*);
 int CalcAspectRatio(FILE*, tResult*);
 int CalcMinimumAngle(FILE*, tResult*);
-int CopyNodes(tResult*, int, int*);
 
 #endif
@@ -0,0 +1,894 @@
+/*
+** Function Refine
+** Refines an unstructured grid locally by longest-edge bisection. Each
+** pass a target size is set at every node (SizingField); a triangle
+** whose longest edge exceeds the mean target size at the ends of that
+** edge has it marked. Every triangle with a marked edge then gets its
+** longest edge marked as well, so the refinement stays conforming: a
+** triangle is split at its longest edge into two, and its children
+** at the other marked edges into three or four triangles. Edges of
+** quadrangles, of folded triangles and on the cut are never bisected,
+** the latter to keep the nodes across the cut in pairs. New nodes on
+** the aerofoil are placed on its spline at the mean spline parameter of
+** the nodes of their edge (WallNode), taken around the end of the
+** parameter over the trailing edge; new boundary nodes take the patch
+** of their edge.
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.size: target sizes "x y h", used if refinementType
+**                         is 'F'.
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "spline.h"
+#include "refine.h"
+
+int Refine(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    i, e, k, h, g, n, pass, changed;
+	int    a, b, c, ab, bc, ca;
+	int    numEdges, numMarked, numChildren, numFrozen;
+	int    numNodesBefore, numElementsBefore, numInverted;
+	int    numSources, numNodesInitial, numElementsInitial;
+	int    npe;
+
+	int    *wall     = NULL;  /* 1 for nodes on the aerofoil           */
+	int    *newWall  = NULL;
+	int    *edgeOf   = NULL;  /* edge of each half-edge                */
+	int    *edgeHalf = NULL;  /* a half-edge of each edge              */
+	int    *marked   = NULL;  /* 1: bisect, -1: never bisect           */
+	int    *newNode  = NULL;  /* node at the middle of a marked edge   */
+	int    *longest  = NULL;  /* local longest edge of each triangle   */
+	int    *prevEdge = NULL;  /* previous boundary half-edge           */
+	int    *curved   = NULL;  /* 1 for new nodes placed on the spline  */
+	int    *parent   = NULL;  /* parent of each element of this pass   */
+	double *size     = NULL;
+	double *source   = NULL;
+	double *parameter    = NULL;  /* spline parameter of the aerofoil nodes */
+	double *newParameter = NULL;
+	double length, maxLength, orient;
+
+	tHalfEdge HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+
+	printf("Refining...\n");
+
+	ret                = 0;
+	numSources         = 0;
+	numNodesInitial    = Result->numNodes;
+	numElementsInitial = Result->numElements;
+	npe                = Result->nodesPerElement;
+
+	if ((Result->elementType != etTriangle && Result->elementType != etMixed) || Result->structuredElements)
+	{
+		fprintf(stderr, "ERROR in function Refine: Only triangles can be refined.\n");
+		return -1;
+	}
+
+	if (Data->refinementType == 'F')
+		ret = ReadSizingFile(&(*log), &numSources, &source);
+
+	/* The aerofoil nodes of ETA = 0 */
+	wall      = (int*)calloc(Result->numNodes, sizeof(int));
+	parameter = (double*)calloc(Result->numNodes, sizeof(double));
+
+	if (wall == NULL || parameter == NULL)
+	{
+		fprintf(stderr, "ERROR in function Refine: Could not allocate memory.\n");
+		ret = -1;
+	}
+	else
+	{
+		for(i=Data->numNodes2; i<Data->numNodes2+Data->numNodes1; i++)
+		{
+			wall[Loc(&(*Result), 0, i)]      = 1;
+			parameter[Loc(&(*Result), 0, i)] = Result->vNode[i - Data->numNodes2];
+		}
+	}
+
+	for(pass=0, numMarked=1; pass<NUMREFINEPASSES && ret != -1; pass++)
+	{
+		numNodesBefore    = Result->numNodes;
+		numElementsBefore = Result->numElements;
+
+		if (ret != -1)
+			ret = BuildHalfEdges(NULL, &(*Result), &HalfEdge);
+
+		/* Allocate memory */
+		edgeOf   = (int*)malloc(HalfEdge.numHalfEdges*sizeof(int));
+		edgeHalf = (int*)malloc(HalfEdge.numHalfEdges*sizeof(int));
+		marked   = (int*)calloc(HalfEdge.numHalfEdges, sizeof(int));
+		newNode  = (int*)malloc(HalfEdge.numHalfEdges*sizeof(int));
+		prevEdge = (int*)malloc(HalfEdge.numHalfEdges*sizeof(int));
+		longest  = (int*)malloc(Result->numElements*sizeof(int));
+		size     = (double*)malloc(Result->numNodes*sizeof(double));
+
+		if (ret == -1 || edgeOf == NULL || edgeHalf == NULL || marked == NULL || newNode == NULL ||
+		    prevEdge == NULL || longest == NULL || size == NULL)
+		{
+			fprintf(stderr, "ERROR in function Refine: Could not allocate memory.\n");
+			ret = -1;
+		}
+
+		numEdges    = 0;
+		numMarked   = 0;
+		numChildren = 0;
+		numFrozen   = 0;
+
+		if (ret != -1)
+		{
+			/* Number the edges; a pair of twins shares its edge */
+			for(h=0; h<HalfEdge.numHalfEdges; h++)
+			{
+				prevEdge[h] = -1;
+
+				if (HalfEdge.origin[h] == -1)
+					edgeOf[h] = -1;
+				else if (HalfEdge.twin[h] == -1 || HalfEdge.twin[h] > h)
+				{
+					edgeHalf[numEdges] = h;
+					edgeOf[h]          = numEdges++;
+				}
+			}
+
+			for(h=0; h<HalfEdge.numHalfEdges; h++)
+			{
+				if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] != -1 && HalfEdge.twin[h] < h)
+					edgeOf[h] = edgeOf[HalfEdge.twin[h]];
+
+				if (HalfEdge.boundaryNext[h] != -1)
+					prevEdge[HalfEdge.boundaryNext[h]] = h;
+			}
+
+			ret = SizingField(&(*Result), &HalfEdge, wall, prevEdge, numSources, source, size);
+		}
+
+		if (ret != -1)
+		{
+			/* Orientation of the grid, from its total area */
+			orient = 0;
+			for(e=0; e<Result->numElements; e++)
+				if (TypeOfElement(&(*Result), e) == etTriangle)
+					orient += TriangleOrientation(&(*Result), &HalfEdge, e);
+
+			/* Edges on the cut stay */
+			for(h=0; h<HalfEdge.numHalfEdges; h++)
+				if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] == -1 &&
+				    PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h)) == ptCut)
+					marked[edgeOf[h]] = -1;
+
+			/* Longest edge of every triangle; quadrangles and folded triangles stay */
+			for(e=0; e<Result->numElements; e++)
+			{
+				longest[e] = -1;
+
+				if (TypeOfElement(&(*Result), e) != etTriangle || TriangleOrientation(&(*Result), &HalfEdge, e)*orient <= 0)
+				{
+					for(k=0; k<NodesOfElement(&(*Result), e); k++)
+						marked[edgeOf[e*npe+k]] = -1;
+
+					continue;
+				}
+
+				maxLength = -1;
+				for(k=0; k<3; k++)
+				{
+					a      = HalfEdge.origin[e*npe+k];
+					b      = HalfEdgeDest(&HalfEdge, e*npe+k);
+					length = sqrt(pow(Result->x[b]-Result->x[a], 2) + pow(Result->y[b]-Result->y[a], 2));
+
+					if (length > maxLength)
+					{
+						maxLength  = length;
+						longest[e] = k;
+					}
+				}
+			}
+
+			/* A triangle whose longest edge may not be bisected is left as it is */
+			do
+			{
+				changed = 0;
+
+				for(e=0; e<Result->numElements; e++)
+				{
+					if (longest[e] != -1 && marked[edgeOf[e*npe+longest[e]]] == -1)
+					{
+						for(k=0; k<3; k++)
+							marked[edgeOf[e*npe+k]] = -1;
+
+						longest[e] = -1;
+						changed    = 1;
+						numFrozen++;
+					}
+				}
+			} while (changed);
+
+			/* Mark the longest edges that are too long */
+			for(e=0; e<Result->numElements; e++)
+			{
+				if (longest[e] == -1)
+					continue;
+
+				h = e*npe+longest[e];
+				a = HalfEdge.origin[h];
+				b = HalfEdgeDest(&HalfEdge, h);
+
+				length = sqrt(pow(Result->x[b]-Result->x[a], 2) + pow(Result->y[b]-Result->y[a], 2));
+
+				if (length > 0.5*(size[a] + size[b]))
+					marked[edgeOf[h]] = 1;
+			}
+
+			/* Conformity: a triangle with a marked edge is bisected at its longest edge */
+			do
+			{
+				changed = 0;
+
+				for(e=0; e<Result->numElements; e++)
+				{
+					if (longest[e] == -1 || marked[edgeOf[e*npe+longest[e]]] == 1)
+						continue;
+
+					for(k=0; k<3 && marked[edgeOf[e*npe+k]] != 1; k++);
+
+					if (k < 3)
+					{
+						marked[edgeOf[e*npe+longest[e]]] = 1;
+						changed = 1;
+					}
+				}
+			} while (changed);
+
+			/* Count the new nodes and elements */
+			for(n=0; n<numEdges; n++)
+			{
+				newNode[n] = -1;
+
+				if (marked[n] == 1)
+					newNode[n] = Result->numNodes + numMarked++;
+			}
+
+			for(e=0; e<Result->numElements; e++)
+				if (longest[e] != -1)
+					for(k=0; k<3; k++)
+						numChildren += (marked[edgeOf[e*npe+k]] == 1);
+		}
+
+		/* Make room for the new nodes and elements */
+		if (ret != -1 && numMarked > 0)
+		{
+			ret = ResizeGrid(&(*Result), Result->numNodes + numMarked, Result->numElements + numChildren);
+
+			newWall      = (int*)realloc(wall, Result->numNodes*sizeof(int));
+			newParameter = (double*)realloc(parameter, Result->numNodes*sizeof(double));
+			curved       = (int*)calloc(numMarked, sizeof(int));
+			parent       = (int*)malloc(Result->numElements*sizeof(int));
+
+			if (newWall != NULL)
+				wall = newWall;
+			if (newParameter != NULL)
+				parameter = newParameter;
+
+			if (ret == -1 || newWall == NULL || newParameter == NULL || curved == NULL || parent == NULL)
+			{
+				fprintf(stderr, "ERROR in function Refine: Could not allocate memory.\n");
+				ret = -1;
+			}
+		}
+
+		if (ret != -1 && numMarked > 0)
+		{
+			/* New nodes in the middle of the marked edges */
+			for(n=0; n<numEdges; n++)
+			{
+				if (newNode[n] == -1)
+					continue;
+
+				h = edgeHalf[n];
+				a = HalfEdge.origin[h];
+				b = HalfEdgeDest(&HalfEdge, h);
+
+				wall[newNode[n]] = (wall[a] && wall[b] && HalfEdge.twin[h] == -1);
+
+				MidNode(&(*Result), a, b, newNode[n]);
+
+				Result->patch[newNode[n]] = (HalfEdge.twin[h] == -1 ? PatchOfEdge(&(*Result), a, b) : ptInterior);
+
+				if (wall[newNode[n]])
+					curved[newNode[n]-numNodesBefore] = WallNode(&(*Result), &HalfEdge, parameter, h, newNode[n]);
+			}
+
+			/* Split the triangles */
+			for(e=0; e<numElementsBefore; e++)
+				parent[e] = e;
+
+			for(e=0; e<numElementsBefore; e++)
+			{
+				if (longest[e] == -1 || marked[edgeOf[e*npe+longest[e]]] != 1)
+					continue;
+
+				k  = longest[e];
+				a  = HalfEdge.origin[e*npe+k];
+				b  = HalfEdge.origin[e*npe+(k+1)%3];
+				c  = HalfEdge.origin[e*npe+(k+2)%3];
+				ab = newNode[edgeOf[e*npe+k]];
+				bc = newNode[edgeOf[e*npe+(k+1)%3]];
+				ca = newNode[edgeOf[e*npe+(k+2)%3]];
+
+				/* (a,b,c) becomes (a,ab,c) and (ab,b,c) */
+				g = Result->numElements - numChildren--;
+				parent[g] = e;
+
+				SetTriangle(&(*Result), e, a, ab, c);
+				SetTriangle(&(*Result), g, ab, b, c);
+
+				if (bc != -1)
+				{
+					/* (ab,b,c) becomes (ab,b,bc) and (ab,bc,c) */
+					SetTriangle(&(*Result), g, ab, b, bc);
+
+					g = Result->numElements - numChildren--;
+					parent[g] = e;
+
+					SetTriangle(&(*Result), g, ab, bc, c);
+				}
+
+				if (ca != -1)
+				{
+					/* (a,ab,c) becomes (a,ab,ca) and (ca,ab,c) */
+					SetTriangle(&(*Result), e, a, ab, ca);
+
+					g = Result->numElements - numChildren--;
+					parent[g] = e;
+
+					SetTriangle(&(*Result), g, ca, ab, c);
+				}
+			}
+
+			/*
+			** A node on the spline may fold a thin triangle near the wall;
+			** such nodes go back to the middle of their edge.
+			*/
+			do
+			{
+				numInverted = 0;
+
+				for(e=0; e<Result->numElements; e++)
+				{
+					if (TypeOfElement(&(*Result), e) != etTriangle || OrientationChanged(&(*Result), &HalfEdge, e, parent[e]) == 0)
+						continue;
+
+					for(k=0; k<3; k++)
+					{
+						n = Result->element[e].triangle.node[k];
+
+						if (n >= numNodesBefore && curved[n-numNodesBefore])
+						{
+							curved[n-numNodesBefore] = 0;
+							numInverted++;
+						}
+					}
+				}
+
+				if (numInverted > 0)
+					for(n=0; n<numEdges; n++)
+						if (newNode[n] != -1 && curved[newNode[n]-numNodesBefore] == 0)
+							MidNode(&(*Result), HalfEdge.origin[edgeHalf[n]], HalfEdgeDest(&HalfEdge, edgeHalf[n]), newNode[n]);
+			} while (numInverted > 0);
+		}
+
+		if (log && ret != -1)
+			fprintf(log, "pass %d: %d edges bisected, %d triangles kept next to quadrangles or folded triangles\n", pass+1, numMarked, numFrozen);
+
+		/* Free the memory of this pass */
+		FreeHalfEdges(&HalfEdge);
+
+		if (edgeOf)
+			free(edgeOf);
+
+		if (edgeHalf)
+			free(edgeHalf);
+
+		if (marked)
+			free(marked);
+
+		if (newNode)
+			free(newNode);
+
+		if (prevEdge)
+			free(prevEdge);
+
+		if (longest)
+			free(longest);
+
+		if (size)
+			free(size);
+
+		if (curved)
+			free(curved);
+
+		if (parent)
+			free(parent);
+
+		edgeOf   = NULL;
+		edgeHalf = NULL;
+		marked   = NULL;
+		newNode  = NULL;
+		prevEdge = NULL;
+		longest  = NULL;
+		size     = NULL;
+		curved   = NULL;
+		parent   = NULL;
+
+		if (numMarked == 0)
+			break;
+	}
+
+	printf("Number of nodes      = %d -> %d\n", numNodesInitial, Result->numNodes);
+	printf("Number of elements   = %d -> %d\n", numElementsInitial, Result->numElements);
+
+	/* Free allocated memory */
+	if (wall)
+		free(wall);
+
+	if (parameter)
+		free(parameter);
+
+	if (source)
+		free(source);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION REFINE *****\n\n");
+
+		fprintf(log, "refinement type      = %c\n", Data->refinementType);
+		fprintf(log, "size sources         = %d\n", numSources);
+		fprintf(log, "number of nodes      = %d -> %d\n", numNodesInitial, Result->numNodes);
+		fprintf(log, "number of elements   = %d -> %d\n", numElementsInitial, Result->numElements);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function SizingField
+** Sets the target size at every node: the longest edge at the node,
+** reduced on the aerofoil so that an edge there turns by at most
+** REFINEANGLE degrees, and reduced to the sizes of the sources of
+** gridgen.size. The sizes are then limited to grow by at most a factor
+** REFINEGRADING per edge, which also refines where the size of
+** neighbouring elements jumps.
+**
+** In:       tResult   Result   = structure containing Results
+**           tHalfEdge HalfEdge = half-edge structure of the grid
+**           int       wall     = 1 for nodes on the aerofoil
+**           int       prevEdge = previous boundary half-edge
+**           int       numSources, double source = sources "x y h"
+**
+** Out:      double    size     = target size at every node
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int SizingField(tResult *Result, tHalfEdge *HalfEdge, int *wall, int *prevEdge, int numSources, double *source, double *size)
+{
+	int    n, h, g, s, a, b, p, q, sweep, changed;
+	double length, lengthP, lengthQ, angle, cosine, distance;
+
+	double *x = Result->x;
+	double *y = Result->y;
+
+	/* Longest edge at every node */
+	for(n=0; n<Result->numNodes; n++)
+		size[n] = 0;
+
+	for(h=0; h<HalfEdge->numHalfEdges; h++)
+	{
+		if (HalfEdge->origin[h] == -1)
+			continue;
+
+		a      = HalfEdge->origin[h];
+		b      = HalfEdgeDest(&(*HalfEdge), h);
+		length = sqrt(pow(x[b]-x[a], 2) + pow(y[b]-y[a], 2));
+
+		size[a] = (length > size[a] ? length : size[a]);
+		size[b] = (length > size[b] ? length : size[b]);
+	}
+
+	/* Curvature of the aerofoil, from the turning angle at its nodes */
+	for(n=0; n<Result->numNodes; n++)
+	{
+		g = HalfEdge->nodeHalfEdge[n];
+
+		if (wall[n] == 0 || g == -1 || HalfEdge->twin[g] != -1 || prevEdge[g] == -1)
+			continue;
+
+		p = HalfEdge->origin[prevEdge[g]];
+		q = HalfEdgeDest(&(*HalfEdge), g);
+
+		lengthP = sqrt(pow(x[n]-x[p], 2) + pow(y[n]-y[p], 2));
+		lengthQ = sqrt(pow(x[q]-x[n], 2) + pow(y[q]-y[n], 2));
+
+		if (lengthP < SMALL || lengthQ < SMALL)
+			continue;
+
+		cosine = ((x[n]-x[p])*(x[q]-x[n]) + (y[n]-y[p])*(y[q]-y[n]))/(lengthP*lengthQ);
+		angle  = acos(cosine > 1 ? 1 : (cosine < -1 ? -1 : cosine));
+
+		if (angle > SMALL)
+		{
+			length  = (REFINEANGLE*PI/180)*0.5*(lengthP + lengthQ)/angle;
+			size[n] = (length < size[n] ? length : size[n]);
+		}
+	}
+
+	/* Sizes given by the user */
+	for(s=0; s<numSources; s++)
+	{
+		for(n=0; n<Result->numNodes; n++)
+		{
+			distance = sqrt(pow(x[n]-source[3*s], 2) + pow(y[n]-source[3*s+1], 2));
+			length   = source[3*s+2] + (REFINEGRADING-1)*distance;
+
+			size[n] = (length < size[n] ? length : size[n]);
+		}
+	}
+
+	/* Limit the growth of the size along the edges */
+	for(sweep=0, changed=1; changed && sweep<Result->numNodes; sweep++)
+	{
+		changed = 0;
+
+		for(h=0; h<HalfEdge->numHalfEdges; h++)
+		{
+			if (HalfEdge->origin[h] == -1)
+				continue;
+
+			a      = HalfEdge->origin[h];
+			b      = HalfEdgeDest(&(*HalfEdge), h);
+			length = sqrt(pow(x[b]-x[a], 2) + pow(y[b]-y[a], 2));
+
+			if (size[b] > size[a] + (REFINEGRADING-1)*length + SMALL)
+			{
+				size[b] = size[a] + (REFINEGRADING-1)*length;
+				changed = 1;
+			}
+			else if (size[a] > size[b] + (REFINEGRADING-1)*length + SMALL)
+			{
+				size[a] = size[b] + (REFINEGRADING-1)*length;
+				changed = 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+** Function ReadSizingFile
+** Reads the target sizes "x y h" from gridgen.size.
+**
+** Out:      int    numSources = number of sources
+**           double source     = x, y and h of every source
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ReadSizingFile(FILE *log, int *numSources, double **source)
+{
+	FILE   *sizeFile;
+	int    s;
+	double x, y, h;
+
+	*numSources = 0;
+	*source     = NULL;
+
+	sizeFile = fopen("gridgen.size", "r");
+	if (sizeFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadSizingFile: Could not open gridgen.size.\n");
+		return -1;
+	}
+
+	while (fscanf(sizeFile, "%lf %lf %lf", &x, &y, &h) == 3)
+		(*numSources)++;
+
+	rewind(sizeFile);
+
+	*source = (double*)malloc((*numSources > 0 ? 3*(*numSources) : 1)*sizeof(double));
+
+	if (*source == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadSizingFile: Could not allocate memory.\n");
+		fclose(sizeFile);
+		return -1;
+	}
+
+	for(s=0; s<*numSources; s++)
+		fscanf(sizeFile, "%lf %lf %lf", &(*source)[3*s], &(*source)[3*s+1], &(*source)[3*s+2]);
+
+	fclose(sizeFile);
+
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION READSIZINGFILE *****\n\n");
+
+		fprintf(log, "         x          y          h\n");
+		for(s=0; s<*numSources; s++)
+			fprintf(log, "%10.6f %10.6f %10.6f\n", (*source)[3*s], (*source)[3*s+1], (*source)[3*s+2]);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return 0;
+}
+
+/*
+** Function ResizeGrid
+** Enlarges the nodal arrays and the elements of the grid. The new
+** nodes are interior nodes until tagged otherwise; the new
+** elements are triangles.
+**
+** In:       int     numNodes    = new number of nodes
+**           int     numElements = new number of elements
+**
+** Out:      tResult Result      = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ResizeGrid(tResult *Result, int numNodes, int numElements)
+{
+	int    k, e, n;
+	int    *periodicNode;
+	double *array;
+
+	double **nodal[17];
+
+	tPatch       *patch;
+	tElement     *element;
+	tElementType *elementTypes;
+
+	nodal[0]  = &Result->x;        nodal[1]  = &Result->y;
+	nodal[2]  = &Result->xKsi;     nodal[3]  = &Result->xEta;
+	nodal[4]  = &Result->yKsi;     nodal[5]  = &Result->yEta;
+	nodal[6]  = &Result->xKsiKsi;  nodal[7]  = &Result->xEtaEta;
+	nodal[8]  = &Result->xKsiEta;  nodal[9]  = &Result->yKsiKsi;
+	nodal[10] = &Result->yEtaEta;  nodal[11] = &Result->yKsiEta;
+	nodal[12] = &Result->ksiX;     nodal[13] = &Result->ksiY;
+	nodal[14] = &Result->etaX;     nodal[15] = &Result->etaY;
+	nodal[16] = &Result->jac;
+
+	for(k=0; k<17; k++)
+	{
+		array = (double*)realloc(*nodal[k], numNodes*sizeof(double));
+
+		if (array == NULL)
+		{
+			fprintf(stderr, "ERROR in function ResizeGrid: Could not allocate memory.\n");
+			return -1;
+		}
+
+		*nodal[k] = array;
+	}
+
+	patch        = (tPatch*)realloc(Result->patch, numNodes*sizeof(tPatch));
+	periodicNode = (int*)realloc(Result->periodicNode, numNodes*sizeof(int));
+
+	if (patch != NULL)
+		Result->patch = patch;
+
+	if (periodicNode != NULL)
+		Result->periodicNode = periodicNode;
+
+	if (patch == NULL || periodicNode == NULL)
+	{
+		fprintf(stderr, "ERROR in function ResizeGrid: Could not allocate memory.\n");
+		return -1;
+	}
+
+	for(n=Result->numNodes; n<numNodes; n++)
+	{
+		patch[n]        = ptInterior;
+		periodicNode[n] = -1;
+	}
+
+	Result->numNodes = numNodes;
+
+	element = (tElement*)realloc(Result->element, numElements*sizeof(tElement));
+
+	if (element == NULL)
+	{
+		fprintf(stderr, "ERROR in function ResizeGrid: Could not allocate memory.\n");
+		return -1;
+	}
+
+	Result->element = element;
+
+	if (Result->elementTypes != NULL)
+	{
+		elementTypes = (tElementType*)realloc(Result->elementTypes, numElements*sizeof(tElementType));
+
+		if (elementTypes == NULL)
+		{
+			fprintf(stderr, "ERROR in function ResizeGrid: Could not allocate memory.\n");
+			return -1;
+		}
+
+		for(e=Result->numElements; e<numElements; e++)
+			elementTypes[e] = etTriangle;
+
+		Result->elementTypes = elementTypes;
+	}
+
+	Result->numElements = numElements;
+
+	return 0;
+}
+
+/*
+** Function MidNode
+** Sets node n in the middle of nodes a and b; the metrics are
+** averaged.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int MidNode(tResult *Result, int a, int b, int n)
+{
+	int    k;
+
+	double *nodal[17];
+
+	nodal[0]  = Result->x;        nodal[1]  = Result->y;
+	nodal[2]  = Result->xKsi;     nodal[3]  = Result->xEta;
+	nodal[4]  = Result->yKsi;     nodal[5]  = Result->yEta;
+	nodal[6]  = Result->xKsiKsi;  nodal[7]  = Result->xEtaEta;
+	nodal[8]  = Result->xKsiEta;  nodal[9]  = Result->yKsiKsi;
+	nodal[10] = Result->yEtaEta;  nodal[11] = Result->yKsiEta;
+	nodal[12] = Result->ksiX;     nodal[13] = Result->ksiY;
+	nodal[14] = Result->etaX;     nodal[15] = Result->etaY;
+	nodal[16] = Result->jac;
+
+	for(k=0; k<17; k++)
+		nodal[k][n] = 0.5*(nodal[k][a] + nodal[k][b]);
+
+	return 0;
+}
+
+/*
+** Function WallNode
+** Moves node n, in the middle of boundary half-edge h on the aerofoil,
+** onto the aerofoil spline halfway between the spline parameters of the
+** nodes of the edge. An edge over the trailing edge, where the parameter
+** runs from the last knot back to the first, is taken around the end.
+**
+** In:       double parameter = spline parameter of the aerofoil nodes
+**
+** Out:      double parameter = also of node n
+**
+** Return:   1, the node was moved
+**
+** Author:   J.L. Klaufus
+*/
+
+int WallNode(tResult *Result, tHalfEdge *HalfEdge, double *parameter, int h, int n)
+{
+	int    a, b;
+	double vA, vB, range;
+
+	tSpline *Aerofoil = &Result->spline;
+
+	a = HalfEdge->origin[h];
+	b = HalfEdgeDest(&(*HalfEdge), h);
+
+	vA    = parameter[a];
+	vB    = parameter[b];
+	range = Aerofoil->u[Aerofoil->numKnots-1] - Aerofoil->u[0];
+
+	if (vB - vA > range/2)
+		vB -= range;
+	else if (vA - vB > range/2)
+		vA -= range;
+
+	parameter[n] = (vA + vB)/2;
+	if (parameter[n] < Aerofoil->u[0])
+		parameter[n] += range;
+
+	EvaluateSpline(&(*Aerofoil), 1, &parameter[n], &Result->x[n], &Result->y[n]);
+
+	return 1;
+}
+
+/*
+** Function SetTriangle
+** Sets the nodes of triangle e.
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int SetTriangle(tResult *Result, int e, int a, int b, int c)
+{
+	Result->element[e].triangle.node[0] = a;
+	Result->element[e].triangle.node[1] = b;
+	Result->element[e].triangle.node[2] = c;
+
+	return 0;
+}
+
+/*
+** Function OrientationChanged
+** Compares the orientation of triangle e with that of its parent, whose
+** nodes are still in the half-edge structure.
+**
+** Return:   1 if the orientation differs, 0 otherwise
+**
+** Author:   J.L. Klaufus
+*/
+
+int OrientationChanged(tResult *Result, tHalfEdge *HalfEdge, int e, int parent)
+{
+	int    a, b, c;
+	double orientChild;
+
+	double *x = Result->x;
+	double *y = Result->y;
+
+	a = Result->element[e].triangle.node[0];
+	b = Result->element[e].triangle.node[1];
+	c = Result->element[e].triangle.node[2];
+
+	orientChild = (x[b]-x[a])*(y[c]-y[a]) - (y[b]-y[a])*(x[c]-x[a]);
+
+	return (orientChild*TriangleOrientation(&(*Result), &(*HalfEdge), parent) <= 0);
+}
+
+/*
+** Function TriangleOrientation
+** Returns twice the signed area of triangle e of the half-edge
+** structure; positive if its nodes are counter-clockwise.
+**
+** Author:   J.L. Klaufus
+*/
+
+double TriangleOrientation(tResult *Result, tHalfEdge *HalfEdge, int e)
+{
+	int    a, b, c;
+
+	double *x = Result->x;
+	double *y = Result->y;
+
+	a = HalfEdge->origin[e*HalfEdge->nodesPerElement];
+	b = HalfEdge->origin[e*HalfEdge->nodesPerElement+1];
+	c = HalfEdge->origin[e*HalfEdge->nodesPerElement+2];
+
+	return (x[b]-x[a])*(y[c]-y[a]) - (y[b]-y[a])*(x[c]-x[a]);
+}
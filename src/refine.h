@@ -0,0 +1,18 @@
+/*
+** Header-file for Refine
+*/
+
+#ifndef REFINE_H
+#define REFINE_H
+
+int Refine(FILE*, tData*, tResult*);
+int SizingField(tResult*, tHalfEdge*, int*, int*, int, double*, double*);
+int ReadSizingFile(FILE*, int*, double**);
+int ResizeGrid(tResult*, int, int);
+int MidNode(tResult*, int, int, int);
+int WallNode(tResult*, tHalfEdge*, double*, int, int);
+int SetTriangle(tResult*, int, int, int, int);
+int OrientationChanged(tResult*, tHalfEdge*, int, int);
+double TriangleOrientation(tResult*, tHalfEdge*, int);
+
+#endif
@@ -0,0 +1,179 @@
+/*
+** Function Relax
+** One sweep of zebra line relaxation of the elliptic grid equations,
+** alpha (x_ksiksi + phi x_ksi) - 2 beta x_ksieta + gamma (x_etaeta +
+** psi x_eta) = 0 and the same for y. The lines run along eta, from the
+** aerofoil and the cut to the wall, where the grid is stretched most
+** and the coupling strongest. Every other line is solved implicitly,
+** first the odd lines of i and then the even ones, each from the
+** other lines as they stand. The lines of one half sweep are therefore
+** independent and are solved together, one line per vector lane, with
+** the coefficients frozen at the current grid. The nodes are then moved
+** towards the line solutions by omegaElliptic.
+**
+** In:       tData    Data     = Structure containing read data
+**           tResult  Result   = Structure containg results
+**           double   phi, psi = source terms of Middlecoff; NULL: none
+**           double   work     = 5 im jm doubles of workspace
+**
+** Out:      tResult  Result   = Structure containg results
+**           double   resMax   = raised to the largest residue of the sweep
+**
+** Return:   0 on success; -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "relax.h"
+#include "loc.h"
+#include "sy.h"
+
+int Relax(tData *Data, tResult *Result, double *phi, double *psi, double *work, double *resMax)
+{
+	int    i, j, k, n, p;
+	int    im, jm;
+
+	int    loc;
+	int    loc_ksi_up, loc_ksi_down;
+	int    loc_eta_up, loc_eta_down;
+	int    loc_ksi_up_eta_up, loc_ksi_up_eta_down;
+	int    loc_ksi_down_eta_up, loc_ksi_down_eta_down;
+
+	double x1, x2, x3, x4, x5, x6, x7, x8, x9;
+	double y1, y2, y3, y4, y5, y6, y7, y8, y9;
+
+	double xKsi, xEta, xKsiKsi, xKsiEta, xEtaEta;
+	double yKsi, yEta, yKsiKsi, yKsiEta, yEtaEta;
+
+	double alpha, beta, gamma;
+	double phiLoc, psiLoc;
+
+	double resX, resY;
+	double omega;
+
+	double *bb, *dd, *aa, *cx, *cy;
+
+	im    = Result->im;
+	jm    = Result->jm;
+	omega = Data->omegaElliptic;
+
+	for(p=1; p<=2 && p<im-1; p++)
+	{
+		/* Lines i = p, p+2, ..., im-2; row j of line k at j*n + k */
+		n  = (im-2 - p)/2 + 1;
+		bb = work;
+		dd = bb + jm*n;
+		aa = dd + jm*n;
+		cx = aa + jm*n;
+		cy = cx + jm*n;
+
+		for(j=1; j<jm-1; j++)
+		{
+			for(k=0; k<n; k++)
+			{
+				i = p + 2*k;
+
+				/* Find all positions in arrays */
+				loc                   = Loc(&(*Result), j, i);
+				loc_ksi_up            = Loc(&(*Result), j, i+1);
+				loc_ksi_down          = Loc(&(*Result), j, i-1);
+				loc_eta_up            = Loc(&(*Result), j+1, i);
+				loc_eta_down          = Loc(&(*Result), j-1, i);
+				loc_ksi_up_eta_up     = Loc(&(*Result), j+1, i+1);
+				loc_ksi_up_eta_down   = Loc(&(*Result), j-1, i+1);
+				loc_ksi_down_eta_up   = Loc(&(*Result), j+1, i-1);
+				loc_ksi_down_eta_down = Loc(&(*Result), j-1, i-1);
+
+				/* Get co-ordinates */
+				x1     = Result->x[loc];
+				x2     = Result->x[loc_ksi_up];
+				x3     = Result->x[loc_ksi_down];
+				x4     = Result->x[loc_eta_up];
+				x5     = Result->x[loc_eta_down];
+				x6     = Result->x[loc_ksi_up_eta_up];
+				x7     = Result->x[loc_ksi_up_eta_down];
+				x8     = Result->x[loc_ksi_down_eta_up];
+				x9     = Result->x[loc_ksi_down_eta_down];
+
+				y1     = Result->y[loc];
+				y2     = Result->y[loc_ksi_up];
+				y3     = Result->y[loc_ksi_down];
+				y4     = Result->y[loc_eta_up];
+				y5     = Result->y[loc_eta_down];
+				y6     = Result->y[loc_ksi_up_eta_up];
+				y7     = Result->y[loc_ksi_up_eta_down];
+				y8     = Result->y[loc_ksi_down_eta_up];
+				y9     = Result->y[loc_ksi_down_eta_down];
+
+				/* Calculate the metrics */
+				xKsi    = (x2-x3)/2;
+				xEta    = (x4-x5)/2;
+				xKsiKsi = (x2-2*x1+x3);
+				xKsiEta = (x6-x7-x8+x9)/4;
+				xEtaEta = (x4-2*x1+x5);
+
+				yKsi    = (y2-y3)/2;
+				yEta    = (y4-y5)/2;
+				yKsiKsi = (y2-2*y1+y3);
+				yKsiEta = (y6-y7-y8+y9)/4;
+				yEtaEta = (y4-2*y1+y5);
+
+				/* Calculate the coefficients */
+				alpha  = xEta*xEta + yEta*yEta;
+				beta   = xKsi*xEta + yKsi*yEta;
+				gamma  = xKsi*xKsi + yKsi*yKsi;
+				phiLoc = (phi ? phi[loc] : 0);
+				psiLoc = (psi ? psi[loc] : 0);
+
+				/* Calculate the residues */
+				resX = alpha*(xKsiKsi+phiLoc*xKsi) - 2*beta*xKsiEta + gamma*(xEtaEta+psiLoc*xEta);
+				resY = alpha*(yKsiKsi+phiLoc*yKsi) - 2*beta*yKsiEta + gamma*(yEtaEta+psiLoc*yEta);
+
+				*resMax = (fabs(resX) > *resMax) ? fabs(resX) : *resMax;
+				*resMax = (fabs(resY) > *resMax) ? fabs(resY) : *resMax;
+
+				/* Implicit along the line, the neighbouring lines as they stand */
+				bb[j*n+k] = gamma*(1 - psiLoc/2);
+				dd[j*n+k] = -2*(alpha + gamma);
+				aa[j*n+k] = gamma*(1 + psiLoc/2);
+				cx[j*n+k] = -alpha*(x2+x3 + phiLoc*xKsi) + 2*beta*xKsiEta;
+				cy[j*n+k] = -alpha*(y2+y3 + phiLoc*yKsi) + 2*beta*yKsiEta;
+
+				/* The aerofoil, the cut and the wall */
+				if (j == 1)
+				{
+					cx[j*n+k] -= bb[j*n+k]*x5;
+					cy[j*n+k] -= bb[j*n+k]*y5;
+				}
+				if (j == jm-2)
+				{
+					cx[j*n+k] -= aa[j*n+k]*x4;
+					cy[j*n+k] -= aa[j*n+k]*y4;
+				}
+			}
+		}
+
+		/* Solve all lines at once */
+		SYBatchFactor(1, jm-2, n, bb, dd, aa);
+		SYBatchSolve(1, jm-2, n, bb, dd, aa, cx);
+		SYBatchSolve(1, jm-2, n, bb, dd, aa, cy);
+
+		/* Rebuild the physical space */
+		for(j=1; j<jm-1; j++)
+		{
+			for(k=0; k<n; k++)
+			{
+				loc = Loc(&(*Result), j, p + 2*k);
+
+				Result->x[loc] += omega*(cx[j*n+k] - Result->x[loc]);
+				Result->y[loc] += omega*(cy[j*n+k] - Result->y[loc]);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,10 @@
+/*
+** Header-file for Relax
+*/
+
+#ifndef RELAX_H
+#define RELAX_H
+
+int Relax(tData*, tResult*, double*, double*, double*, double*);
+
+#endif
@@ -0,0 +1,673 @@
+/*
+** Function Renumber
+** Renumbers the nodes and elements of the grid before it is written,
+** to reduce the bandwidth of the matrices of a solver and to improve
+** its memory access. The nodes are ordered by reverse Cuthill-McKee
+** (renumberingType 'R') or along a Hilbert curve ('H'); the elements
+** follow in the order of their lowest node number. The co-ordinates,
+** all metric arrays, the boundary patches, the connectivity and the
+** quality arrays are permuted; Result->nodeNumber keeps the new number
+** of each (j,i).
+**
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "adjacency.h"
+#include "delaunay.h"
+#include "renumber.h"
+
+int Renumber(FILE *log, tData *Data, tResult *Result)
+{
+	int    ret;
+	int    n, e, k, m, a;
+	int    numNodes, numElements;
+	int    bandwidthBefore, bandwidthAfter;
+	long   profileBefore, profileAfter;
+
+	int    *newToOld     = NULL;
+	int    *oldToNew     = NULL;
+	int    *elementStart = NULL;
+	int    *elementOrder = NULL;
+	int    *lowest       = NULL;
+	int    *periodicNode = NULL;
+	double *work         = NULL;
+
+	tPatch       *patch        = NULL;
+	tElement     *element      = NULL;
+	tElementType *elementTypes = NULL;
+	tHalfEdge    HalfEdge      = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+	tAdjacency   Adjacency     = {0, NULL, NULL, NULL, 0, NULL, NULL};
+
+	double *array[17];
+
+	printf("Renumbering...\n");
+
+	ret         = 0;
+	numNodes    = Result->numNodes;
+	numElements = Result->numElements;
+
+	/* Structured connectivity no longer follows from (j,i) */
+	if (ret != -1)
+		ret = ExplicitElements(&(*Result));
+
+	if (ret != -1)
+		ret = BandwidthProfile(&(*Result), &bandwidthBefore, &profileBefore);
+
+	newToOld     = (int*)malloc(numNodes*sizeof(int));
+	oldToNew     = (int*)malloc(numNodes*sizeof(int));
+	elementStart = (int*)calloc(numNodes+1, sizeof(int));
+	elementOrder = (int*)malloc((numElements > 0 ? numElements : 1)*sizeof(int));
+	lowest       = (int*)malloc((numElements > 0 ? numElements : 1)*sizeof(int));
+	work         = (double*)malloc((numElements > numNodes ? numElements : numNodes)*sizeof(double));
+	element      = (tElement*)malloc((numElements > 0 ? numElements : 1)*sizeof(tElement));
+
+	if (newToOld == NULL || oldToNew == NULL || elementStart == NULL || elementOrder == NULL ||
+	    lowest == NULL || work == NULL || element == NULL)
+	{
+		fprintf(stderr, "ERROR in function Renumber: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	/* Order the nodes */
+	if (ret != -1)
+	{
+		if (Data->renumberingType == 'H')
+		{
+			ret = OrderHilbert(&(*Result), newToOld);
+		}
+		else
+		{
+			if (ret != -1)
+				ret = BuildHalfEdges(&(*log), &(*Result), &HalfEdge);
+
+			if (ret != -1)
+				ret = BuildAdjacency(&(*log), &HalfEdge, &Adjacency);
+
+			if (ret != -1)
+				ret = OrderCuthillMcKee(&Adjacency, newToOld);
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(n=0; n<numNodes; n++)
+			oldToNew[newToOld[n]] = n;
+
+		/* Permute the nodal arrays */
+		array[0]  = Result->x;        array[1]  = Result->y;
+		array[2]  = Result->xKsi;     array[3]  = Result->xEta;
+		array[4]  = Result->yKsi;     array[5]  = Result->yEta;
+		array[6]  = Result->xKsiKsi;  array[7]  = Result->xEtaEta;
+		array[8]  = Result->xKsiEta;  array[9]  = Result->yKsiKsi;
+		array[10] = Result->yEtaEta;  array[11] = Result->yKsiEta;
+		array[12] = Result->ksiX;     array[13] = Result->ksiY;
+		array[14] = Result->etaX;     array[15] = Result->etaY;
+		array[16] = Result->jac;
+
+		for(k=0; k<17; k++)
+			PermuteNodalArray(array[k], newToOld, numNodes, work);
+
+		/* The boundary patches and the pairs across the cut follow their nodes */
+		patch        = (tPatch*)malloc(numNodes*sizeof(tPatch));
+		periodicNode = (int*)malloc(numNodes*sizeof(int));
+
+		if (patch == NULL || periodicNode == NULL)
+		{
+			fprintf(stderr, "ERROR in function Renumber: Could not allocate memory.\n");
+			ret = -1;
+		}
+		else
+		{
+			for(n=0; n<numNodes; n++)
+			{
+				a               = Result->periodicNode[newToOld[n]];
+				patch[n]        = Result->patch[newToOld[n]];
+				periodicNode[n] = (a == -1 ? -1 : oldToNew[a]);
+			}
+
+			free(Result->patch);
+			free(Result->periodicNode);
+
+			Result->patch        = patch;
+			Result->periodicNode = periodicNode;
+			patch                = NULL;
+			periodicNode         = NULL;
+		}
+
+		/* Renumber the connectivity; note the lowest node of each element */
+		for(e=0; e<numElements; e++)
+		{
+			lowest[e] = numNodes;
+
+			for(k=0; k<NodesOfElement(&(*Result), e); k++)
+			{
+				if (TypeOfElement(&(*Result), e) == etTriangle)
+					a = Result->element[e].triangle.node[k] = oldToNew[Result->element[e].triangle.node[k]];
+				else
+					a = Result->element[e].quadrangle.node[k] = oldToNew[Result->element[e].quadrangle.node[k]];
+
+				lowest[e] = (a < lowest[e] ? a : lowest[e]);
+			}
+
+			elementStart[lowest[e]+1]++;
+		}
+
+		/* Order the elements by their lowest node (stable counting sort) */
+		for(n=0; n<numNodes; n++)
+			elementStart[n+1] += elementStart[n];
+
+		for(e=0; e<numElements; e++)
+			elementOrder[elementStart[lowest[e]]++] = e;
+
+		for(m=0; m<numElements; m++)
+			element[m] = Result->element[elementOrder[m]];
+
+		free(Result->element);
+		Result->element = element;
+		element         = NULL;
+
+		/* The types of a mixed grid follow their elements */
+		if (Result->elementTypes != NULL)
+		{
+			elementTypes = (tElementType*)malloc((numElements > 0 ? numElements : 1)*sizeof(tElementType));
+
+			if (elementTypes == NULL)
+			{
+				fprintf(stderr, "ERROR in function Renumber: Could not allocate memory.\n");
+				ret = -1;
+			}
+			else
+			{
+				for(m=0; m<numElements; m++)
+					elementTypes[m] = Result->elementTypes[elementOrder[m]];
+
+				free(Result->elementTypes);
+				Result->elementTypes = elementTypes;
+			}
+		}
+
+		/* Permute the elemental quality arrays alike */
+		array[0] = Result->elementalArea;
+		array[1] = Result->aspectRatio;
+		array[2] = Result->skewness;
+		array[3] = Result->minimumAngle;
+
+		for(k=0; k<4; k++)
+			if (array[k] != NULL)
+				PermuteNodalArray(array[k], elementOrder, numElements, work);
+
+		/* Keep the new number of every (j,i) */
+		if (Result->nodeNumber != NULL)
+		{
+			/* Renumbered or compacted before: compose */
+			for(n=0; n<Result->im*Result->jm; n++)
+				Result->nodeNumber[n] = oldToNew[Result->nodeNumber[n]];
+		}
+		else
+		{
+			Result->nodeNumber = oldToNew;
+			oldToNew           = NULL;
+		}
+	}
+
+	if (ret != -1)
+		ret = BandwidthProfile(&(*Result), &bandwidthAfter, &profileAfter);
+
+	if (ret != -1)
+	{
+		printf("Bandwidth            = %d -> %d\n", bandwidthBefore, bandwidthAfter);
+		printf("Profile              = %ld -> %ld\n", profileBefore, profileAfter);
+	}
+
+	/* Free allocated memory */
+	FreeHalfEdges(&HalfEdge);
+	FreeAdjacency(&Adjacency);
+
+	if (newToOld)
+		free(newToOld);
+
+	if (oldToNew)
+		free(oldToNew);
+
+	if (patch)
+		free(patch);
+
+	if (periodicNode)
+		free(periodicNode);
+
+	if (elementStart)
+		free(elementStart);
+
+	if (elementOrder)
+		free(elementOrder);
+
+	if (lowest)
+		free(lowest);
+
+	if (work)
+		free(work);
+
+	if (element)
+		free(element);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION RENUMBER *****\n\n");
+
+		if (ret != -1)
+		{
+			fprintf(log, "renumbering type     = %c\n", Data->renumberingType);
+			fprintf(log, "bandwidth before     = %d\n", bandwidthBefore);
+			fprintf(log, "bandwidth after      = %d\n", bandwidthAfter);
+			fprintf(log, "profile before       = %ld\n", profileBefore);
+			fprintf(log, "profile after        = %ld\n", profileAfter);
+		}
+		else
+		{
+			fprintf(log, "NOT succesfully renumbered.\n");
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function ExplicitElements
+** Stores the connectivity of implicit structured elements in the
+** element array, so that the elements can be renumbered.
+**
+** In:       tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ExplicitElements(tResult *Result)
+{
+	int    e, k;
+	int    node[4];
+
+	if (Result->structuredElements == 0)
+		return 0;
+
+	if (Result->element != NULL)
+		free(Result->element);
+
+	Result->element = (tElement*)malloc((Result->numElements > 0 ? Result->numElements : 1)*sizeof(tElement));
+
+	if (Result->element == NULL)
+	{
+		fprintf(stderr, "ERROR in function ExplicitElements: Could not allocate memory.\n");
+		return -1;
+	}
+
+	for(e=0; e<Result->numElements; e++)
+	{
+		CopyNodes(&(*Result), e, node);
+
+		for(k=0; k<Result->nodesPerElement; k++)
+		{
+			if (Result->elementType == etTriangle)
+				Result->element[e].triangle.node[k] = node[k];
+			else
+				Result->element[e].quadrangle.node[k] = node[k];
+		}
+	}
+
+	Result->structuredElements = 0;
+
+	return 0;
+}
+
+/*
+** Function BandwidthProfile
+** Calculates the bandwidth and the profile (envelope) of the matrix
+** that couples all nodes of every element.
+**
+** In:       tResult Result    = structure containing Results
+**
+** Out:      int     bandwidth = largest difference of coupled node numbers
+**           long    profile   = sum over the nodes of the distance to the
+**                               lowest coupled node
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int BandwidthProfile(tResult *Result, int *bandwidth, long *profile)
+{
+	int    n, e, k, l;
+	int    numNodes;
+	int    node[4];
+
+	int    *lowest = NULL;
+
+	numNodes   = Result->numNodes;
+	*bandwidth = 0;
+	*profile   = 0;
+
+	lowest = (int*)malloc(numNodes*sizeof(int));
+
+	if (lowest == NULL)
+	{
+		fprintf(stderr, "ERROR in function BandwidthProfile: Could not allocate memory.\n");
+		return -1;
+	}
+
+	for(n=0; n<numNodes; n++)
+		lowest[n] = n;
+
+	for(e=0; e<Result->numElements; e++)
+	{
+		CopyNodes(&(*Result), e, node);
+
+		for(k=0; k<NodesOfElement(&(*Result), e); k++)
+			for(l=0; l<NodesOfElement(&(*Result), e); l++)
+				lowest[node[k]] = (node[l] < lowest[node[k]] ? node[l] : lowest[node[k]]);
+	}
+
+	for(n=0; n<numNodes; n++)
+	{
+		*bandwidth = (n - lowest[n] > *bandwidth ? n - lowest[n] : *bandwidth);
+		*profile  += n - lowest[n];
+	}
+
+	free(lowest);
+
+	return 0;
+}
+
+/*
+** Function OrderCuthillMcKee
+** Orders the nodes by reverse Cuthill-McKee. Every connected part
+** starts at a pseudo-peripheral node (George and Liu), and is
+** traversed breadth first, visiting the neighbours by increasing
+** degree. The complete order is reversed at the end.
+**
+** In:       tAdjacency Adjacency = node-to-node adjacency
+**
+** Out:      int        newToOld  = old number of each new node number
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int OrderCuthillMcKee(tAdjacency *Adjacency, int *newToOld)
+{
+	int    n, h, k, m, seed, root, pass;
+	int    head, tail, count, levelStart, levelEnd, depth, newDepth;
+	int    numNodes, candidate, tmp;
+
+	int    *visited = NULL;
+	int    *stamp   = NULL;
+	int    *queue   = NULL;
+
+	numNodes = Adjacency->numNodes;
+
+	visited = (int*)calloc(numNodes, sizeof(int));
+	stamp   = (int*)malloc(numNodes*sizeof(int));
+	queue   = (int*)malloc(numNodes*sizeof(int));
+
+	if (visited == NULL || stamp == NULL || queue == NULL)
+	{
+		fprintf(stderr, "ERROR in function OrderCuthillMcKee: Could not allocate memory.\n");
+
+		if (visited)
+			free(visited);
+
+		if (stamp)
+			free(stamp);
+
+		if (queue)
+			free(queue);
+
+		return -1;
+	}
+
+	for(n=0; n<numNodes; n++)
+		stamp[n] = -1;
+
+	count = 0;
+	pass  = 0;
+
+	for(seed=0; seed<numNodes; seed++)
+	{
+		if (visited[seed])
+			continue;
+
+		/* Pseudo-peripheral node: restart from the far end while the depth grows */
+		root  = seed;
+		depth = -1;
+
+		for(k=0; k<numNodes; k++)
+		{
+			/* Level structure from root; the last level is queue[levelStart..levelEnd-1] */
+			pass++;
+			tail          = 0;
+			queue[tail++] = root;
+			stamp[root]   = pass;
+			levelStart    = 0;
+			levelEnd      = 1;
+			newDepth      = 0;
+
+			while (1)
+			{
+				for(m=levelStart; m<levelEnd; m++)
+				{
+					n = queue[m];
+					for(h=Adjacency->start[n]; h<Adjacency->start[n+1]; h++)
+					{
+						if (stamp[Adjacency->node[h]] != pass)
+						{
+							stamp[Adjacency->node[h]] = pass;
+							queue[tail++] = Adjacency->node[h];
+						}
+					}
+				}
+
+				if (tail == levelEnd)
+					break;
+
+				levelStart = levelEnd;
+				levelEnd   = tail;
+				newDepth++;
+			}
+
+			if (newDepth <= depth)
+				break;
+
+			depth = newDepth;
+
+			/* Node of lowest degree in the last level */
+			candidate = queue[levelStart];
+			for(m=levelStart+1; m<levelEnd; m++)
+			{
+				if (Adjacency->start[queue[m]+1] - Adjacency->start[queue[m]] <
+				    Adjacency->start[candidate+1] - Adjacency->start[candidate])
+					candidate = queue[m];
+			}
+
+			if (candidate == root)
+				break;
+
+			root = candidate;
+		}
+
+		/* Cuthill-McKee from root */
+		head = count;
+		newToOld[count++] = root;
+		visited[root]     = 1;
+
+		while (head < count)
+		{
+			n = newToOld[head++];
+			m = count;
+
+			for(h=Adjacency->start[n]; h<Adjacency->start[n+1]; h++)
+			{
+				if (visited[Adjacency->node[h]] == 0)
+				{
+					visited[Adjacency->node[h]] = 1;
+					newToOld[count++] = Adjacency->node[h];
+				}
+			}
+
+			/* Sort the new neighbours by increasing degree */
+			for(h=m+1; h<count; h++)
+			{
+				tmp = newToOld[h];
+				for(k=h; k>m && (Adjacency->start[newToOld[k-1]+1] - Adjacency->start[newToOld[k-1]]) >
+				                (Adjacency->start[tmp+1] - Adjacency->start[tmp]); k--)
+					newToOld[k] = newToOld[k-1];
+				newToOld[k] = tmp;
+			}
+		}
+	}
+
+	/* Reverse */
+	for(n=0; n<numNodes/2; n++)
+	{
+		tmp                     = newToOld[n];
+		newToOld[n]             = newToOld[numNodes-1-n];
+		newToOld[numNodes-1-n]  = tmp;
+	}
+
+	free(visited);
+	free(stamp);
+	free(queue);
+
+	return 0;
+}
+
+/*
+** Function OrderHilbert
+** Orders the nodes along a Hilbert curve through the bounding box of
+** the grid.
+**
+** In:       tResult Result   = structure containing Results
+**
+** Out:      int     newToOld = old number of each new node number
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+typedef struct
+{
+	unsigned long key;
+	int           node;
+} tNodeKey;
+
+static int CompareNodeKey(const void *a, const void *b)
+{
+	const tNodeKey *keyA = (const tNodeKey*)a;
+	const tNodeKey *keyB = (const tNodeKey*)b;
+
+	if (keyA->key != keyB->key)
+		return (keyA->key < keyB->key ? -1 : 1);
+
+	return (keyA->node < keyB->node ? -1 : (keyA->node > keyB->node ? 1 : 0));
+}
+
+int OrderHilbert(tResult *Result, int *newToOld)
+{
+	int    n, numNodes;
+
+	double xMin, xMax, yMin, yMax;
+	double xScale, yScale;
+
+	tNodeKey *nodeKey = NULL;
+
+	numNodes = Result->numNodes;
+
+	nodeKey = (tNodeKey*)malloc(numNodes*sizeof(tNodeKey));
+
+	if (nodeKey == NULL)
+	{
+		fprintf(stderr, "ERROR in function OrderHilbert: Could not allocate memory.\n");
+		return -1;
+	}
+
+	xMin = xMax = Result->x[0];
+	yMin = yMax = Result->y[0];
+	for(n=1; n<numNodes; n++)
+	{
+		xMin = (Result->x[n] < xMin ? Result->x[n] : xMin);
+		xMax = (Result->x[n] > xMax ? Result->x[n] : xMax);
+		yMin = (Result->y[n] < yMin ? Result->y[n] : yMin);
+		yMax = (Result->y[n] > yMax ? Result->y[n] : yMax);
+	}
+
+	/* Same scale in both directions, so the curve follows the geometry */
+	xScale = (xMax - xMin > yMax - yMin ? xMax - xMin : yMax - yMin);
+	xScale = (xScale > SMALL ? 65535/xScale : 0);
+	yScale = xScale;
+
+	#pragma omp parallel for
+	for(n=0; n<numNodes; n++)
+	{
+		nodeKey[n].node = n;
+		nodeKey[n].key  = HilbertKey(65536, (unsigned int)((Result->x[n] - xMin)*xScale),
+		                                    (unsigned int)((Result->y[n] - yMin)*yScale));
+	}
+
+	qsort(nodeKey, numNodes, sizeof(tNodeKey), CompareNodeKey);
+
+	for(n=0; n<numNodes; n++)
+		newToOld[n] = nodeKey[n].node;
+
+	free(nodeKey);
+
+	return 0;
+}
+
+/*
+** Function PermuteNodalArray
+** Permutes an array in place: a[n] becomes a[newToOld[n]].
+**
+** In:       double a        = array to permute
+**           int    newToOld = permutation
+**           int    num      = number of entries
+**           double work     = work array of num entries
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int PermuteNodalArray(double *a, int *newToOld, int num, double *work)
+{
+	int    n;
+
+	#pragma omp parallel for
+	for(n=0; n<num; n++)
+		work[n] = a[newToOld[n]];
+
+	#pragma omp parallel for
+	for(n=0; n<num; n++)
+		a[n] = work[n];
+
+	return 0;
+}
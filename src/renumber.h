@@ -0,0 +1,15 @@
+/*
+** Header-file for Renumber
+*/
+
+#ifndef RENUMBER_H
+#define RENUMBER_H
+
+int Renumber(FILE*, tData*, tResult*);
+int ExplicitElements(tResult*);
+int BandwidthProfile(tResult*, int*, long*);
+int OrderCuthillMcKee(tAdjacency*, int*);
+int OrderHilbert(tResult*, int*);
+int PermuteNodalArray(double*, int*, int, double*);
+
+#endif
@@ -1,6 +1,14 @@
 /*
 ** Function Smooth
-** Smoothes all inner gridpoints.
+** Smoothes all inner gridpoints by Laplacian smoothing over the edges
+** of the elements, so any triangulation can be smoothed. With
+** smoothingType 'G' the nodes are coloured and relaxed by Gauss-Seidel,
+** all nodes of one colour concurrently; with 'C' a Chebyshev
+** accelerated Jacobi iteration is used, which needs no omegaSmooth.
+** The nodes of the quadrangles of a mixed grid are held fixed, so the
+** boundary layer keeps its structured distribution. Nodes of elements
+** that the smoothing turned inside out, e.g. pulled through the convex
+** aerofoil, are moved back towards their start.
 **
 ** In:       tData   Data    = structure containing all data
 **           tResult Result  = structure containing all results
@@ -13,143 +21,128 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "gridgen.h"
 #include "cursor.h"
-#include "smooth.h"
 #include "loc.h"
+#include "halfedge.h"
+#include "adjacency.h"
+#include "smooth.h"
 
 int Smooth(FILE *log, tData *Data, tResult *Result)
 {
 	int    ret;
 	int    loc;
-	int    i, j;
-	int    iter;
-	int    diverge;
-	int    node, nodeS, nodeW, nodeNW, nodeN, nodeE, nodeSE;
+	int    i, j, e, k;
+	int    iter, numRestored;
+	int    node[4];
+	double rho;
 
-	double omega;
-	double resX, resY, resMaxX, resMaxY, resMax, resMaxOld;
+	double *xStart = NULL;
+	double *yStart = NULL;
 
-	fprintf(stderr, "Smoothing... ");
+	tHalfEdge  HalfEdge  = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+	tAdjacency Adjacency = {0, NULL, NULL, NULL, 0, NULL, NULL};
 
+	fprintf(stderr, "Smoothing... ");
 
 	ret         = 0;
-	diverge     = 0;
 	iter        = 0;
-	resMax      = SMALLITER;
-	omega       = Data->omegaSmooth;
+	rho         = 0;
+	numRestored = 0;
 
-	if (omega < SMALL)
+	if (Data->smoothingType != 'C' && Data->omegaSmooth < SMALL)
 	{
 		fprintf(stderr, "ERROR in function Smooth: omegaSmooth not defined...\n");
 		ret = -1;
 	}
 
-	while((resMax >= SMALLITER) && (ret != -1) && (diverge == 0))
+	/* Neighbours follow from the elements; boundary nodes stay fixed */
+	if (ret != -1)
+		ret = BuildHalfEdges(&(*log), &(*Result), &HalfEdge);
+
+	if (ret != -1)
+		ret = BuildAdjacency(&(*log), &HalfEdge, &Adjacency);
+
+	if (ret != -1 && Result->elementType == etMixed)
 	{
-		iter++;
+		for (e=0; e<Result->numElements; e++)
+		{
+			if (TypeOfElement(&(*Result), e) != etQuadrangle)
+				continue;
 
-		resMaxX = 0;
-		resMaxY = 0;
+			CopyNodes(&(*Result), e, node);
 
-		/* Show cursor animation */
-		fprintf(stderr, "\b%c", Cursor(iter));
+			for (k=0; k<4; k++)
+				Adjacency.boundary[node[k]] = 1;
+		}
+	}
 
-		for (j=1; j<Result->jm-1; j++)
+	/* Nodes of one colour have no common edges */
+	if (ret != -1)
+		ret = ColourAdjacency(&(*log), &Adjacency);
+
+	/* Keep the nodes before smoothing */
+	if (ret != -1)
+	{
+		xStart = (double*)malloc(Result->numNodes*sizeof(double));
+		yStart = (double*)malloc(Result->numNodes*sizeof(double));
+
+		if (xStart == NULL || yStart == NULL)
 		{
-			for (i=1; i<Result->im-1; i++)
+			fprintf(stderr, "ERROR in function Smooth: Could not allocate memory.\n");
+			ret = -1;
+		}
+		else
+		{
+			for (i=0; i<Result->numNodes; i++)
 			{
-				if (Result->elementType == etTriangle)
-				{
-					/* Triangles */
-					node   = Loc(&(*Result), j, i);
-					nodeS  = Loc(&(*Result), j-1, i);
-					nodeW  = Loc(&(*Result), j, i-1);
-					nodeNW = Loc(&(*Result), j+1, i-1);
-					nodeN  = Loc(&(*Result), j+1, i);
-					nodeE  = Loc(&(*Result), j, i+1);
-					nodeSE = Loc(&(*Result), j-1, i+1);
-
-					resX =  (Result->x[nodeS]  +
-						 Result->x[nodeW]  +
-						 Result->x[nodeNW] +
-						 Result->x[nodeN]  +
-						 Result->x[nodeE]  +
-						 Result->x[nodeSE] -
-					         Result->x[node]*6)/6;
-
-					resY =  (Result->y[nodeS]  +
-						 Result->y[nodeW]  +
-						 Result->y[nodeNW] +
-						 Result->y[nodeN]  +
-						 Result->y[nodeE]  +
-						 Result->y[nodeSE] -
-					         Result->y[node]*6)/6;
-
-					resMaxX = (fabs(resX) > resMaxX ? fabs(resX) : resMaxX);
-					resMaxY = (fabs(resY) > resMaxY ? fabs(resY) : resMaxY);
-
-					Result->x[node] = Result->x[node] + omega*resX;
-					Result->y[node] = Result->y[node] + omega*resY;
-				}
-				else if (Result->elementType == etQuadrangle)
-				{
-					/* Quadrangles */
-					node   = Loc(&(*Result), j, i);
-					nodeS  = Loc(&(*Result), j-1, i);
-					nodeW  = Loc(&(*Result), j, i-1);
-					nodeN  = Loc(&(*Result), j+1, i);
-					nodeE  = Loc(&(*Result), j, i+1);
-
-					resX =  (Result->x[nodeS]  +
-						 Result->x[nodeW]  +
-						 Result->x[nodeN]  +
-						 Result->x[nodeE]  -
-					         Result->x[node]*4)/4;
-
-					resY =  (Result->y[nodeS]  +
-						 Result->y[nodeW]  +
-						 Result->y[nodeN]  +
-						 Result->y[nodeE]  -
-					         Result->y[node]*4)/4;
-
-					resMaxX = (fabs(resX) > resMaxX ? fabs(resX) : resMaxX);
-					resMaxY = (fabs(resY) > resMaxY ? fabs(resY) : resMaxY);
-
-					Result->x[node] = Result->x[node] + omega*resX;
-					Result->y[node] = Result->y[node] + omega*resY;
-				}
-				else
-				{
-					printf("ERROR in function Smooth: Unknown element type.\n");
-					ret = -1;
-				}
+				xStart[i] = Result->x[i];
+				yStart[i] = Result->y[i];
 			}
 		}
+	}
 
-		resMaxOld = resMax;
-		resMax = (resMaxX > resMaxY ? resMaxX : resMaxY);
-
-		if ((resMax >= resMaxOld) && (iter>1))
-			diverge = 1;
+	if (ret != -1)
+	{
+		if (Data->smoothingType == 'C')
+			ret = SmoothChebyshev(&Adjacency, &(*Result), &iter, &rho);
+		else
+			ret = SmoothGaussSeidel(&Adjacency, &(*Result), Data->omegaSmooth, &iter);
 	}
 
+	if (ret != -1)
+		ret = RestoreInverted(&(*Result), xStart, yStart, &numRestored);
+
+	FreeHalfEdges(&HalfEdge);
+	FreeAdjacency(&Adjacency);
+
+	if (xStart)
+		free(xStart);
+
+	if (yStart)
+		free(yStart);
+
 	fprintf(stderr, "\b \n");
-	if (diverge != 0)
+	if (ret == -1 && iter > 0)
 	{
 		fprintf(stderr, "ERROR in function Smooth: diverging...\n");
 		fprintf(stderr, "Aborting operation...\n");
-		ret = -1;
 	}
-	printf("\nNumber of iterations = %d\n\n", iter);
+	if (Data->smoothingType == 'C')
+		printf("\nSpectral radius      = %f", rho);
+	printf("\nNumber of iterations = %d\n", iter);
+	printf("Nodes moved back     = %d\n\n", numRestored);
 
 	/* Write report */
 	if (log)
 	{
 		fprintf(log, "\n\n***** FUNCTION SMOOTH *****\n\n");
 
+		fprintf(log, "nodes moved back = %d\n\n", numRestored);
+
 		fprintf(log, "  j   i          x          y\n");
 
 		for (j=1; j<Result->jm-1; j++)
@@ -167,3 +160,405 @@ int Smooth(FILE *log, tData *Data, tResult *Result)
 	return ret;
 }
 
+
+/*
+** Function SmoothGaussSeidel
+** Over-relaxed Gauss-Seidel sweeps, colour by colour; all nodes of one
+** colour are updated concurrently. Stops at the first residual increase.
+**
+** In:       tAdjacency Adjacency = coloured node-to-node adjacency
+**           double     omega     = relaxation factor
+**
+** Out:      tResult    Result    = structure containing Results
+**           int        iter      = number of iterations
+**
+** Return:   0 on success, -1 when diverging
+**
+** Author:   J.L. Klaufus
+*/
+
+int SmoothGaussSeidel(tAdjacency *Adjacency, tResult *Result, double omega, int *iter)
+{
+	int    c, n, h;
+	int    diverge;
+	int    node, numNeighbours;
+
+	double sumX, sumY;
+	double resX, resY, resMaxX, resMaxY, resMax, resMaxOld;
+
+	diverge = 0;
+	resMax  = SMALLITER;
+	*iter   = 0;
+
+	while((resMax >= SMALLITER) && (diverge == 0))
+	{
+		(*iter)++;
+
+		resMaxX = 0;
+		resMaxY = 0;
+
+		/* Show cursor animation */
+		fprintf(stderr, "\b%c", Cursor(*iter));
+
+		for (c=0; c<Adjacency->numColours; c++)
+		{
+			#pragma omp parallel for private(node, numNeighbours, h, sumX, sumY, resX, resY) reduction(max:resMaxX, resMaxY)
+			for (n=Adjacency->colourStart[c]; n<Adjacency->colourStart[c+1]; n++)
+			{
+				node          = Adjacency->colourNode[n];
+				numNeighbours = Adjacency->start[node+1] - Adjacency->start[node];
+
+				sumX = 0;
+				sumY = 0;
+				for (h=Adjacency->start[node]; h<Adjacency->start[node+1]; h++)
+				{
+					sumX += Result->x[Adjacency->node[h]];
+					sumY += Result->y[Adjacency->node[h]];
+				}
+
+				resX = (sumX - Result->x[node]*numNeighbours)/numNeighbours;
+				resY = (sumY - Result->y[node]*numNeighbours)/numNeighbours;
+
+				resMaxX = (fabs(resX) > resMaxX ? fabs(resX) : resMaxX);
+				resMaxY = (fabs(resY) > resMaxY ? fabs(resY) : resMaxY);
+
+				Result->x[node] = Result->x[node] + omega*resX;
+				Result->y[node] = Result->y[node] + omega*resY;
+			}
+		}
+
+		resMaxOld = resMax;
+		resMax = (resMaxX > resMaxY ? resMaxX : resMaxY);
+
+		if ((resMax >= resMaxOld) && (*iter>1))
+			diverge = 1;
+	}
+
+	return (diverge ? -1 : 0);
+}
+
+/*
+** Function SmoothChebyshev
+** Jacobi iteration with Chebyshev semi-iterative acceleration:
+**   x(k+1) = w(k+1)*(J x(k) - x(k-1)) + x(k-1)
+** with w(1) = 1, w(2) = 2/(2-rho^2), w(k+1) = 1/(1-rho^2*w(k)/4),
+** where rho is the spectral radius of the Jacobi operator J, estimated
+** by power iterations. Every node is updated independently, so no
+** relaxation factor or colouring is needed. The residual is not
+** monotone; the iteration only aborts when it grows without bound.
+**
+** In:       tAdjacency Adjacency = node-to-node adjacency
+**
+** Out:      tResult    Result    = structure containing Results
+**           int        iter      = number of iterations
+**           double     rho       = estimated spectral radius
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int SmoothChebyshev(tAdjacency *Adjacency, tResult *Result, int *iter, double *rho)
+{
+	int    ret;
+	int    n, h;
+	int    node, numNodes, numFree, numNeighbours;
+
+	double omega;
+	double sumX, sumY;
+	double resX, resY, resMaxX, resMaxY, resMax, resMaxFirst;
+
+	double *xOld = NULL;
+	double *yOld = NULL;
+	double *xNew = NULL;
+	double *yNew = NULL;
+
+	ret      = 0;
+	*iter    = 0;
+	numNodes = Adjacency->numNodes;
+
+	/* All free nodes, regardless of their colour */
+	numFree  = Adjacency->colourStart[Adjacency->numColours];
+
+	xOld = (double*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(double));
+	yOld = (double*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(double));
+	xNew = (double*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(double));
+	yNew = (double*)malloc((numNodes > 0 ? numNodes : 1)*sizeof(double));
+
+	if (xOld == NULL || yOld == NULL || xNew == NULL || yNew == NULL)
+	{
+		fprintf(stderr, "ERROR in function SmoothChebyshev: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+		ret = SpectralRadius(&(*Adjacency), rho, xNew, yNew);
+
+	if (ret != -1)
+	{
+		for (n=0; n<numNodes; n++)
+		{
+			xOld[n] = Result->x[n];
+			yOld[n] = Result->y[n];
+		}
+
+		omega       = 1;
+		resMax      = SMALLITER;
+		resMaxFirst = 0;
+
+		while((resMax >= SMALLITER) && (ret != -1))
+		{
+			(*iter)++;
+
+			resMaxX = 0;
+			resMaxY = 0;
+
+			/* Show cursor animation */
+			fprintf(stderr, "\b%c", Cursor(*iter));
+
+			if (*iter == 2)
+				omega = 2/(2 - (*rho)*(*rho));
+			else if (*iter > 2)
+				omega = 1/(1 - (*rho)*(*rho)*omega/4);
+
+			#pragma omp parallel for private(node, numNeighbours, h, sumX, sumY, resX, resY) reduction(max:resMaxX, resMaxY)
+			for (n=0; n<numFree; n++)
+			{
+				node          = Adjacency->colourNode[n];
+				numNeighbours = Adjacency->start[node+1] - Adjacency->start[node];
+
+				sumX = 0;
+				sumY = 0;
+				for (h=Adjacency->start[node]; h<Adjacency->start[node+1]; h++)
+				{
+					sumX += Result->x[Adjacency->node[h]];
+					sumY += Result->y[Adjacency->node[h]];
+				}
+
+				resX = sumX/numNeighbours - Result->x[node];
+				resY = sumY/numNeighbours - Result->y[node];
+
+				resMaxX = (fabs(resX) > resMaxX ? fabs(resX) : resMaxX);
+				resMaxY = (fabs(resY) > resMaxY ? fabs(resY) : resMaxY);
+
+				xNew[node] = omega*(Result->x[node] + resX - xOld[node]) + xOld[node];
+				yNew[node] = omega*(Result->y[node] + resY - yOld[node]) + yOld[node];
+			}
+
+			#pragma omp parallel for private(node)
+			for (n=0; n<numFree; n++)
+			{
+				node = Adjacency->colourNode[n];
+
+				xOld[node]      = Result->x[node];
+				yOld[node]      = Result->y[node];
+				Result->x[node] = xNew[node];
+				Result->y[node] = yNew[node];
+			}
+
+			resMax = (resMaxX > resMaxY ? resMaxX : resMaxY);
+
+			if (*iter == 1)
+				resMaxFirst = resMax;
+
+			if (resMax > 1e3*resMaxFirst || resMax != resMax)
+				ret = -1;
+		}
+	}
+
+	/* Free allocated memory */
+	if (xOld)
+		free(xOld);
+
+	if (yOld)
+		free(yOld);
+
+	if (xNew)
+		free(xNew);
+
+	if (yNew)
+		free(yNew);
+
+	return ret;
+}
+
+/*
+** Function SpectralRadius
+** Estimates the spectral radius of the Jacobi operator J of the free
+** nodes (boundary nodes held at zero) by power iterations. J = D^-1 A
+** is self-adjoint in the inner product weighted by the number of
+** neighbours D, so the weighted Rayleigh quotient is used. The
+** estimate is a lower bound.
+**
+** In:       tAdjacency Adjacency = node-to-node adjacency
+**           double     v, w      = work arrays of numNodes entries
+**
+** Out:      double     rho       = estimated spectral radius
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int SpectralRadius(tAdjacency *Adjacency, double *rho, double *v, double *w)
+{
+	int    n, h, p;
+	int    node, numFree, numNeighbours;
+
+	double vw, vv, ww;
+
+	numFree = Adjacency->colourStart[Adjacency->numColours];
+
+	/* Start with a smooth vector, zero at the boundary */
+	for (n=0; n<Adjacency->numNodes; n++)
+		v[n] = 0;
+
+	for (n=0; n<numFree; n++)
+		v[Adjacency->colourNode[n]] = 1;
+
+	*rho = 0;
+
+	for (p=0; p<NUMPOWERITER; p++)
+	{
+		vw = 0;
+		vv = 0;
+		ww = 0;
+
+		#pragma omp parallel for private(node, numNeighbours, h) reduction(+:vw, vv, ww)
+		for (n=0; n<numFree; n++)
+		{
+			node          = Adjacency->colourNode[n];
+			numNeighbours = Adjacency->start[node+1] - Adjacency->start[node];
+
+			w[node] = 0;
+			for (h=Adjacency->start[node]; h<Adjacency->start[node+1]; h++)
+				w[node] += v[Adjacency->node[h]];
+			w[node] /= numNeighbours;
+
+			vw += numNeighbours*v[node]*w[node];
+			vv += numNeighbours*v[node]*v[node];
+			ww += w[node]*w[node];
+		}
+
+		if (vv < SMALL*SMALL || ww < SMALL*SMALL)
+			break;
+
+		*rho = vw/vv;
+
+		/* Normalised next iterate */
+		ww = sqrt(ww);
+
+		#pragma omp parallel for private(node)
+		for (n=0; n<numFree; n++)
+		{
+			node    = Adjacency->colourNode[n];
+			v[node] = w[node]/ww;
+		}
+	}
+
+	if (*rho >= 1)
+		*rho = 1 - SMALL;
+
+	return 0;
+}
+
+/*
+** Function RestoreInverted
+** Moves the nodes of every element whose orientation differs from the
+** one before smoothing halfway back to their start, and onto it when
+** they are close, until no element is inverted. Boundary nodes did not
+** move, so this ends at the latest with the grid before smoothing.
+**
+** In:       tResult Result         = structure containing Results
+**           double  xStart, yStart = nodes before smoothing
+**
+** Out:      tResult Result         = structure containing Results
+**           int     numRestored    = number of nodes moved back
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int RestoreInverted(tResult *Result, double *xStart, double *yStart, int *numRestored)
+{
+	int    e, k, n, numMoved;
+	int    node[4];
+
+	int    *moved = NULL;
+
+	moved = (int*)calloc(Result->numNodes, sizeof(int));
+
+	if (moved == NULL)
+	{
+		fprintf(stderr, "ERROR in function RestoreInverted: Could not allocate memory.\n");
+		return -1;
+	}
+
+	do
+	{
+		numMoved = 0;
+
+		for (e=0; e<Result->numElements; e++)
+		{
+			if (SignedArea(&(*Result), Result->x, Result->y, e)*SignedArea(&(*Result), xStart, yStart, e) > 0)
+				continue;
+
+			CopyNodes(&(*Result), e, node);
+
+			for (k=0; k<NodesOfElement(&(*Result), e); k++)
+			{
+				n = node[k];
+
+				if (Result->x[n] == xStart[n] && Result->y[n] == yStart[n])
+					continue;
+
+				if (fabs(Result->x[n] - xStart[n]) + fabs(Result->y[n] - yStart[n]) < SMALL)
+				{
+					Result->x[n] = xStart[n];
+					Result->y[n] = yStart[n];
+				}
+				else
+				{
+					Result->x[n] = (Result->x[n] + xStart[n])/2;
+					Result->y[n] = (Result->y[n] + yStart[n])/2;
+				}
+
+				*numRestored += (moved[n] == 0);
+				moved[n] = 1;
+				numMoved++;
+			}
+		}
+	} while (numMoved > 0);
+
+	free(moved);
+
+	return 0;
+}
+
+/*
+** Function SignedArea
+** Returns the signed area of element e for nodes x and y; positive if
+** its nodes are counter-clockwise.
+**
+** Author:   J.L. Klaufus
+*/
+
+double SignedArea(tResult *Result, double *x, double *y, int e)
+{
+	int    k, l, n;
+	int    node[4];
+	double area;
+
+	CopyNodes(&(*Result), e, node);
+	n = NodesOfElement(&(*Result), e);
+
+	area = 0;
+	for (k=0; k<n; k++)
+	{
+		l     = (k+1) % n;
+		area += x[node[k]]*y[node[l]] - x[node[l]]*y[node[k]];
+	}
+
+	return 0.5*area;
+}
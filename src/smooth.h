@@ -3,8 +3,13 @@
 */
 
 #ifndef SMOOTH_H
-#define SMOTTH_H
+#define SMOOTH_H
 
 int Smooth(FILE*, tData*,  tResult*);
+int SmoothGaussSeidel(tAdjacency*, tResult*, double, int*);
+int SmoothChebyshev(tAdjacency*, tResult*, int*, double*);
+int SpectralRadius(tAdjacency*, double*, double*, double*);
+int RestoreInverted(tResult*, double*, double*, int*);
+double SignedArea(tResult*, double*, double*, int);
 
 #endif
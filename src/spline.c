@@ -19,154 +19,823 @@
 #include "spline.h"
 #include "sy.h"
 #include "distribute.h"
+#include "stretch.h"
 
 int Spline(FILE *log, tData* Data, tResult *Result)
 {
 	int    ret;
-	int    i, j;
+	int    i;
+	int    numLower;
+	int    numKnots;
 
-	double *u=NULL;
 	double *v=NULL;
-	double *bx=NULL, *dx=NULL, *ax=NULL, *cx=NULL;
-	double *by=NULL, *dy=NULL, *ay=NULL, *cy=NULL;
+	double *vMid=NULL;
+	double spacing;
+	double leadingEdge;
+	double sagitta, maxSagitta;
 
-	double A, B, C, D;
+	tSpline *Aerofoil = &Result->spline;
 
 	printf("Splining...\n");
 
 	ret = 0;
 
 	/* Allocate memory */
-	u = (double *)malloc(Data->numData*sizeof(double));
-	v  = (double *)malloc(Data->numNodes1*sizeof(double));
-
-	bx = (double *)malloc(Data->numData*sizeof(double));
-	dx = (double *)malloc(Data->numData*sizeof(double));
-	ax = (double *)malloc(Data->numData*sizeof(double));
-	cx = (double *)malloc(Data->numData*sizeof(double));
-
-	by = (double *)malloc(Data->numData*sizeof(double));
-	dy = (double *)malloc(Data->numData*sizeof(double));
-	ay = (double *)malloc(Data->numData*sizeof(double));
-	cy = (double *)malloc(Data->numData*sizeof(double));
-
-	if ((u == NULL) || (v == NULL) ||
-	    (bx == NULL) || (dx == NULL) || (ax == NULL) || (cx == NULL) ||
-	    (by == NULL) || (dy == NULL) || (ay == NULL) || (cy == NULL))
+	v    = (double *)malloc(Data->numNodes1*sizeof(double));
+	vMid = (double *)malloc(Data->numNodes1*sizeof(double));
+
+	if ((v == NULL) || (vMid == NULL))
+	{
+		fprintf(stderr, "ERROR in function Spline: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	/* Spline through all control points, or fitted to them */
+	if (ret != -1)
+	{
+		/* An odd number of knots puts one on the leading edge */
+		numKnots = Data->numKnots + (Data->numKnots % 2 == 0 ? 1 : 0);
+
+		if (Data->numKnots > 0 && numKnots < Data->numData)
+			ret = FitSpline(log, Aerofoil, (numKnots < 3 ? 3 : numKnots), Data->numData, Data->xData, Data->yData);
+		else
+			ret = BuildSpline(Aerofoil, Data->numData, Data->xData, Data->yData);
+	}
+
+	if (ret != -1)
+	{
+		/* Now generate a nice distribution of the arc length */
+		if(Data->stretchingType != 'N' && (Data->aerofoilSpacing[0] > 0 || Data->aerofoilSpacing[1] > 0))
+		{
+			/* Trailing edge to the leading edge knot and back, with a node on the leading edge */
+			numLower    = (Data->numNodes1 + 1)/2;
+			leadingEdge = Aerofoil->arcLength[(Aerofoil->numKnots-1)/2];
+
+			ret = Stretch(log, Data->stretchingType, numLower, leadingEdge,
+			              Data->aerofoilSpacing[0], Data->aerofoilSpacing[1], v);
+
+			if (ret != -1)
+				ret = Stretch(log, Data->stretchingType, Data->numNodes1 - numLower + 1,
+				              Aerofoil->arcLength[Aerofoil->numKnots-1] - leadingEdge,
+				              Data->aerofoilSpacing[1], Data->aerofoilSpacing[0], &v[numLower-1]);
+
+			for(i=numLower-1; i<Data->numNodes1; i++)
+				v[i] += leadingEdge;
+		}
+		else if(Data->distributionType == 'U')
+			ret = Distribute1(log, Data->numNodes1, Aerofoil->arcLength[Aerofoil->numKnots-1], v);
+		else if(Data->distributionType == 'C')
+		{
+			/* Following the curvature, within the fixed factor CURVATURESPACING of the uniform spacing */
+			spacing = Aerofoil->arcLength[Aerofoil->numKnots-1]/(Data->numNodes1 - 1);
+			ret = Distribute5(log, Data->numNodes1, Aerofoil, spacing/CURVATURESPACING, spacing*CURVATURESPACING, v);
+		}
+		else
+			ret = Distribute2(log, Data->numNodes1, Aerofoil->arcLength[Aerofoil->numKnots-1], v);
+	}
+
+	if (ret != -1)
+	{
+		/* Halfway between two nodes, for the mid-edge nodes of quadratic elements */
+		for(i=0; i<Data->numNodes1-1; i++)
+			vMid[i] = (v[i] + v[i+1])/2;
+
+		/* The parameters of these arc lengths */
+		SplineParameters(Aerofoil, Data->numNodes1, v, v);
+		SplineParameters(Aerofoil, Data->numNodes1-1, vMid, vMid);
+
+		for(i=0; i<Data->numNodes1; i++)
+			Result->vNode[i] = v[i];
+
+		/* For this distribution in v, solve x and y */
+		EvaluateSpline(Aerofoil, Data->numNodes1, v, Result->xNode, Result->yNode);
+		EvaluateSpline(Aerofoil, Data->numNodes1-1, vMid, Result->xNodeMid, Result->yNodeMid);
+	}
+
+	/* Free  memory */
+	if (v)
+		free(v);
+	if (vMid)
+		free(vMid);
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION SPLINE *****\n\n");
+
+		if (ret != -1)
+		{
+			/* Largest distance between the spline and the chords between the nodes */
+			maxSagitta = 0;
+			for(i=0; i<Data->numNodes1-1; i++)
+			{
+				sagitta = sqrt(pow(Result->xNodeMid[i] - (Result->xNode[i] + Result->xNode[i+1])/2, 2) +
+				               pow(Result->yNodeMid[i] - (Result->yNode[i] + Result->yNode[i+1])/2, 2));
+				if (sagitta > maxSagitta)
+					maxSagitta = sagitta;
+			}
+
+			fprintf(log, "arc length = %f\n", Aerofoil->arcLength[Aerofoil->numKnots-1]);
+			fprintf(log, "maximum sagitta = %e\n\n", maxSagitta);
+		}
+
+		fprintf(log, "  X          Y\n");
+		for(i=0; i<Data->numNodes1; i++)
+		{
+			fprintf(log, "%10.6f %10.6f\n", Result->xNode[i], Result->yNode[i]);
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function BuildSpline
+** Sets up a natural cubic spline through numKnots points: parametrizes
+** the points on the chord length between them and solves the second
+** derivatives at the knots, which are kept with the knots for any later
+** evaluation. The arc length up to every knot is integrated by 5-point
+** Gauss-Legendre quadrature of the speed.
+**
+** In:       int     numKnots = number of points
+**           double  x, y     = points
+**
+** Out:      tSpline Spline   = the spline
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int BuildSpline(tSpline *Spline, int numKnots, double *x, double *y)
+{
+	int    ret;
+	int    i, n;
+
+	double *b=NULL, *d=NULL, *a=NULL, *c=NULL;
+
+	ret = 0;
+	n   = numKnots;
+
+	FreeSpline(&(*Spline));
+
+	/* Allocate memory */
+	Spline->u       = (double *)malloc(n*sizeof(double));
+	Spline->x       = (double *)malloc(n*sizeof(double));
+	Spline->y       = (double *)malloc(n*sizeof(double));
+	Spline->xSecond = (double *)malloc(n*sizeof(double));
+	Spline->ySecond = (double *)malloc(n*sizeof(double));
+
+	Spline->arcLength = (double *)malloc(n*sizeof(double));
+
+	b = (double *)malloc(5*n*sizeof(double));
+
+	if ((Spline->u == NULL) || (Spline->x == NULL) || (Spline->y == NULL) ||
+	    (Spline->xSecond == NULL) || (Spline->ySecond == NULL) ||
+	    (Spline->arcLength == NULL) || (b == NULL))
 	{
-		fprintf(log, "ERROR in function Spline: Could not allocate memory...");
+		fprintf(stderr, "ERROR in function BuildSpline: Could not allocate memory.\n");
 		ret = -1;
 	}
 	else
 	{
-		/* Parametrize all control points on distance */
-		u[0] = 0;
-		for(i=1; i<Data->numData; i++)
+		Spline->numKnots = n;
+
+		d = b + n;
+		a = d + n;
+		c = a + n;                 /* x and y interleaved */
+
+		/* Parametrize all control points on the chord length */
+		Spline->u[0] = 0;
+		for(i=0; i<n; i++)
 		{
-			u[i] = u[i-1] + sqrt(Data->xData[i]*Data->xData[i] + Data->yData[i]*Data->yData[i]);
+			Spline->x[i] = x[i];
+			Spline->y[i] = y[i];
+
+			if (i > 0)
+				Spline->u[i] = Spline->u[i-1] + sqrt((x[i] - x[i-1])*(x[i] - x[i-1]) + (y[i] - y[i-1])*(y[i] - y[i-1]));
 		}
 
-		/* Now set up 3 diagonal vectors and solution vector */
-		bx[0] = dx[0] = ax[0] = cx[0] = 0;
-		by[0] = dy[0] = ay[0] = cy[0] = 0;
-		for(i=1; i<Data->numData-1; i++)
+		/* Now set up 3 diagonal vectors and the solution vectors of x and y */
+		b[0] = d[0] = a[0] = c[0] = c[1] = 0;
+		for(i=1; i<n-1; i++)
 		{
 			/* Set up diagonal vectors */
-			bx[i] = u[i] - u[i-1];
-			dx[i] = 2*(u[i+1] - u[i-1]);
-			ax[i] = u[i+1] - u[i];
-
-			by[i] = u[i] - u[i-1];
-			dy[i] = 2*(u[i+1] - u[i-1]);
-			ay[i] = u[i+1] - u[i];
+			b[i] = Spline->u[i] - Spline->u[i-1];
+			d[i] = 2*(Spline->u[i+1] - Spline->u[i-1]);
+			a[i] = Spline->u[i+1] - Spline->u[i];
 
 			/* Set up solution vectors */
-			cx[i] = 6*((Data->xData[i+1] - Data->xData[i])/(u[i+1] - u[i]) - (Data->xData[i] - Data->xData[i-1])/(u[i] - u[i-1]));
-			cy[i] = 6*((Data->yData[i+1] - Data->yData[i])/(u[i+1] - u[i]) - (Data->yData[i] - Data->yData[i-1])/(u[i] - u[i-1]));
+			c[2*i]   = 6*((x[i+1] - x[i])/(Spline->u[i+1] - Spline->u[i]) - (x[i] - x[i-1])/(Spline->u[i] - Spline->u[i-1]));
+			c[2*i+1] = 6*((y[i+1] - y[i])/(Spline->u[i+1] - Spline->u[i]) - (y[i] - y[i-1])/(Spline->u[i] - Spline->u[i-1]));
 		}
-		bx[i] = dx[i] = ax[i] = cx[i] = 0;
-		by[i] = dy[i] = ay[i] = cy[i] = 0;
+		b[i] = d[i] = a[i] = c[2*i] = c[2*i+1] = 0;
 
-		/* Solve for second derivatives */
-		if (ret != -1)
-			ret = SY(&(*log), 1, Data->numData-2, bx, dx, ax, cx);
+		/* Solve for second derivatives: one matrix for x and y */
+		SYFactor(1, n-2, b, d, a);
+		SYSolve(1, n-2, 2, b, d, a, c);
 
-		if (ret != -1)
-			ret = SY(&(*log), 1, Data->numData-2, by, dy, ay, cy);
-
-		/* Free some memory */
-		if (ax)
-			free(ax);
-		if (bx)
-			free(bx);
-		if (dx)
-			free(dx);
-		if (ay)
-			free(ay);
-		if (by)
-			free(by);
-		if (dy)
-			free(dy);
-
-		/* Now generate a nice distribution for v */
-		if(Data->distributionType == 'U')
+		for(i=0; i<n; i++)
 		{
-			if (ret != -1)
-				ret = Distribute1(log, Data->numNodes1, u[Data->numData-1], v);
+			Spline->xSecond[i] = c[2*i];
+			Spline->ySecond[i] = c[2*i+1];
 		}
-		else
+
+		/* Arc length up to every knot */
+		Spline->arcLength[0] = 0;
+		for(i=1; i<n; i++)
+			Spline->arcLength[i] = Spline->arcLength[i-1] + SegmentArcLength(&(*Spline), i-1, Spline->u[i]);
+	}
+
+	/* Free memory */
+	if (b)
+		free(b);
+
+	return ret;
+}
+
+/*
+** Function FitSpline
+** Fits a cubic spline with numKnots knots to numPoints points in the
+** least-squares sense, for dense or noisy input. The fit is a clamped
+** cubic B-spline through the first and last point, with its knots at
+** points evenly spread over the input so dense parts get more of them.
+** The normal equations are banded and solved by Cholesky; a small
+** penalty on the second differences keeps them positive definite when
+** a knot interval holds few points. The result is stored as the values
+** and second derivatives at the knots, as BuildSpline does.
+**
+** In:       int     numKnots  = number of knots, less than numPoints
+**           int     numPoints = number of points
+**           double  x, y      = points
+**
+** Out:      tSpline Spline    = the spline
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int FitSpline(FILE *log, tSpline *Spline, int numKnots, int numPoints, double *x, double *y)
+{
+	int    ret;
+	int    i, j, k, l, n, m;
+	int    span;
+
+	double *t=NULL;
+	double *knot=NULL;
+	double *band=NULL;
+	double *c=NULL;
+	double *xFit=NULL, *yFit=NULL;
+	double basis[4];
+	double weight[3];
+	double lambda;
+	double slope0, slope1;
+	double residual, sumResidual, maxResidual;
+
+	ret = 0;
+	n   = numKnots;
+	m   = numPoints;
+
+	FreeSpline(&(*Spline));
+
+	/* Allocate memory */
+	Spline->u       = (double *)malloc(n*sizeof(double));
+	Spline->x       = (double *)malloc(n*sizeof(double));
+	Spline->y       = (double *)malloc(n*sizeof(double));
+	Spline->xSecond = (double *)malloc(n*sizeof(double));
+	Spline->ySecond = (double *)malloc(n*sizeof(double));
+
+	Spline->arcLength = (double *)malloc(n*sizeof(double));
+
+	t    = (double *)malloc(m*sizeof(double));
+	knot = (double *)malloc((n+6)*sizeof(double));
+	band = (double *)calloc(4*(n+2), sizeof(double));
+	c    = (double *)calloc(2*(n+2), sizeof(double));
+	xFit = (double *)malloc(m*sizeof(double));
+	yFit = (double *)malloc(m*sizeof(double));
+
+	if ((Spline->u == NULL) || (Spline->x == NULL) || (Spline->y == NULL) ||
+	    (Spline->xSecond == NULL) || (Spline->ySecond == NULL) || (Spline->arcLength == NULL) ||
+	    (t == NULL) || (knot == NULL) || (band == NULL) || (c == NULL) || (xFit == NULL) || (yFit == NULL))
+	{
+		fprintf(stderr, "ERROR in function FitSpline: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		Spline->numKnots = n;
+
+		/* Parametrize the points on the chord length */
+		t[0] = 0;
+		for(k=1; k<m; k++)
+			t[k] = t[k-1] + sqrt((x[k] - x[k-1])*(x[k] - x[k-1]) + (y[k] - y[k-1])*(y[k] - y[k-1]));
+
+		/* Knots at evenly spread points, the ends repeated for a clamped spline */
+		for(j=0; j<n; j++)
+			Spline->u[j] = t[(int)floor(j*(m - 1.0)/(n - 1) + 0.5)];
+
+		for(j=0; j<3; j++)
 		{
-			if (ret != -1)
-				ret = Distribute2(log, Data->numNodes1, u[Data->numData-1], v);
+			knot[j]     = Spline->u[0];
+			knot[n+3+j] = Spline->u[n-1];
 		}
+		for(j=0; j<n; j++)
+			knot[3+j] = Spline->u[j];
 
-		/* For this distribution in v, solve x and y */
-		for(i=0; i<Data->numNodes1; i++)
+		/*
+		** Normal equations for the n+2 control points, x and y interleaved.
+		** Only the basis functions span-3..span are nonzero in a span.
+		*/
+		span = 3;
+		for(k=0; k<m; k++)
 		{
-			j = 0;
-			while((v[i] - u[j+1] > SMALL) && (j < Data->numData-1))
-				j++;
+			while ((span < n+1) && (t[k] >= knot[span+1]))
+				span++;
+
+			BSplineBasis(knot, span, t[k], basis);
 
-			/* Now v lies between u(j) and u(j+1) */
-			/* Solve for x and y */
-			if (j < Data->numData-1)
+			for(i=0; i<4; i++)
 			{
-				A = (u[j+1]-v[i])/(u[j+1]-u[j]);
-				B = 1 - A;
-				C = (A*A*A-A)/6 * (u[j+1]-u[j])*(u[j+1]-u[j]);
-				D = (B*B*B-B)/6 * (u[j+1]-u[j])*(u[j+1]-u[j]);
+				for(j=0; j<=i; j++)
+					band[(span-3+i)*4 + i-j] += basis[i]*basis[j];
 
-				Result->xNode[i] = A*Data->xData[j] + B*Data->xData[j+1] + C*cx[j] + D*cx[j+1];
-				Result->yNode[i] = A*Data->yData[j] + B*Data->yData[j+1] + C*cy[j] + D*cy[j+1];
+				c[2*(span-3+i)]   += basis[i]*x[k];
+				c[2*(span-3+i)+1] += basis[i]*y[k];
 			}
 		}
 
-		/* Free  memory */
-		if (u)
-			free(u);
-		if (v)
-			free(v);
-		if (cx)
-			free(cx);
-		if (cy)
-			free(cy);
+		/* Penalty on the second differences of the control points */
+		lambda = 0;
+		for(i=0; i<n+2; i++)
+			if (band[4*i] > lambda)
+				lambda = band[4*i];
+		lambda *= SMALLITER;
+
+		weight[0] = 1;
+		weight[1] = -2;
+		weight[2] = 1;
+		for(i=0; i<n; i++)
+			for(k=0; k<3; k++)
+				for(l=0; l<=k; l++)
+					band[(i+k)*4 + k-l] += lambda*weight[k]*weight[l];
+
+		/* The first and last control points are the first and last point */
+		for(i=1; i<4; i++)
+		{
+			c[2*i]   -= band[4*i + i]*x[0];
+			c[2*i+1] -= band[4*i + i]*y[0];
+
+			c[2*(n+1-i)]   -= band[4*(n+1) + i]*x[m-1];
+			c[2*(n+1-i)+1] -= band[4*(n+1) + i]*y[m-1];
+		}
+
+		if (SYBand(1, n, 3, 2, band, c) == -1)
+		{
+			fprintf(stderr, "ERROR in function FitSpline: Normal equations not positive definite.\n");
+			ret = -1;
+		}
+
+		c[0]         = x[0];
+		c[1]         = y[0];
+		c[2*(n+1)]   = x[m-1];
+		c[2*(n+1)+1] = y[m-1];
 	}
 
+	if (ret != -1)
+	{
+		/* Values and second derivatives of the B-spline at the knots */
+		for(j=0; j<n; j++)
+		{
+			span = (j < n-1 ? j+3 : n+1);
+			BSplineBasis(knot, span, Spline->u[j], basis);
+
+			Spline->x[j] = Spline->y[j] = 0;
+			for(i=0; i<4; i++)
+			{
+				Spline->x[j] += basis[i]*c[2*(span-3+i)];
+				Spline->y[j] += basis[i]*c[2*(span-3+i)+1];
+			}
+
+			for(l=0; l<2; l++)
+			{
+				slope0 = 3*(c[2*(j+1)+l] - c[2*j+l])/(knot[j+4] - knot[j+1]);
+				slope1 = 3*(c[2*(j+2)+l] - c[2*(j+1)+l])/(knot[j+5] - knot[j+2]);
+
+				if (l == 0)
+					Spline->xSecond[j] = 2*(slope1 - slope0)/(knot[j+4] - knot[j+2]);
+				else
+					Spline->ySecond[j] = 2*(slope1 - slope0)/(knot[j+4] - knot[j+2]);
+			}
+		}
+
+		/* Arc length up to every knot */
+		Spline->arcLength[0] = 0;
+		for(j=1; j<n; j++)
+			Spline->arcLength[j] = Spline->arcLength[j-1] + SegmentArcLength(&(*Spline), j-1, Spline->u[j]);
+
+		/* Distance of the points to the fit */
+		EvaluateSpline(&(*Spline), m, t, xFit, yFit);
+
+		sumResidual = 0;
+		maxResidual = 0;
+		for(k=0; k<m; k++)
+		{
+			residual     = sqrt((xFit[k] - x[k])*(xFit[k] - x[k]) + (yFit[k] - y[k])*(yFit[k] - y[k]));
+			sumResidual += residual*residual;
+			if (residual > maxResidual)
+				maxResidual = residual;
+		}
+	}
 
 	/* Write report */
 	if (log)
 	{
-		fprintf(log, "\n***** FUNCTION SPLINE *****\n\n");
+		fprintf(log, "\n***** FUNCTION FITSPLINE *****\n\n");
 
-		fprintf(log, "  X          Y\n");
-		for(i=0; i<Data->numNodes1; i++)
+		fprintf(log, "number of points  = %d\n", m);
+		fprintf(log, "number of knots   = %d\n", n);
+
+		if (ret != -1)
 		{
-			fprintf(log, "%10.6f %10.6f\n", Result->xNode[i], Result->yNode[i]);
+			fprintf(log, "rms residual      = %e\n", sqrt(sumResidual/m));
+			fprintf(log, "maximum residual  = %e\n", maxResidual);
 		}
 
 		fprintf(log, "\n*****************************\n\n");
 	}
 
+	/* Free memory */
+	if (t)
+		free(t);
+	if (knot)
+		free(knot);
+	if (band)
+		free(band);
+	if (c)
+		free(c);
+	if (xFit)
+		free(xFit);
+	if (yFit)
+		free(yFit);
+
 	return ret;
 }
 
+/*
+** Function BSplineBasis
+** Evaluates the four cubic B-spline basis functions that are nonzero
+** in a span of the knot vector (Cox-de Boor recursion).
+**
+** In:       double knot  = knot vector
+**           int    span  = knot[span] <= t < knot[span+1]
+**           double t     = parameter value
+**
+** Out:      double basis = basis functions span-3..span at t
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int BSplineBasis(double *knot, int span, double t, double *basis)
+{
+	int    j, r;
+
+	double left[4], right[4];
+	double saved, temp;
+
+	basis[0] = 1;
+	for(j=1; j<=3; j++)
+	{
+		left[j]  = t - knot[span+1-j];
+		right[j] = knot[span+j] - t;
+
+		saved = 0;
+		for(r=0; r<j; r++)
+		{
+			temp     = basis[r]/(right[r+1] + left[j-r]);
+			basis[r] = saved + right[r+1]*temp;
+			saved    = left[j-r]*temp;
+		}
+		basis[j] = saved;
+	}
+
+	return 0;
+}
+
+/*
+** Function EvaluateSpline
+** Evaluates the spline at num parameter values. Sorted values are
+** found in a single pass along the knots, others by bisection.
+**
+** In:       tSpline Spline = the spline
+**           int     num    = number of parameter values
+**           double  v      = parameter values
+**
+** Out:      double  x, y   = points on the spline
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int EvaluateSpline(tSpline *Spline, int num, double *v, double *x, double *y)
+{
+	int    i, j;
+	int    sorted;
+
+	double A, B, C, D, h;
+
+	sorted = 1;
+	for(i=1; i<num && sorted; i++)
+		sorted = (v[i] >= v[i-1]);
+
+	j = 0;
+	for(i=0; i<num; i++)
+	{
+		if (sorted)
+		{
+			while((j < Spline->numKnots-2) && (v[i] - Spline->u[j+1] > SMALL))
+				j++;
+		}
+		else
+			j = SplineInterval(&(*Spline), v[i]);
+
+		/* Now v lies between u(j) and u(j+1) */
+		/* Solve for x and y */
+		h = Spline->u[j+1] - Spline->u[j];
+		A = (Spline->u[j+1] - v[i])/h;
+		B = 1 - A;
+		C = (A*A*A-A)/6 * h*h;
+		D = (B*B*B-B)/6 * h*h;
+
+		x[i] = A*Spline->x[j] + B*Spline->x[j+1] + C*Spline->xSecond[j] + D*Spline->xSecond[j+1];
+		y[i] = A*Spline->y[j] + B*Spline->y[j+1] + C*Spline->ySecond[j] + D*Spline->ySecond[j+1];
+	}
+
+	return 0;
+}
+
+/*
+** Function SplineInterval
+** Returns the first interval j with v up to u(j+1), by bisection; the
+** last interval for v beyond the spline.
+**
+** In:       tSpline Spline = the spline
+**           double  v      = parameter value
+**
+** Return:   interval
+**
+** Author:   J.L. Klaufus
+*/
+
+int SplineInterval(tSpline *Spline, double v)
+{
+	int    low, high, mid;
+
+	low  = 0;
+	high = Spline->numKnots-2;
+
+	while (low < high)
+	{
+		mid = (low + high)/2;
+
+		if (v - Spline->u[mid+1] > SMALL)
+			low  = mid+1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/*
+** Function SplineDerivatives
+** Returns the first and second derivatives of the spline with respect
+** to its parameter at v.
+**
+** In:       tSpline Spline   = the spline
+**           double  v        = parameter value
+**
+** Out:      double  dx, dy   = first derivatives
+**           double  ddx, ddy = second derivatives
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int SplineDerivatives(tSpline *Spline, double v, double *dx, double *dy, double *ddx, double *ddy)
+{
+	int    j;
+
+	double A, B, h;
+
+	j = SplineInterval(&(*Spline), v);
+	h = Spline->u[j+1] - Spline->u[j];
+	A = (Spline->u[j+1] - v)/h;
+	B = 1 - A;
+
+	*dx  = (Spline->x[j+1] - Spline->x[j])/h - (3*A*A-1)/6*h*Spline->xSecond[j] + (3*B*B-1)/6*h*Spline->xSecond[j+1];
+	*dy  = (Spline->y[j+1] - Spline->y[j])/h - (3*A*A-1)/6*h*Spline->ySecond[j] + (3*B*B-1)/6*h*Spline->ySecond[j+1];
+	*ddx = A*Spline->xSecond[j] + B*Spline->xSecond[j+1];
+	*ddy = A*Spline->ySecond[j] + B*Spline->ySecond[j+1];
+
+	return 0;
+}
+
+/*
+** Function SplineCurvature
+** Returns the curvature of the spline at v, positive turning left.
+**
+** In:       tSpline Spline = the spline
+**           double  v      = parameter value
+**
+** Return:   curvature
+**
+** Author:   J.L. Klaufus
+*/
+
+double SplineCurvature(tSpline *Spline, double v)
+{
+	double dx, dy, ddx, ddy, speed;
+
+	SplineDerivatives(&(*Spline), v, &dx, &dy, &ddx, &ddy);
+
+	speed = dx*dx + dy*dy;
+
+	return (speed > 0 ? (dx*ddy - dy*ddx)/(speed*sqrt(speed)) : 0);
+}
+
+/*
+** Function SegmentArcLength
+** Returns the arc length along interval j of the spline, from u(j) up
+** to v, by 5-point Gauss-Legendre quadrature of the speed.
+**
+** In:       tSpline Spline = the spline
+**           int     j      = interval
+**           double  v      = parameter value, u(j) <= v <= u(j+1)
+**
+** Return:   arc length
+**
+** Author:   J.L. Klaufus
+*/
+
+double SegmentArcLength(tSpline *Spline, int j, double v)
+{
+	int    k;
+
+	double point[5]  = {-0.9061798459386640, -0.5384693101056831, 0, 0.5384693101056831, 0.9061798459386640};
+	double weight[5] = { 0.2369268850561891,  0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+	double half, middle, length;
+
+	half   = (v - Spline->u[j])/2;
+	middle = (v + Spline->u[j])/2;
+	length = 0;
+
+	for(k=0; k<5; k++)
+		length += weight[k]*SegmentSpeed(&(*Spline), j, middle + half*point[k]);
+
+	return half*length;
+}
+
+/*
+** Function SegmentSpeed
+** Returns the speed |dx/du, dy/du| of interval j of the spline at v.
+**
+** Author:   J.L. Klaufus
+*/
+
+double SegmentSpeed(tSpline *Spline, int j, double v)
+{
+	double A, B, h, dx, dy;
+
+	h = Spline->u[j+1] - Spline->u[j];
+	A = (Spline->u[j+1] - v)/h;
+	B = 1 - A;
+
+	dx = (Spline->x[j+1] - Spline->x[j])/h - (3*A*A-1)/6*h*Spline->xSecond[j] + (3*B*B-1)/6*h*Spline->xSecond[j+1];
+	dy = (Spline->y[j+1] - Spline->y[j])/h - (3*A*A-1)/6*h*Spline->ySecond[j] + (3*B*B-1)/6*h*Spline->ySecond[j+1];
+
+	return sqrt(dx*dx + dy*dy);
+}
+
+/*
+** Function SplineParameters
+** Maps num arc lengths to the parameters of the spline: the knot
+** interval by bisection on the arc lengths of the knots, then Newton
+** iterations on the arc length within it, kept inside the interval by
+** bisection.
+**
+** In:       tSpline Spline    = the spline
+**           int     num       = number of arc lengths
+**           double  arcLength = arc lengths
+**
+** Out:      double  v         = parameter values, may be arcLength
+**
+** Return:   0 on success
+**
+** Author:   J.L. Klaufus
+*/
+
+int SplineParameters(tSpline *Spline, int num, double *arcLength, double *v)
+{
+	int    i, j, k;
+	int    low, high, mid;
+
+	double s, f, speed;
+	double uLow, uHigh, u;
+
+	for(i=0; i<num; i++)
+	{
+		s = arcLength[i];
+
+		/* The first interval ending beyond s */
+		low  = 0;
+		high = Spline->numKnots-2;
+		while (low < high)
+		{
+			mid = (low + high)/2;
+
+			if (Spline->arcLength[mid+1] < s)
+				low  = mid+1;
+			else
+				high = mid;
+		}
+		j = low;
+
+		uLow  = Spline->u[j];
+		uHigh = Spline->u[j+1];
+
+		/* Start from linear interpolation on the arc length */
+		u = uLow;
+		if (Spline->arcLength[j+1] > Spline->arcLength[j])
+			u += (uHigh - uLow)*(s - Spline->arcLength[j])/(Spline->arcLength[j+1] - Spline->arcLength[j]);
+
+		u = (u < uLow ? uLow : (u > uHigh ? uHigh : u));
+
+		for(k=0; k<NUMNEWTONITER; k++)
+		{
+			f = Spline->arcLength[j] + SegmentArcLength(&(*Spline), j, u) - s;
+
+			if (fabs(f) < SMALL*SMALL)
+				break;
+
+			if (f > 0)
+				uHigh = u;
+			else
+				uLow  = u;
+
+			speed = SegmentSpeed(&(*Spline), j, u);
+
+			if (speed > 0)
+				u -= f/speed;
+
+			if (u <= uLow || u >= uHigh)
+				u = (uLow + uHigh)/2;
+		}
+
+		v[i] = u;
+	}
+
+	return 0;
+}
+
+/*
+** Function FreeSpline
+** Frees the knots and second derivatives of a spline.
+**
+** Author:   J.L. Klaufus
+*/
+
+int FreeSpline(tSpline *Spline)
+{
+	if (Spline->u)
+		free(Spline->u);
+	if (Spline->x)
+		free(Spline->x);
+	if (Spline->y)
+		free(Spline->y);
+	if (Spline->xSecond)
+		free(Spline->xSecond);
+	if (Spline->ySecond)
+		free(Spline->ySecond);
+
+	Spline->numKnots = 0;
+	Spline->u        = NULL;
+	Spline->x        = NULL;
+	Spline->y        = NULL;
+	Spline->xSecond  = NULL;
+	Spline->ySecond  = NULL;
+
+	if (Spline->arcLength)
+		free(Spline->arcLength);
+
+	Spline->arcLength = NULL;
+
+	return 0;
+}
@@ -5,6 +5,17 @@
 #ifndef SPLINE_H
 #define SPLINE_H
 
-int Spline(FILE*, tData*, tResult*);
+int    Spline(FILE*, tData*, tResult*);
+int    BuildSpline(tSpline*, int, double*, double*);
+int    FitSpline(FILE*, tSpline*, int, int, double*, double*);
+int    BSplineBasis(double*, int, double, double*);
+int    EvaluateSpline(tSpline*, int, double*, double*, double*);
+int    SplineInterval(tSpline*, double);
+int    SplineDerivatives(tSpline*, double, double*, double*, double*, double*);
+double SplineCurvature(tSpline*, double);
+double SegmentArcLength(tSpline*, int, double);
+double SegmentSpeed(tSpline*, int, double);
+int    SplineParameters(tSpline*, int, double*, double*);
+int    FreeSpline(tSpline*);
 
 #endif
@@ -0,0 +1,492 @@
+/*
+** C-file for Stretch
+** Distributes nodes on a reference length for a requested first and
+** last spacing. The stretching functions are Vinokur's, which is the
+** two-sided tanh function, and a geometric progression. Vinokur's
+** parameter is approximated in closed form and refined by one Newton
+** step; since the function gives the slopes at the ends rather than
+** the first and last intervals, the slopes are rescaled until the
+** intervals match, at most NUMNEWTONITER times. The geometric ratio is
+** bisected. The spacings reached are reported: a geometric progression
+** cannot always reach both.
+**
+** In:       char   stretchingType = 'V' Vinokur, 'G' geometric
+**           int    numNodes       = number of nodes
+**           double refLength      = reference length
+**           double firstSpacing   = spacing at the first node, 0: free
+**           double lastSpacing    = spacing at the last node, 0: free
+**
+** Out:      double xArray         = array of node x-coordinates
+**
+** Return:   0 on success, -1 on failure
+**
+** Datfiles: gridgen.spacing: "aerofoil|cut|normal first last" per line
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "stretch.h"
+
+int Stretch(FILE *log, char stretchingType, int numNodes, double refLength, double firstSpacing, double lastSpacing, double *xArray)
+{
+	int    ret;
+	int    i;
+	int    mirror;
+	int    iter;
+
+	double s0, s1;
+	double slope0, slope1;
+	double delta0, delta1;
+	double xTemp;
+
+	ret    = 0;
+	delta0 = 0;
+	delta1 = 0;
+
+	/* Dimensionless spacings; a free first spacing is the mirror of a free last one */
+	mirror = (firstSpacing <= 0);
+	s0     = (mirror ? lastSpacing  : firstSpacing)/refLength;
+	s1     = (mirror ? firstSpacing : lastSpacing)/refLength;
+
+	if (s0 <= 0 || numNodes < 2)
+	{
+		fprintf(stderr, "ERROR in function Stretch: No spacing to stretch to.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+	{
+		if (stretchingType == 'G')
+			ret = StretchGeometric(numNodes, s0, s1, xArray);
+		else
+		{
+			/*
+			** The functions give the slopes at the ends; scale the slopes
+			** until the first and last intervals have the requested size.
+			*/
+			slope0 = s0;
+			slope1 = s1;
+			for(iter=0; iter<NUMNEWTONITER && ret != -1; iter++)
+			{
+				ret = StretchVinokur(numNodes, slope0, slope1, xArray);
+
+				delta0 = xArray[1] - xArray[0];
+				delta1 = xArray[numNodes-1] - xArray[numNodes-2];
+
+				if (fabs(delta0 - s0) < SMALLITER*s0 && (s1 <= 0 || fabs(delta1 - s1) < SMALLITER*s1))
+					break;
+
+				slope0 *= s0/delta0;
+				if (s1 > 0)
+					slope1 *= s1/delta1;
+			}
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(i=0; i<numNodes; i++)
+			xArray[i] *= refLength;
+
+		if (mirror)
+		{
+			for(i=0; i<numNodes/2; i++)
+			{
+				xTemp                = xArray[i];
+				xArray[i]            = refLength - xArray[numNodes-1-i];
+				xArray[numNodes-1-i] = refLength - xTemp;
+			}
+			if (numNodes % 2 == 1)
+				xArray[numNodes/2] = refLength - xArray[numNodes/2];
+		}
+
+		xArray[0]          = 0;
+		xArray[numNodes-1] = refLength;
+
+		for(i=1; i<numNodes; i++)
+		{
+			if (xArray[i] <= xArray[i-1])
+			{
+				fprintf(stderr, "ERROR in function Stretch: Spacings %g and %g do not fit %d nodes on %g.\n",
+				        firstSpacing, lastSpacing, numNodes, refLength);
+				ret = -1;
+				break;
+			}
+		}
+	}
+
+	/* The spacings reached */
+	if (ret != -1)
+	{
+		delta0 = xArray[1] - xArray[0];
+		delta1 = xArray[numNodes-1] - xArray[numNodes-2];
+
+		if ((firstSpacing > 0 && fabs(delta0 - firstSpacing) > 0.01*firstSpacing) ||
+		    (lastSpacing  > 0 && fabs(delta1 - lastSpacing)  > 0.01*lastSpacing))
+			fprintf(stderr, "WARNING in function Stretch: Spacings %g and %g reached instead of %g and %g.\n",
+			        delta0, delta1, firstSpacing, lastSpacing);
+	}
+
+	/* Write report */
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION STRETCH *****\n\n");
+
+		fprintf(log, "type          = %c\n", stretchingType);
+		fprintf(log, "first spacing = %e, reached %e\n", firstSpacing, delta0);
+		fprintf(log, "last spacing  = %e, reached %e\n\n", lastSpacing, delta1);
+
+		if (ret != -1)
+		{
+			for(i=0; i<numNodes; i++)
+			{
+				fprintf(log, "x = %f\n", xArray[i]);
+			}
+		}
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return ret;
+}
+
+/*
+** Function StretchVinokur
+** Vinokur's two-sided stretching on [0,1]: the symmetric function
+** u = 1/2 (1 + tanh(d (ksi-1/2))/tanh(d/2)), or its tan counterpart
+** for spacings above the uniform one, blended to s = u/(A + (1-A) u).
+** With A = sqrt(s1/s0) and sinh(d)/d = 1/(N sqrt(s0 s1)) the first
+** and last spacings are s0 and s1. The two-sided tanh function with
+** the same end slopes is identical to it, hence '-w T' is an alias of
+** 'V'. Without s1, the one-sided function of StretchOneSided.
+**
+** In:       int    numNodes = number of nodes
+**           double s0, s1   = first and last spacing on [0,1]; s1 <= 0: free
+**
+** Out:      double xArray   = distribution on [0,1]
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int StretchVinokur(int numNodes, double s0, double s1, double *xArray)
+{
+	int    i, n;
+
+	double a, b, d;
+	double ksi, u;
+
+	n = numNodes - 1;
+
+	if (s1 <= 0)
+	{
+		for(i=0; i<=n; i++)
+			xArray[i] = StretchOneSided(1/(n*s0), (double)i/n);
+
+		return 0;
+	}
+
+	a = sqrt(s1/s0);
+	b = 1/(n*sqrt(s0*s1));
+
+	if (b > 1 + SMALLITER)
+		d = InverseSinhc(b);
+	else if (b < 1 - SMALLITER)
+		d = InverseSinc(b);
+	else
+		d = 0;
+
+	for(i=0; i<=n; i++)
+	{
+		ksi = (double)i/n;
+
+		if (b > 1 + SMALLITER)
+			u = 0.5*(1 + tanh(d*(ksi - 0.5))/tanh(0.5*d));
+		else if (b < 1 - SMALLITER)
+			u = 0.5*(1 + tan(d*(ksi - 0.5))/tan(0.5*d));
+		else
+			u = ksi*(1 + 2*(b - 1)*(ksi - 0.5)*(1 - ksi));
+
+		xArray[i] = u/(a + (1 - a)*u);
+	}
+
+	return 0;
+}
+
+/*
+** Function StretchGeometric
+** The spacing grows geometrically away from both ends at a common
+** ratio r, the smaller of s0 r^k and s1 r^(N-1-k) being taken, or the
+** larger one when the spacings exceed the uniform one and r < 1. The
+** sum of the spacings has no closed-form inverse, so r is bisected.
+** The ends keep their spacing where the progressions meet before the
+** other end.
+**
+** In:       int    numNodes = number of nodes
+**           double s0, s1   = first and last spacing on [0,1]; s1 <= 0: free
+**
+** Out:      double xArray   = distribution on [0,1]
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int StretchGeometric(int numNodes, double s0, double s1, double *xArray)
+{
+	int    i, n;
+	int    iter;
+	int    shrink;
+
+	double r, rLow, rHigh;
+
+	n = numNodes - 1;
+
+	/* Clustering, or spacings above the uniform one */
+	if (s1 <= 0)
+		shrink = (n*s0 > 1);
+	else
+		shrink = (n*(s0 < s1 ? s0 : s1) > 1);
+
+	/* The sum of the spacings increases with r; bracket and bisect it */
+	rLow  = (shrink ? 0 : 1);
+	rHigh = (shrink ? 1 : 2);
+
+	while (!shrink && GeometricSum(n, s0, s1, rHigh, shrink, xArray) < 1 && rHigh < 1/SMALL)
+		rHigh *= 2;
+
+	for(iter=0; iter<100; iter++)
+	{
+		r = 0.5*(rLow + rHigh);
+
+		if (GeometricSum(n, s0, s1, r, shrink, xArray) < 1)
+			rLow  = r;
+		else
+			rHigh = r;
+	}
+
+	GeometricSum(n, s0, s1, 0.5*(rLow + rHigh), shrink, xArray);
+
+	for(i=1; i<=n; i++)
+		xArray[i] /= xArray[n];
+
+	return 0;
+}
+
+/*
+** Function GeometricSum
+** Adds up the spacings of StretchGeometric for a ratio r.
+**
+** In:       int    n      = number of intervals
+**           double s0, s1 = first and last spacing; s1 <= 0: free
+**           double r      = ratio of neighbouring spacings
+**           int    shrink = 1: the larger of the progressions, else the smaller
+**
+** Out:      double xArray = distribution
+**
+** Return:   the length of the distribution
+**
+** Author:   J.L. Klaufus
+*/
+
+double GeometricSum(int n, double s0, double s1, double r, int shrink, double *xArray)
+{
+	int    i;
+
+	double delta0, delta1;
+
+	xArray[0] = 0;
+	for(i=1; i<=n; i++)
+	{
+		delta0 = s0*pow(r, i-1);
+		delta1 = s1*pow(r, n-i);
+
+		if (s1 <= 0)
+			xArray[i] = xArray[i-1] + delta0;
+		else if (shrink)
+			xArray[i] = xArray[i-1] + (delta0 > delta1 ? delta0 : delta1);
+		else
+			xArray[i] = xArray[i-1] + (delta0 < delta1 ? delta0 : delta1);
+	}
+
+	return xArray[n];
+}
+
+/*
+** Function StretchOneSided
+** One-sided stretching on [0,1] with slope 1/b at ksi = 0:
+** 1 + tanh(d (ksi-1)/2)/tanh(d/2) with sinh(d)/d = b for b > 1,
+** 1 + tan(d (ksi-1)/2)/tan(d/2) with sin(d)/d = b for b < 1.
+**
+** In:       double b   = ratio of the uniform and the first spacing
+**           double ksi = uniform co-ordinate in [0,1]
+**
+** Return:   the stretched co-ordinate
+**
+** Author:   J.L. Klaufus
+*/
+
+double StretchOneSided(double b, double ksi)
+{
+	double d;
+
+	if (b > 1 + SMALLITER)
+	{
+		d = InverseSinhc(b);
+		return 1 + tanh(0.5*d*(ksi - 1))/tanh(0.5*d);
+	}
+	else if (b < 1 - SMALLITER)
+	{
+		d = InverseSinc(b);
+		return 1 + tan(0.5*d*(ksi - 1))/tan(0.5*d);
+	}
+
+	return ksi;
+}
+
+/*
+** Function InverseSinhc
+** Solves sinh(x)/x = y for y > 1 with Vinokur's closed-form
+** approximation, followed by one Newton step.
+**
+** In:       double y = value of sinh(x)/x
+**
+** Return:   x
+**
+** Author:   J.L. Klaufus
+*/
+
+double InverseSinhc(double y)
+{
+	double x, yBar, v, w;
+
+	if (y < 2.7829681)
+	{
+		yBar = y - 1;
+		x    = sqrt(6*yBar)*(1 + yBar*(-0.15 + yBar*(0.057321429 + yBar*(-0.024907295
+		       + yBar*(0.0077424461 - yBar*0.0010794123)))));
+	}
+	else
+	{
+		v = log(y);
+		w = 1/y - 0.028527431;
+		x = v + (1 + 1/v)*log(2*v) - 0.02041793
+		    + w*(0.24902722 + w*(1.9496443 + w*(-2.6294547 + w*8.56795911)));
+	}
+
+	/* d/dx (sinh(x) - x y) = cosh(x) - y */
+	x -= (sinh(x) - x*y)/(cosh(x) - y);
+
+	return x;
+}
+
+/*
+** Function InverseSinc
+** Solves sin(x)/x = y for 0 < y < 1 with Vinokur's closed-form
+** approximation, followed by one Newton step.
+**
+** In:       double y = value of sin(x)/x
+**
+** Return:   x in (0, PI)
+**
+** Author:   J.L. Klaufus
+*/
+
+double InverseSinc(double y)
+{
+	double x, yBar;
+
+	if (y <= 0.26938972)
+	{
+		x = PI*(1 + y*(-1 + y*(1 + y*(-(1 + PI*PI/6) + y*(6.794732
+		    + y*(-13.205501 + y*11.726095))))));
+	}
+	else
+	{
+		yBar = 1 - y;
+		x    = sqrt(6*yBar)*(1 + yBar*(0.15 + yBar*(0.057321429 + yBar*(0.048774238
+		       + yBar*(-0.053337753 + yBar*0.075845134)))));
+	}
+
+	/* d/dx (sin(x) - x y) = cos(x) - y */
+	x -= (sin(x) - x*y)/(cos(x) - y);
+
+	return x;
+}
+
+/*
+** Function ReadSpacingFile
+** Reads the requested first and last spacings from gridgen.spacing,
+** one line "aerofoil|cut|normal first last" per family of lines: the
+** aerofoil from the trailing to the leading edge, the cut from the
+** trailing edge to the outflow and the outflow boundary from the cut
+** to the wall. A spacing of 0 is left free; lines not given keep the
+** distribution of the input file.
+**
+** Out:      tData  Data = the spacings
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+int ReadSpacingFile(FILE *log, tData *Data)
+{
+	FILE   *spacingFile;
+	char   name[20];
+	double first, last;
+
+	Data->aerofoilSpacing[0] = Data->aerofoilSpacing[1] = 0;
+	Data->cutSpacing[0]      = Data->cutSpacing[1]      = 0;
+	Data->normalSpacing[0]   = Data->normalSpacing[1]   = 0;
+
+	spacingFile = fopen("gridgen.spacing", "r");
+	if (spacingFile == NULL)
+	{
+		fprintf(stderr, "ERROR in function ReadSpacingFile: Could not open gridgen.spacing.\n");
+		return -1;
+	}
+
+	while (fscanf(spacingFile, "%19s %lf %lf", name, &first, &last) == 3)
+	{
+		if (strcmp(name, "aerofoil") == 0)
+		{
+			Data->aerofoilSpacing[0] = first;
+			Data->aerofoilSpacing[1] = last;
+		}
+		else if (strcmp(name, "cut") == 0)
+		{
+			Data->cutSpacing[0] = first;
+			Data->cutSpacing[1] = last;
+		}
+		else if (strcmp(name, "normal") == 0)
+		{
+			Data->normalSpacing[0] = first;
+			Data->normalSpacing[1] = last;
+		}
+		else
+			fprintf(stderr, "WARNING in function ReadSpacingFile: Unknown line '%s' ignored.\n", name);
+	}
+
+	fclose(spacingFile);
+
+	if (log)
+	{
+		fprintf(log, "\n***** FUNCTION READSPACINGFILE *****\n\n");
+
+		fprintf(log, "              first        last\n");
+		fprintf(log, "aerofoil %e %e\n", Data->aerofoilSpacing[0], Data->aerofoilSpacing[1]);
+		fprintf(log, "cut      %e %e\n", Data->cutSpacing[0], Data->cutSpacing[1]);
+		fprintf(log, "normal   %e %e\n", Data->normalSpacing[0], Data->normalSpacing[1]);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	return 0;
+}
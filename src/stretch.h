@@ -0,0 +1,17 @@
+/*
+** Header-file for Stretch
+*/
+
+#ifndef STRETCH_H
+#define STRETCH_H
+
+int    Stretch(FILE*, char, int, double, double, double, double*);
+int    StretchVinokur(int, double, double, double*);
+int    StretchGeometric(int, double, double, double*);
+double GeometricSum(int, double, double, double, int, double*);
+double StretchOneSided(double, double);
+double InverseSinhc(double);
+double InverseSinc(double);
+int    ReadSpacingFile(FILE*, tData*);
+
+#endif
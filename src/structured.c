@@ -16,6 +16,7 @@
 
 #include "gridgen.h"
 #include "algebraic.h"
+#include "hyperbolic.h"
 #include "laplace.h"
 #include "middlecoff.h"
 #include "structured.h"
@@ -31,14 +32,18 @@ int Structured(FILE *log, tData *Data, tResult* Result)
 
 	/* Algebraic part */
 	if (ret != -1)
-		ret = Algebraic(&(*log), &(*Result));
+		ret = Algebraic(&(*log), &(*Data), &(*Result));
+
+	/* Hyperbolic part, marched from the algebraic grid */
+	if ((ret != -1) && (Data->gridType == 'H'))
+		ret = Hyperbolic(&(*log), &(*Data), &(*Result));
 
 	/* Elliptic part */
-	if ((ret != -1) && (Data->omegaElliptic > SMALL))
+	else if ((ret != -1) && (Data->omegaElliptic > SMALL))
 	{
 		if (Data->gridType == 'L')
 			ret = Laplace(&(*log), &(*Data), &(*Result));
-		else if (Data->gridType == 'M' || Data->gridType == 'U')
+		else if (Data->gridType == 'M' || Data->gridType == 'U' || Data->gridType == 'D')
 			ret = Middlecoff(&(*log), &(*Data), &(*Result));
 		else if (Data->gridType != 'A')
 		{
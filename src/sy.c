@@ -1,63 +1,358 @@
 /*
-** Function SY.
-** Solves a tridiagonal system by elmination
+** Function SYFactor.
+** Factors a tridiagonal matrix once, so SYSolve can apply it to any
+** number of right-hand sides.
 **
 ** In:       int il          = lower boundary value
 **           int iu          = upper boundary value
 **           double bb       = vector of coefficients behind diagonal
 **           double dd       = vector of coefficients on diagonal
 **           double aa       = vector of coefficients ahead of diagonal
-**           double cc       = constant vector
 **
-** Out:      double cc       = solution vector
+** Out:      double bb       = multipliers of the elimination
+**           double dd       = pivots
 **
-** Return:   0 on success, -1 on failure
+** Return:   0 on success
 **
 */
 
 #include <stdio.h>
+#include <math.h>
 #include "gridgen.h"
 #include "sy.h"
 
-int SY(FILE *log, int il, int iu, double *bb, double *dd, double *aa, double *cc)
+int SYFactor(int il, int iu, double *bb, double *dd, double *aa)
 {
-	int    ret;
 	int    i;
-	double r;
 
-	/*printf("Solving matrix...\n");*/
+	for(i=il+1; i<=iu; i++)
+	{
+		bb[i] = bb[i]/dd[i-1];
+		dd[i] = dd[i] - bb[i]*aa[i-1];
+	}
+
+	return 0;
+}
+
+/*
+** Function SYSolve.
+** Solves numRhs right-hand sides with a matrix factored by SYFactor.
+** The right-hand sides are interleaved, cc[i*numRhs + k] holding row i
+** of right-hand side k, so every row is one vector operation.
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           int numRhs      = number of right-hand sides
+**           double bb, dd   = factors from SYFactor
+**           double aa       = vector of coefficients ahead of diagonal
+**           double cc       = constant vectors, interleaved
+**
+** Out:      double cc       = solution vectors, interleaved
+**
+** Return:   0 on success
+**
+*/
 
-	ret = 0;
-	
-	/* Establish upper triangular matrix */
+int SYSolve(int il, int iu, int numRhs, double *bb, double *dd, double *aa, double *cc)
+{
+	int    i, k;
+
+	/* Forward elimination */
 	for(i=il+1; i<=iu; i++)
 	{
-		r     = bb[i]/dd[i-1];
-		dd[i] = dd[i] - r*aa[i-1];
-		cc[i] = cc[i] - r*cc[i-1];
+		#pragma omp simd
+		for(k=0; k<numRhs; k++)
+			cc[i*numRhs+k] -= bb[i]*cc[(i-1)*numRhs+k];
 	}
 
 	/* Back substitution */
-	cc[iu] = cc[iu]/dd[iu];
-	for(i=iu; i>=il+1; i--)
+	#pragma omp simd
+	for(k=0; k<numRhs; k++)
+		cc[iu*numRhs+k] /= dd[iu];
+
+	for(i=iu-1; i>=il; i--)
+	{
+		#pragma omp simd
+		for(k=0; k<numRhs; k++)
+			cc[i*numRhs+k] = (cc[i*numRhs+k] - aa[i]*cc[(i+1)*numRhs+k])/dd[i];
+	}
+
+	return 0;
+}
+
+/*
+** Function SYBatchFactor.
+** Factors numSystems independent tridiagonal matrices at once, as
+** SYFactor does one. All vectors are interleaved, row i of system k at
+** i*numSystems + k, so the systems run side by side in the vector
+** lanes.
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           int numSystems  = number of systems
+**           double bb       = coefficients behind diagonal, interleaved
+**           double dd       = coefficients on diagonal, interleaved
+**           double aa       = coefficients ahead of diagonal, interleaved
+**
+** Out:      double bb       = multipliers of the elimination
+**           double dd       = pivots
+**
+** Return:   0 on success
+**
+*/
+
+int SYBatchFactor(int il, int iu, int numSystems, double *bb, double *dd, double *aa)
+{
+	int    i, k, n;
+
+	n = numSystems;
+
+	for(i=il+1; i<=iu; i++)
 	{
-		cc[i] = (cc[i]-aa[i]*cc[i+1])/dd[i];
+		#pragma omp simd
+		for(k=0; k<n; k++)
+		{
+			bb[i*n+k]  = bb[i*n+k]/dd[(i-1)*n+k];
+			dd[i*n+k] -= bb[i*n+k]*aa[(i-1)*n+k];
+		}
 	}
-	
-	/* Write report */
-	if (log)
+
+	return 0;
+}
+
+/*
+** Function SYBatchSolve.
+** Solves the systems factored by SYBatchFactor, one right-hand side per
+** system, interleaved as the matrices.
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           int numSystems  = number of systems
+**           double bb, dd   = factors from SYBatchFactor
+**           double aa       = coefficients ahead of diagonal, interleaved
+**           double cc       = constant vectors, interleaved
+**
+** Out:      double cc       = solution vectors, interleaved
+**
+** Return:   0 on success
+**
+*/
+
+int SYBatchSolve(int il, int iu, int numSystems, double *bb, double *dd, double *aa, double *cc)
+{
+	int    i, k, n;
+
+	n = numSystems;
+
+	/* Forward elimination */
+	for(i=il+1; i<=iu; i++)
 	{
-		fprintf(log, "\n***** FUNCTION SY *****\n\n");
+		#pragma omp simd
+		for(k=0; k<n; k++)
+			cc[i*n+k] -= bb[i*n+k]*cc[(i-1)*n+k];
+	}
+
+	/* Back substitution */
+	#pragma omp simd
+	for(k=0; k<n; k++)
+		cc[iu*n+k] /= dd[iu*n+k];
+
+	for(i=iu-1; i>=il; i--)
+	{
+		#pragma omp simd
+		for(k=0; k<n; k++)
+			cc[i*n+k] = (cc[i*n+k] - aa[i*n+k]*cc[(i+1)*n+k])/dd[i*n+k];
+	}
 
-		fprintf(log, "  RR\n");
-		for(i=il+1; i<=iu; i++)
+	return 0;
+}
+
+/*
+** Function SYBand.
+** Solves a symmetric positive definite band system by Cholesky
+** factorization, as the normal equations of a least-squares fit give.
+** Row i of the lower band is stored as band[i*(numBands+1) + k] =
+** A(i, i-k), k = 0..numBands; the right-hand sides are interleaved as
+** for SYSolve.
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           int numBands    = number of bands below the diagonal
+**           int numRhs      = number of right-hand sides
+**           double band     = lower band of the matrix
+**           double cc       = constant vectors, interleaved
+**
+** Out:      double band     = lower band of the Cholesky factor
+**           double cc       = solution vectors, interleaved
+**
+** Return:   0 on success, -1 if the matrix is not positive definite
+**
+*/
+
+int SYBand(int il, int iu, int numBands, int numRhs, double *band, double *cc)
+{
+	int    i, j, k, m;
+	double sum;
+
+	m = numBands + 1;
+
+	/* Factorization, L(i,j) for j = i-numBands..i */
+	for(i=il; i<=iu; i++)
+	{
+		for(j=(i-numBands > il ? i-numBands : il); j<=i; j++)
+		{
+			sum = band[i*m + i-j];
+			for(k=(i-numBands > il ? i-numBands : il); k<j; k++)
+				sum -= band[i*m + i-k]*band[j*m + j-k];
+
+			if (j < i)
+				band[i*m + i-j] = sum/band[j*m];
+			else if (sum > 0)
+				band[i*m] = sqrt(sum);
+			else
+				return -1;
+		}
+	}
+
+	/* Forward substitution with L */
+	for(i=il; i<=iu; i++)
+	{
+		for(j=(i-numBands > il ? i-numBands : il); j<i; j++)
 		{
-			fprintf(log, "%10.6f\n", cc[i]);
+			#pragma omp simd
+			for(k=0; k<numRhs; k++)
+				cc[i*numRhs+k] -= band[i*m + i-j]*cc[j*numRhs+k];
 		}
 
-		fprintf(log, "\n*****************************\n\n");
+		#pragma omp simd
+		for(k=0; k<numRhs; k++)
+			cc[i*numRhs+k] /= band[i*m];
 	}
 
-	return ret;
+	/* Back substitution with the transpose of L */
+	for(i=iu; i>=il; i--)
+	{
+		for(j=i+1; j<=(i+numBands < iu ? i+numBands : iu); j++)
+		{
+			#pragma omp simd
+			for(k=0; k<numRhs; k++)
+				cc[i*numRhs+k] -= band[j*m + j-i]*cc[j*numRhs+k];
+		}
+
+		#pragma omp simd
+		for(k=0; k<numRhs; k++)
+			cc[i*numRhs+k] /= band[i*m];
+	}
+
+	return 0;
 }
 
+/*
+** Function SYBlockFactor.
+** Factors a block tridiagonal matrix with 2x2 blocks, as SYFactor does
+** with scalars, so SYBlockSolve can apply it. Block i is stored row by
+** row in four consecutive elements, bb[4*i] .. bb[4*i+3].
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           double bb       = blocks behind diagonal
+**           double dd       = blocks on diagonal
+**           double aa       = blocks ahead of diagonal
+**
+** Out:      double bb       = multipliers of the elimination
+**           double dd       = inverses of the pivots
+**
+** Return:   0 on success, -1 if a pivot is singular
+**
+*/
+
+int SYBlockFactor(int il, int iu, double *bb, double *dd, double *aa)
+{
+	int    i;
+	double det;
+	double r[4];
+
+	for(i=il; i<=iu; i++)
+	{
+		if (i > il)
+		{
+			/* bb(i) = bb(i)*inverse(dd(i-1)), dd(i) = dd(i) - bb(i)*aa(i-1) */
+			r[0] = bb[4*i  ]*dd[4*i-4] + bb[4*i+1]*dd[4*i-2];
+			r[1] = bb[4*i  ]*dd[4*i-3] + bb[4*i+1]*dd[4*i-1];
+			r[2] = bb[4*i+2]*dd[4*i-4] + bb[4*i+3]*dd[4*i-2];
+			r[3] = bb[4*i+2]*dd[4*i-3] + bb[4*i+3]*dd[4*i-1];
+
+			bb[4*i  ] = r[0];
+			bb[4*i+1] = r[1];
+			bb[4*i+2] = r[2];
+			bb[4*i+3] = r[3];
+
+			dd[4*i  ] -= r[0]*aa[4*i-4] + r[1]*aa[4*i-2];
+			dd[4*i+1] -= r[0]*aa[4*i-3] + r[1]*aa[4*i-1];
+			dd[4*i+2] -= r[2]*aa[4*i-4] + r[3]*aa[4*i-2];
+			dd[4*i+3] -= r[2]*aa[4*i-3] + r[3]*aa[4*i-1];
+		}
+
+		/* Invert the pivot */
+		det = dd[4*i]*dd[4*i+3] - dd[4*i+1]*dd[4*i+2];
+		if (fabs(det) < SMALL*SMALL)
+			return -1;
+
+		r[0] = dd[4*i];
+		dd[4*i  ] =  dd[4*i+3]/det;
+		dd[4*i+1] = -dd[4*i+1]/det;
+		dd[4*i+2] = -dd[4*i+2]/det;
+		dd[4*i+3] =  r[0]/det;
+	}
+
+	return 0;
+}
+
+/*
+** Function SYBlockSolve.
+** Solves a block tridiagonal system factored by SYBlockFactor. The
+** right-hand side and the solution are stored in two elements per
+** block row, cc[2*i] and cc[2*i+1].
+**
+** In:       int il          = lower boundary value
+**           int iu          = upper boundary value
+**           double bb, dd   = factors from SYBlockFactor
+**           double aa       = blocks ahead of diagonal
+**           double cc       = constant vector
+**
+** Out:      double cc       = solution vector
+**
+** Return:   0 on success
+**
+*/
+
+int SYBlockSolve(int il, int iu, double *bb, double *dd, double *aa, double *cc)
+{
+	int    i;
+	double c[2];
+
+	/* Forward elimination */
+	for(i=il+1; i<=iu; i++)
+	{
+		cc[2*i  ] -= bb[4*i  ]*cc[2*i-2] + bb[4*i+1]*cc[2*i-1];
+		cc[2*i+1] -= bb[4*i+2]*cc[2*i-2] + bb[4*i+3]*cc[2*i-1];
+	}
+
+	/* Back substitution */
+	for(i=iu; i>=il; i--)
+	{
+		c[0] = cc[2*i];
+		c[1] = cc[2*i+1];
+
+		if (i < iu)
+		{
+			c[0] -= aa[4*i  ]*cc[2*i+2] + aa[4*i+1]*cc[2*i+3];
+			c[1] -= aa[4*i+2]*cc[2*i+2] + aa[4*i+3]*cc[2*i+3];
+		}
+
+		cc[2*i  ] = dd[4*i  ]*c[0] + dd[4*i+1]*c[1];
+		cc[2*i+1] = dd[4*i+2]*c[0] + dd[4*i+3]*c[1];
+	}
+
+	return 0;
+}
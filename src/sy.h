@@ -5,6 +5,12 @@
 #ifndef SY_H
 #define SY_H
 
-int SY(FILE*, int, int, double*, double*, double*, double*);
+int SYFactor(int, int, double*, double*, double*);
+int SYSolve(int, int, int, double*, double*, double*, double*);
+int SYBatchFactor(int, int, int, double*, double*, double*);
+int SYBatchSolve(int, int, int, double*, double*, double*, double*);
+int SYBand(int, int, int, int, double*, double*);
+int SYBlockFactor(int, int, double*, double*, double*);
+int SYBlockSolve(int, int, double*, double*, double*, double*);
 
 #endif
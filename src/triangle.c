@@ -1,8 +1,14 @@
 /*
 ** Function Triangulate
-** Creates triangular elements.
+** Creates triangular elements. With triangulationType 'Q' every
+** quadrilateral is split along the diagonal giving the largest minimum
+** angle, after which the edges are flipped to a Delaunay triangulation.
+** With numQuadLayers > 0 the cells of the first numQuadLayers eta
+** layers are kept as quadrangles (a hybrid grid of elementType
+** etMixed), so the boundary layer stays structured.
 **
-** In:       tResult Result   = structure containing Results
+** In:       tData   Data     = structure containing Data
+**           tResult Result   = structure containing Results
 **           
 ** Out:      tResult Result   = structure containing Results
 **
@@ -17,8 +23,10 @@
 #include "gridgen.h"
 #include "loc.h"
 #include "triangle.h"
+#include "halfedge.h"
+#include "flip.h"
 
-int Triangulate(FILE *log, tResult* Result)
+int Triangulate(FILE *log, tData *Data, tResult* Result)
 {
 	int    ret;
 
@@ -26,27 +34,71 @@ int Triangulate(FILE *log, tResult* Result)
 
 	int    triangleNum;
 	int    triangleNumWest, triangleNumEast;
+	int    numQuadLayers, numQuads;
 
 	int    nodeSW, nodeSE, nodeNW, nodeNE;
+	int    numSwapped;
+
+	double angle, angleSENW, angleSWNE;
 
 	printf("Triangulating...\n");
 
-	ret = 0;
+	ret        = 0;
+	numSwapped = 0;
+
+	/* Leave at least one layer of triangles */
+	numQuadLayers = (Data->numQuadLayers > 0 ? Data->numQuadLayers : 0);
+
+	if (numQuadLayers > Result->jm-2)
+	{
+		fprintf(stderr, "WARNING in function Triangulate: Only %d quadrangle layers possible.\n", Result->jm-2);
+		numQuadLayers = Result->jm-2;
+	}
+
+	numQuads = numQuadLayers*(Result->im-1);
 
 	/* Set the characteristics in the Result structure */
-	Result->numElements     = 2*(Result->im-1)*(Result->jm-1);
-	Result->elementType     = etTriangle;
-	Result->nodesPerElement = 3;
+	Result->numElements        = numQuads + 2*(Result->im-1)*(Result->jm-1-numQuadLayers);
+	Result->elementType        = (numQuads > 0 ? etMixed : etTriangle);
+	Result->nodesPerElement    = (numQuads > 0 ? 4 : 3);
+	Result->structuredElements = 0;
 
 	/* Allocate memory */
 	if (Result->element != NULL)
 		free(Result->element);
 
-	Result->element = (tElement*)malloc(Result->numElements*sizeof(tElement));
+	if (Result->elementTypes != NULL)
+		free(Result->elementTypes);
 
-	/* Fill the triangles array */
+	Result->element      = (tElement*)malloc(Result->numElements*sizeof(tElement));
+	Result->elementTypes = NULL;
+
+	if (numQuads > 0)
+		Result->elementTypes = (tElementType*)malloc(Result->numElements*sizeof(tElementType));
+
+	if (Result->element == NULL || (numQuads > 0 && Result->elementTypes == NULL))
+	{
+		fprintf(stderr, "ERROR in function Triangulate: Could not allocate memory.\n");
+		return -1;
+	}
+
+	/* Fill the quadrangles of the boundary layer */
 	triangleNum = 0;
-	for(j=0; j<Result->jm-1; j++)
+	for(j=0; j<numQuadLayers; j++)
+	{
+		for(i=0; i<Result->im-1; i++)
+		{
+			Result->element[triangleNum].quadrangle.node[0] = Loc(&(*Result), j, i+1);
+			Result->element[triangleNum].quadrangle.node[1] = Loc(&(*Result), j, i);
+			Result->element[triangleNum].quadrangle.node[2] = Loc(&(*Result), j+1, i);
+			Result->element[triangleNum].quadrangle.node[3] = Loc(&(*Result), j+1, i+1);
+
+			Result->elementTypes[triangleNum++] = etQuadrangle;
+		}
+	}
+
+	/* Fill the triangles array */
+	for(j=numQuadLayers; j<Result->jm-1; j++)
 	{
 		for(i=0; i<Result->im-1; i++)
 		{
@@ -54,6 +106,12 @@ int Triangulate(FILE *log, tResult* Result)
 			triangleNumWest = triangleNum++;
 			triangleNumEast = triangleNum++;
 
+			if (numQuads > 0)
+			{
+				Result->elementTypes[triangleNumWest] = etTriangle;
+				Result->elementTypes[triangleNumEast] = etTriangle;
+			}
+
 			/* Select the nodes */
 			nodeSW = Loc(&(*Result), j, i);
 			nodeSE = Loc(&(*Result), j, i+1);
@@ -69,23 +127,60 @@ int Triangulate(FILE *log, tResult* Result)
 			Result->element[triangleNumEast].triangle.node[0] = nodeSE;
 			Result->element[triangleNumEast].triangle.node[1] = nodeNW;
 			Result->element[triangleNumEast].triangle.node[2] = nodeNE;
+
+			if (Data->triangulationType == 'Q')
+			{
+				/* Smallest angle of both splits */
+				angleSENW = TriangleMinimumAngle(&(*Result), nodeSE, nodeSW, nodeNW);
+				angle     = TriangleMinimumAngle(&(*Result), nodeSE, nodeNW, nodeNE);
+				angleSENW = (angle < angleSENW ? angle : angleSENW);
+
+				angleSWNE = TriangleMinimumAngle(&(*Result), nodeSE, nodeSW, nodeNE);
+				angle     = TriangleMinimumAngle(&(*Result), nodeSW, nodeNW, nodeNE);
+				angleSWNE = (angle < angleSWNE ? angle : angleSWNE);
+
+				if (angleSWNE > angleSENW)
+				{
+					/* Split along the other diagonal, keeping the orientation */
+					Result->element[triangleNumWest].triangle.node[0] = nodeSE;
+					Result->element[triangleNumWest].triangle.node[1] = nodeSW;
+					Result->element[triangleNumWest].triangle.node[2] = nodeNE;
+
+					Result->element[triangleNumEast].triangle.node[0] = nodeSW;
+					Result->element[triangleNumEast].triangle.node[1] = nodeNW;
+					Result->element[triangleNumEast].triangle.node[2] = nodeNE;
+
+					numSwapped++;
+				}
+			}
 		}
 	}
 
+	if (Data->triangulationType == 'Q')
+	{
+		printf("Swapped diagonals    = %d\n", numSwapped);
+
+		/* Flip to a Delaunay triangulation */
+		ret = FlipEdges(&(*log), &(*Result));
+	}
+
 	/* Write report */
 	if (log)
 	{
 		fprintf(log, "\n***** FUNCTION TRIANGULATE *****\n\n");
 
-		fprintf(log, "  N Node1 Node2 Node3\n");
+		fprintf(log, "  N Node1 Node2 Node3%s\n", (numQuads > 0 ? " Node4" : ""));
 
 		for(i=0; i<Result->numElements; i++)
 		{
-			nodeSE = Result->element[i].quadrangle.node[0];
-			nodeSW = Result->element[i].quadrangle.node[1];
-			nodeNW = Result->element[i].quadrangle.node[2];
-
-			fprintf(log, "%3d   %3d   %3d   %3d\n", i, nodeSE, nodeSW, nodeNW);
+			nodeSE = Result->element[i].triangle.node[0];
+			nodeSW = Result->element[i].triangle.node[1];
+			nodeNW = Result->element[i].triangle.node[2];
+
+			if (TypeOfElement(&(*Result), i) == etQuadrangle)
+				fprintf(log, "%3d   %3d   %3d   %3d   %3d\n", i, nodeSE, nodeSW, nodeNW, Result->element[i].quadrangle.node[3]);
+			else
+				fprintf(log, "%3d   %3d   %3d   %3d\n", i, nodeSE, nodeSW, nodeNW);
 		}
 
 		fprintf(log, "\n*****************************\n\n");
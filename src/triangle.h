@@ -5,6 +5,6 @@
 #ifndef TRIANGLE_H
 #define TRIANGLE_H
 
-int Triangulate(FILE*, tResult*);
+int Triangulate(FILE*, tData*, tResult*);
 
 #endif
@@ -1,7 +1,11 @@
 /*
 ** Function Unstructured
 ** Creates an unstructured grid from a structured one by dividing
-** quadrilaterals into two triangles.
+** quadrilaterals into two triangles, or (gridType 'D') by a Delaunay
+** triangulation of its nodes. With triangulationType 'Q' the diagonals
+** are chosen and flipped for the largest minimum angle. The resulting
+** triangulation is smoothed, and refined locally if refinementType is
+** not 'N'. Elements against the orientation of the grid are reported.
 **
 ** In:       tData   Data     = structure containing Data
 **           tResult Result   = structure containing Results
@@ -18,29 +22,87 @@
 #include "gridgen.h"
 #include "metrics.h"
 #include "unstructured.h"
+#include "halfedge.h"
+#include "adjacency.h"
 #include "smooth.h"
 #include "triangle.h"
+#include "delaunay.h"
+#include "flip.h"
+#include "refine.h"
 
 int Unstructured(FILE *log, tData *Data, tResult *Result)
 {
 	int    ret;
+	int    e, numInverted;
+	double area;
 
 	printf("Destructuring grid...\n");
 
-	ret = 0;
+	ret         = 0;
+	numInverted = 0;
 
-	/* Triangulate */
-	if (ret != -1)
-		ret = Triangulate(&(*log), &(*Result));
+	if (Data->gridType == 'D')
+	{
+		/* Delaunay triangulation of the nodes */
+		if (ret != -1)
+			ret = Delaunay(&(*log), &(*Data), &(*Result));
 
-	/* Apply smoothing */
-	if (ret != -1)
-		ret = Smooth(&(*log), &(*Data), &(*Result));
+		/* Apply smoothing */
+		if (ret != -1)
+			ret = Smooth(&(*log), &(*Data), &(*Result));
+
+		/* Smoothing moved the nodes; restore the Delaunay criterion */
+		if (ret != -1)
+			ret = FlipEdges(&(*log), &(*Result));
+	}
+	else
+	{
+		/* Triangulate */
+		if (ret != -1)
+			ret = Triangulate(&(*log), &(*Data), &(*Result));
+
+		/* Apply smoothing */
+		if (ret != -1)
+			ret = Smooth(&(*log), &(*Data), &(*Result));
+
+		/* Smoothing moved the nodes; restore the Delaunay criterion */
+		if (ret != -1 && Data->triangulationType == 'Q')
+			ret = FlipEdges(&(*log), &(*Result));
+	}
 
 	/* Recalculate all metrics */
 	if (ret != -1)
 		ret = CalcMetrics(&(*log), &(*Result));
 
+	/* Refine where the boundary curvature or the sizes demand it */
+	if (ret != -1 && Data->refinementType != 'N')
+	{
+		ret = Refine(&(*log), &(*Data), &(*Result));
+
+		if (ret != -1 && Data->triangulationType == 'Q')
+			ret = FlipEdges(&(*log), &(*Result));
+	}
+
+	/* Remove the nodes merged by the Delaunay triangulation */
+	if (ret != -1 && Data->gridType == 'D')
+		ret = CompactNodes(&(*log), &(*Result));
+
+	/* Every element should have the orientation of the grid */
+	if (ret != -1)
+	{
+		area = 0;
+		for(e=0; e<Result->numElements; e++)
+			area += SignedArea(&(*Result), Result->x, Result->y, e);
+
+		for(e=0; e<Result->numElements; e++)
+			if (SignedArea(&(*Result), Result->x, Result->y, e)*area <= 0)
+				numInverted++;
+
+		if (numInverted > 0)
+			fprintf(stderr, "WARNING in function Unstructured: %d of %d elements are inverted.\n",
+			        numInverted, Result->numElements);
+	}
+
 	/* Write report */
 	if (log)
 	{
@@ -48,6 +110,7 @@ int Unstructured(FILE *log, tData *Data, tResult *Result)
 
 		if (ret != -1)
 		{
+			fprintf(log, "inverted elements = %d\n", numInverted);
 			fprintf(log, "Succesfully destructured.\n");
 		}
 		else
@@ -0,0 +1,305 @@
+/*
+** Function WallDistance
+** Calculates the distance of every node to the aerofoil, as needed by
+** turbulence models. The aerofoil edges of the grid are stored in a
+** tree of bounding boxes, each box split in two along its longer side;
+** the nearest edge of a node is then found by visiting the nearer box
+** first and skipping every box farther away than the nearest edge so
+** far. The distance is exact, also between the nodes of the aerofoil.
+**
+** In:       tResult Result   = structure containing Results
+**
+** Out:      tResult Result   = structure containing Results
+**
+** Return:   0 on success, -1 on failure
+**
+** Author:   J.L. Klaufus
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gridgen.h"
+#include "loc.h"
+#include "halfedge.h"
+#include "walldistance.h"
+
+static int CompareSegment(const void *a, const void *b)
+{
+	const tSegment *segmentA = (const tSegment*)a;
+	const tSegment *segmentB = (const tSegment*)b;
+
+	return (segmentA->key < segmentB->key ? -1 : (segmentA->key > segmentB->key ? 1 : 0));
+}
+
+int WallDistance(FILE *log, tResult *Result)
+{
+	int    ret;
+	int    h, n, s;
+	int    a, b;
+	double maxDistance;
+
+	tHalfEdge    HalfEdge = {0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, NULL, 0};
+	tSegmentTree Tree     = {0, NULL, 0, NULL};
+
+	printf("Calculating wall distance...\n");
+
+	ret         = 0;
+	maxDistance = 0;
+
+	if (Result->wallDistance != NULL)
+		free(Result->wallDistance);
+
+	Result->wallDistance = (double*)malloc(Result->numNodes*sizeof(double));
+
+	if (Result->wallDistance == NULL)
+	{
+		fprintf(stderr, "ERROR in function WallDistance: Could not allocate memory.\n");
+		ret = -1;
+	}
+
+	if (ret != -1)
+		ret = BuildHalfEdges(NULL, &(*Result), &HalfEdge);
+
+	if (ret != -1)
+	{
+		/* The aerofoil edges */
+		for(h=0; h<HalfEdge.numHalfEdges; h++)
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] == -1 &&
+			    PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h)) == ptAerofoil)
+				Tree.numSegments++;
+
+		Tree.segment = (tSegment*)malloc((Tree.numSegments > 0 ? Tree.numSegments : 1)*sizeof(tSegment));
+		Tree.box     = (tBox*)malloc((Tree.numSegments > 0 ? 2*Tree.numSegments : 1)*sizeof(tBox));
+
+		if (Tree.segment == NULL || Tree.box == NULL)
+		{
+			fprintf(stderr, "ERROR in function WallDistance: Could not allocate memory.\n");
+			ret = -1;
+		}
+		else if (Tree.numSegments == 0)
+		{
+			fprintf(stderr, "ERROR in function WallDistance: No aerofoil edges found.\n");
+			ret = -1;
+		}
+	}
+
+	if (ret != -1)
+	{
+		for(h=0, s=0; h<HalfEdge.numHalfEdges; h++)
+		{
+			if (HalfEdge.origin[h] != -1 && HalfEdge.twin[h] == -1 &&
+			    PatchOfEdge(&(*Result), HalfEdge.origin[h], HalfEdgeDest(&HalfEdge, h)) == ptAerofoil)
+			{
+				a = HalfEdge.origin[h];
+				b = HalfEdgeDest(&HalfEdge, h);
+
+				Tree.segment[s].xa = Result->x[a];
+				Tree.segment[s].ya = Result->y[a];
+				Tree.segment[s].xb = Result->x[b];
+				Tree.segment[s].yb = Result->y[b];
+				s++;
+			}
+		}
+
+		BuildSegmentTree(&Tree, 0, Tree.numSegments);
+
+		#pragma omp parallel for reduction(max:maxDistance)
+		for(n=0; n<Result->numNodes; n++)
+		{
+			Result->wallDistance[n] = NearestSegment(&Tree, Result->x[n], Result->y[n]);
+
+			if (Result->wallDistance[n] > maxDistance)
+				maxDistance = Result->wallDistance[n];
+		}
+	}
+
+	/* Write report */
+	if (log && ret != -1)
+	{
+		fprintf(log, "\n***** FUNCTION WALLDISTANCE *****\n\n");
+
+		fprintf(log, "aerofoil edges       = %d\n", Tree.numSegments);
+		fprintf(log, "boxes                = %d\n", Tree.numBoxes);
+		fprintf(log, "maximum distance     = %f\n", maxDistance);
+
+		fprintf(log, "\n*****************************\n\n");
+	}
+
+	/* Free allocated memory */
+	FreeHalfEdges(&HalfEdge);
+
+	if (Tree.segment)
+		free(Tree.segment);
+
+	if (Tree.box)
+		free(Tree.box);
+
+	return ret;
+}
+
+/*
+** Function BuildSegmentTree
+** Adds a box around segments first..first+num-1 to the tree. A box with
+** more than WALLLEAFSIZE segments sorts them by their middle along its
+** longer side and gets two children, each around half of them.
+**
+** In:       tSegmentTree Tree  = tree of the segments
+**           int          first = first segment of the box
+**           int          num   = number of segments of the box
+**
+** Out:      tSegmentTree Tree  = tree of the segments
+**
+** Return:   the number of the box
+**
+** Author:   J.L. Klaufus
+*/
+
+int BuildSegmentTree(tSegmentTree *Tree, int first, int num)
+{
+	int    b, s;
+	int    xLonger;
+
+	tBox   *box;
+
+	b   = Tree->numBoxes++;
+	box = &Tree->box[b];
+
+	box->first = first;
+	box->num   = num;
+	box->left  = -1;
+	box->right = -1;
+
+	box->xMin = box->xMax = Tree->segment[first].xa;
+	box->yMin = box->yMax = Tree->segment[first].ya;
+
+	for(s=first; s<first+num; s++)
+	{
+		box->xMin = fmin(box->xMin, fmin(Tree->segment[s].xa, Tree->segment[s].xb));
+		box->xMax = fmax(box->xMax, fmax(Tree->segment[s].xa, Tree->segment[s].xb));
+		box->yMin = fmin(box->yMin, fmin(Tree->segment[s].ya, Tree->segment[s].yb));
+		box->yMax = fmax(box->yMax, fmax(Tree->segment[s].ya, Tree->segment[s].yb));
+	}
+
+	if (num > WALLLEAFSIZE)
+	{
+		xLonger = (box->xMax - box->xMin >= box->yMax - box->yMin);
+
+		for(s=first; s<first+num; s++)
+			Tree->segment[s].key = (xLonger ? Tree->segment[s].xa + Tree->segment[s].xb : Tree->segment[s].ya + Tree->segment[s].yb);
+
+		qsort(&Tree->segment[first], num, sizeof(tSegment), CompareSegment);
+
+		box->left  = BuildSegmentTree(&(*Tree), first, num/2);
+		box->right = BuildSegmentTree(&(*Tree), first+num/2, num-num/2);
+	}
+
+	return b;
+}
+
+/*
+** Function NearestSegment
+** Returns the distance of point (x,y) to the nearest segment of the
+** tree.
+**
+** In:       tSegmentTree Tree = tree of the segments
+**           double       x, y = point
+**
+** Return:   distance
+**
+** Author:   J.L. Klaufus
+*/
+
+double NearestSegment(tSegmentTree *Tree, double x, double y)
+{
+	int    b, s, near, far;
+	int    top;
+	int    stack[64];          /* depth of the tree, plus one */
+	double nearest, distance;
+
+	tBox   *box;
+
+	nearest  = -1;
+	top      = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		b   = stack[--top];
+		box = &Tree->box[b];
+
+		if (nearest >= 0 && BoxDistance(box, x, y) >= nearest)
+			continue;
+
+		if (box->left == -1)
+		{
+			for(s=box->first; s<box->first+box->num; s++)
+			{
+				distance = SegmentDistance(&Tree->segment[s], x, y);
+
+				if (nearest < 0 || distance < nearest)
+					nearest = distance;
+			}
+		}
+		else
+		{
+			/* The nearer child is visited first */
+			near = box->left;
+			far  = box->right;
+
+			if (BoxDistance(&Tree->box[far], x, y) < BoxDistance(&Tree->box[near], x, y))
+			{
+				s    = near;
+				near = far;
+				far  = s;
+			}
+
+			stack[top++] = far;
+			stack[top++] = near;
+		}
+	}
+
+	return sqrt(nearest);
+}
+
+/*
+** Function SegmentDistance
+** Returns the squared distance of point (x,y) to a segment.
+**
+** Author:   J.L. Klaufus
+*/
+
+double SegmentDistance(tSegment *Segment, double x, double y)
+{
+	double dx, dy, t, length;
+
+	dx     = Segment->xb - Segment->xa;
+	dy     = Segment->yb - Segment->ya;
+	length = dx*dx + dy*dy;
+
+	t = (length > 0 ? ((x - Segment->xa)*dx + (y - Segment->ya)*dy)/length : 0);
+	t = (t < 0 ? 0 : (t > 1 ? 1 : t));
+
+	dx = Segment->xa + t*dx - x;
+	dy = Segment->ya + t*dy - y;
+
+	return dx*dx + dy*dy;
+}
+
+/*
+** Function BoxDistance
+** Returns the squared distance of point (x,y) to a box; 0 inside.
+**
+** Author:   J.L. Klaufus
+*/
+
+double BoxDistance(tBox *Box, double x, double y)
+{
+	double dx, dy;
+
+	dx = (x < Box->xMin ? Box->xMin - x : (x > Box->xMax ? x - Box->xMax : 0));
+	dy = (y < Box->yMin ? Box->yMin - y : (y > Box->yMax ? y - Box->yMax : 0));
+
+	return dx*dx + dy*dy;
+}
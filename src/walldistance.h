@@ -0,0 +1,35 @@
+/*
+** Header-file for WallDistance
+*/
+
+#ifndef WALLDISTANCE_H
+#define WALLDISTANCE_H
+
+typedef struct
+{
+	double key;                /* sort key while building the tree */
+	double xa, ya, xb, yb;
+} tSegment;
+
+typedef struct
+{
+	double xMin, xMax, yMin, yMax;
+	int    first, num;         /* segments inside the box            */
+	int    left, right;        /* children; -1 for a leaf            */
+} tBox;
+
+typedef struct
+{
+	int      numSegments;
+	tSegment *segment;
+	int      numBoxes;         /* box 0 is the root                  */
+	tBox     *box;
+} tSegmentTree;
+
+int    WallDistance(FILE*, tResult*);
+int    BuildSegmentTree(tSegmentTree*, int, int);
+double NearestSegment(tSegmentTree*, double, double);
+double SegmentDistance(tSegment*, double, double);
+double BoxDistance(tBox*, double, double);
+
+#endif